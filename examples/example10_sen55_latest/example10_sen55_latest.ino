@@ -0,0 +1,173 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example will connect to the SEN55 and read the values in a separate
+ *  FreeRTOS task. Each sample is stored in a latest sample cell (SEN55Latest).
+ *  loop() runs on the other core and gets the last sample from the cell : it
+ *  never waits for the I2C bus, also not while the task is reading the SEN55.
+ *  
+ *  loop() checks the cell every CHECK mS and only displays a sample once,
+ *  together with its age.
+ *  
+ *  Tested on ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+/////////////////////////////////////////////////////////////
+/* define the interval in mS to read the values (minimum 1000) */
+//////////////////////////////////////////////////////////////
+#define INTERVAL 2000
+
+/////////////////////////////////////////////////////////////
+/* define how often in mS loop() checks for a new sample */
+//////////////////////////////////////////////////////////////
+#define CHECK 250
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+#include "sen55.h"
+
+#if !defined ARDUINO_ARCH_ESP32 || !defined SEN55_LATEST
+#error "this example needs an ESP32 (FreeRTOS tasks) and SEN55Latest"
+#endif
+
+SEN55 sen55;
+SEN55Latest latest;
+
+struct sen_values val;
+bool header = true;
+
+/**
+ * read the SEN55 every INTERVAL mS, the library stores each sample in latest
+ */
+void Sampler(void *param)
+{
+  struct sen_values v;
+  TickType_t wake = xTaskGetTickCount();
+
+  while (1) {
+    if (sen55.GetValues(&v) != SEN55_ERR_OK) Serial.println(F("could not read values"));
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(INTERVAL));
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example10: latest sample from another task"));
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  // Begin communication channel;
+  if (! sen55.begin(&Wire)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  // store every sample in the cell
+  sen55.SetLatest(&latest);
+
+  // from now on only the sampler task calls sen55 routines
+  xTaskCreatePinnedToCore(Sampler, "sen55", 4096, NULL, 1, NULL, 0);
+}
+
+void loop() {
+  static uint32_t last = 0;
+  uint32_t stamp, count;
+
+  // get the latest sample, does not wait for the I2C bus
+  if (latest.Load(&val, &stamp, &count) == SEN55_ERR_OK && count != last) {
+    last = count;
+    Display_val();
+    Serial.print(F("\tage "));
+    Serial.print(millis() - stamp);         // same as sen55.Millis() with the default SetWait()
+    Serial.println(F(" mS"));
+  }
+
+  delay(CHECK);
+}
+
+void Display_val()
+{
+  if (header) {
+    Serial.print(F("\n-------------Mass -----------    VOC:  NOX:  Humidity:  Temperature:"));
+    Serial.print(F("\n     Concentration [μg/m3]      index  index   %        [*C]"));
+    Serial.println(F("\nP1.0\tP2.5\tP4.0\tP10\t\n"));
+    header = false;
+  }
+
+  Serial.print(val.MassPM1);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM2);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM4);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM10);
+  Serial.print(F("\t")); 
+  Serial.print(val.VOC);
+  Serial.print(F("\t"));
+  Serial.print(val.NOX);
+  Serial.print(F("\t"));
+  Serial.print(val.Hum);
+  Serial.print(F("\t"));
+  Serial.print(val.Temp,2);
+}
@@ -0,0 +1,245 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example shows the SEN55 and a BME280 on the same I2C bus, each read
+ *  from its own FreeRTOS task. Both drivers use a SEN55Bus :
+ *  
+ *  - the SEN55 takes the bus only for each transfer. While the SEN55 is
+ *    processing a command (5mS or more) the BME280 task can use the bus.
+ *  - the BME280 library does not know about the SEN55Bus, each call is done
+ *    while holding a SEN55BusGuard.
+ *  
+ *  loop() displays the latest values every INTERVAL mS and, every 10 displays,
+ *  how often the bus was taken and how often a task had to wait for it.
+ *  
+ *  Tested on ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *
+ *   ===============  BME280 sensor =========================
+ *  BME280
+ *  VCC  ------ 3V3
+ *  GND  ------ GND
+ *  SCK  ------ SCL
+ *  SDI  ------ SDA
+ *  
+ *  ADAFRUIT 
+ *  BME280
+ *  VIN ------ 3V3
+ *  3V3        output (do not use)
+ *  GND ------ GND
+ *  SCK ------ SCL
+ *  SDO        if connected to GND address is 0x76 instead of 0x77  
+ *  SDI ------ SDA
+ *  CS         do not connect
+ *  
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+#include "sen55.h"
+#include "SparkFunBME280.h"
+
+///////////////////////////////////////////////////////////////
+//                          BME280                           //
+///////////////////////////////////////////////////////////////
+/* define the BME280 address.
+ * Use if address jumper is closed (SDO - GND) : 0x76.*/
+#define I2CADDR 0x77
+
+/* define how often in mS the BME280 is read */
+#define BME_INTERVAL 100
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+/////////////////////////////////////////////////////////////
+/* define the interval in mS to read the SEN55 (minimum 1000) */
+//////////////////////////////////////////////////////////////
+#define INTERVAL 2000
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+
+#if !defined ARDUINO_ARCH_ESP32 || !defined SEN55_LATEST
+#error "this example needs an ESP32 (FreeRTOS tasks) and SEN55Latest"
+#endif
+
+SEN55Bus bus(&Wire);
+SEN55 sen55;
+SEN55Latest latest;
+BME280 mySensor;
+
+struct sen_values val;
+volatile float bme_temp, bme_hum, bme_pres;
+bool header = true;
+
+/**
+ * read the SEN55 every INTERVAL mS, the library stores each sample in latest
+ */
+void Sen55Task(void *param)
+{
+  struct sen_values v;
+  TickType_t wake = xTaskGetTickCount();
+
+  while (1) {
+    if (sen55.GetValues(&v) != SEN55_ERR_OK) Serial.println(F("could not read SEN55"));
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(INTERVAL));
+  }
+}
+
+/**
+ * read the BME280 every BME_INTERVAL mS, hold the bus for each call
+ */
+void BmeTask(void *param)
+{
+  TickType_t wake = xTaskGetTickCount();
+
+  while (1) {
+    { SEN55BusGuard g(&bus); bme_temp = mySensor.readTempC(); }
+    { SEN55BusGuard g(&bus); bme_hum = mySensor.readFloatHumidity(); }
+    { SEN55BusGuard g(&bus); bme_pres = mySensor.readFloatPressure(); }
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(BME_INTERVAL));
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example11: SEN55 and BME280 on a shared bus"));
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  //********************** BME280 **************************************************
+
+  // set BME280 I2C address.
+  mySensor.setI2CAddress(I2CADDR);
+
+  if (mySensor.beginI2C() == false) {
+    Serial.println(F("The BME280 did not respond. Please check wiring."));
+    while(1);
+  }
+
+  Serial.println(F("Detected BME280"));
+
+  //********************** SEN-55 **************************************************
+
+  // Begin communication channel on the shared bus
+  if (! sen55.begin(&bus)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  // store every sample in the cell
+  sen55.SetLatest(&latest);
+
+  // from now on the bus is only used from the tasks
+  xTaskCreatePinnedToCore(Sen55Task, "sen55", 4096, NULL, 2, NULL, 0);
+  xTaskCreatePinnedToCore(BmeTask, "bme280", 4096, NULL, 1, NULL, 0);
+}
+
+void loop() {
+  static uint8_t cnt = 0;
+  uint32_t locks, waits;
+
+  delay(INTERVAL);
+
+  if (latest.Load(&val) != SEN55_ERR_OK) return;
+
+  Display_val();
+
+  if (++cnt == 10) {
+    bus.GetUsage(&locks, &waits, true);
+    Serial.print(F("bus taken "));
+    Serial.print(locks);
+    Serial.print(F(" times, had to wait "));
+    Serial.print(waits);
+    Serial.println(F(" times"));
+    cnt = 0;
+  }
+}
+
+void Display_val()
+{
+  if (header) {
+    Serial.print(F("==================================== SEN-55 ========================   ================= BME280 ======="));
+    Serial.print(F("\n-------------Mass -----------    VOC:  NOX:  Humidity:  Temperature:   Humidity  Temperature Pressure"));
+    Serial.print(F("\n     Concentration [μg/m3]      index  index   %        [*C]\t\t[%]      [*C]     [hPa]"));
+    Serial.println(F("\nP1.0\tP2.5\tP4.0\tP10\t\n"));
+    header = false;
+  }
+
+  Serial.print(val.MassPM1);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM2);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM4);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM10);
+  Serial.print(F("\t")); 
+  Serial.print(val.VOC);
+  Serial.print(F("\t"));
+  Serial.print(val.NOX);
+  Serial.print(F("\t"));
+  Serial.print(val.Hum);
+  Serial.print(F("\t"));
+  Serial.print(val.Temp,2);
+  Serial.print(F("\t\t"));
+  Serial.print(bme_hum, 1);
+  Serial.print(F("\t  "));
+  Serial.print(bme_temp, 2);
+  Serial.print(F("\t    "));
+  Serial.println(bme_pres / 100, 0);
+}
@@ -0,0 +1,255 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example reads the SEN55 values every INTERVAL mS with a priority
+ *  command queue (SEN55Queue). In between, the operator can ask for other
+ *  information. These requests are queued as housekeeping : they are only
+ *  done in the idle time between the measurement reads, so the values are
+ *  still read exactly every INTERVAL mS.
+ *  
+ *  Enter during measurement :
+ *   s + <enter> : read status register
+ *   v + <enter> : read firmware version
+ *   n + <enter> : read serial number
+ *   q + <enter> : display queue statistics
+ *  
+ *  Tested on UNOR4, ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *  
+ *  SEN55 pin     UNO R4
+ *  1 VCC -------- 5V
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA
+ *  4 SCL -------- SCL
+ *  5 Select ----- GND  (select I2c)
+ *  6 NOT used/connected
+ *  
+ *  The pull-up resistors should be to 5V.
+ * 
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+/////////////////////////////////////////////////////////////
+/* define the interval in mS to read the values (minimum 1000) */
+//////////////////////////////////////////////////////////////
+#define INTERVAL 2000
+
+/////////////////////////////////////////////////////////////
+/* define the max mS a housekeeping request may wait */
+//////////////////////////////////////////////////////////////
+#define HK_WINDOW 10000
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+#include "sen55.h"
+
+SEN55 sen55;
+SEN55Queue queue(&sen55);
+
+struct sen_values val;
+struct sen_version ver;
+uint8_t stat;
+char serial[SEN55_ID_LENGTH + 1];
+bool header = true;
+
+void setup() {
+  struct sen_job job;
+
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example12: priority command queue"));
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  // Begin communication channel;
+  if (! sen55.begin(&Wire)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  if (! sen55.start()) {
+    Serial.println(F("could not start SEN55."));
+    while(1);
+  }
+
+  // read the values every INTERVAL, highest priority
+  memset(&job, 0x0, sizeof(job));
+  job.cmd = SEN55_READ_MEASURED_VALUE;
+  job.data = &val;
+  job.prio = SEN55_PRIO_MEASURE;
+  job.start = sen55.Millis();
+  job.window = INTERVAL / 2;
+  job.period = INTERVAL;
+  job.done = Values_done;
+  queue.Submit(&job);
+}
+
+void loop() {
+
+  // next step of the queue, never waits
+  queue.Run();
+
+  if (Serial.available()) {
+    char c = Serial.read();
+    bool ok = true;
+
+    if (c == 's' || c == 'S')
+      ok = queue.Submit(SEN55_READ_DEVICE_REGISTER, &stat, SEN55_PRIO_HOUSEKEEPING, Info_done, HK_WINDOW);
+    else if (c == 'v' || c == 'V')
+      ok = queue.Submit(SEN55_READ_VERSION, &ver, SEN55_PRIO_HOUSEKEEPING, Info_done, HK_WINDOW);
+    else if (c == 'n' || c == 'N')
+      ok = queue.Submit(SEN55_READ_SERIAL_NUMBER, serial, SEN55_PRIO_HOUSEKEEPING, Info_done, HK_WINDOW);
+    else if (c == 'q' || c == 'Q')
+      Display_stats();
+
+    if (! ok) Serial.println(F("queue is full"));
+  }
+}
+
+/**
+ * called by the queue when the values are read
+ */
+void Values_done(struct sen_job *job, uint8_t ret)
+{
+  if (ret == SEN55_ERR_OK) Display_val();
+  else {
+    Serial.print(F("Error during reading values: "));
+    Serial.println(ret);
+  }
+}
+
+/**
+ * called by the queue when a housekeeping request is done (or dropped)
+ */
+void Info_done(struct sen_job *job, uint8_t ret)
+{
+  if (ret == SEN55_ERR_TIMEOUT) {
+    Serial.println(F("request was dropped, no time"));
+    return;
+  }
+
+  switch(job->cmd) {
+    case SEN55_READ_DEVICE_REGISTER:
+      Serial.print(F("Status register : 0x"));
+      Serial.println(stat, HEX);
+      break;
+
+    case SEN55_READ_VERSION:
+      if (ret != SEN55_ERR_OK) break;
+      Serial.print(F("Firmware : "));
+      Serial.print(ver.F_major);
+      Serial.print(F("."));
+      Serial.println(ver.F_minor);
+      break;
+
+    case SEN55_READ_SERIAL_NUMBER:
+      if (ret != SEN55_ERR_OK) break;
+      Serial.print(F("Serial number : "));
+      Serial.println(serial);
+      break;
+  }
+
+  if (ret != SEN55_ERR_OK && ret != SEN55_ERR_OUTOFRANGE) {
+    Serial.print(F("Error during request: "));
+    Serial.println(ret);
+  }
+}
+
+void Display_stats()
+{
+  struct sen_queue_stats st;
+
+  queue.GetStats(&st);
+
+  Serial.print(F("jobs done "));
+  Serial.print(st.done);
+  Serial.print(F(", dropped "));
+  Serial.print(st.expired);
+  Serial.print(F(", measurement max late "));
+  Serial.print(st.max_late);
+  Serial.println(F(" mS"));
+}
+
+void Display_val()
+{
+  if (header) {
+    Serial.print(F("\n-------------Mass -----------    VOC:  NOX:  Humidity:  Temperature:"));
+    Serial.print(F("\n     Concentration [μg/m3]      index  index   %        [*C]"));
+    Serial.println(F("\nP1.0\tP2.5\tP4.0\tP10\t\n"));
+    header = false;
+  }
+
+  Serial.print(val.MassPM1);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM2);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM4);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM10);
+  Serial.print(F("\t")); 
+  Serial.print(val.VOC);
+  Serial.print(F("\t"));
+  Serial.print(val.NOX);
+  Serial.print(F("\t"));
+  Serial.print(val.Hum);
+  Serial.print(F("\t"));
+  Serial.print(val.Temp,2);
+  Serial.println();
+}
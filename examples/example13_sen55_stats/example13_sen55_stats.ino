@@ -0,0 +1,198 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example reads the SEN55 mass and gas values and keeps running
+ *  statistics on them with SEN55Stats : mean, standard deviation, min / max,
+ *  exponential moving average (EWMA) and the average over the last
+ *  SEN55_STATS_WINDOW samples. The first SKIPFIRST readings after start are
+ *  skipped as they might be wrong.
+ *  
+ *  The P50, P95 and P99 of PM2.5 are estimated with a quantile sketch
+ *  (SEN55Quantile) that uses the same memory after an hour or a month.
+ *  
+ *  Every REPORT samples the statistics are displayed.
+ *  
+ *  Enter during measurement :
+ *   c + <enter> : clear the statistics
+ *  
+ *  Tested on UNOR4, ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *  
+ *  SEN55 pin     UNO R4
+ *  1 VCC -------- 5V
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA
+ *  4 SCL -------- SCL
+ *  5 Select ----- GND  (select I2c)
+ *  6 NOT used/connected
+ *  
+ *  The pull-up resistors should be to 5V.
+ * 
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+//////////////////////////////////////////////////////////////
+/* skip first x readings as they might be wrong
+ * due to start-up */
+//////////////////////////////////////////////////////////////
+#define SKIPFIRST 5
+
+/////////////////////////////////////////////////////////////
+/* display the statistics every REPORT samples */
+//////////////////////////////////////////////////////////////
+#define REPORT 10
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+#include "sen55_stats.h"
+
+SEN55 sen55;
+SEN55Stats stats(SEN55_FLD(SEN55_FLD_PM2) | SEN55_FLD(SEN55_FLD_PM10) | SEN55_FLD(SEN55_FLD_VOC) | SEN55_FLD(SEN55_FLD_NOX));
+
+SEN55Quantile pm25;
+
+struct sen_values val;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example13: streaming statistics"));
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  // Begin communication channel;
+  if (! sen55.begin(&Wire)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  if (! sen55.start()) {
+    Serial.println(F("could not start SEN55."));
+    while(1);
+  }
+
+  stats.SetSkip(SKIPFIRST);
+}
+
+void loop() {
+  static uint8_t cnt = 0;
+
+  delay(1000);
+
+  if (Serial.available()) {
+    char c = Serial.read();
+
+    if (c == 'c' || c == 'C') {
+      stats.Clear();
+      pm25.Clear();
+      Serial.println(F("statistics cleared"));
+    }
+  }
+
+  if (sen55.GetValues(&val) != SEN55_ERR_OK) {
+    Serial.println(F("Error during reading values"));
+    return;
+  }
+
+  // the skipped samples are not added to the sketch either
+  if (stats.Add(&val)) pm25.Add(val.MassPM2);
+
+  if (++cnt < REPORT) return;
+  cnt = 0;
+
+  Serial.println(F("\n         count    mean   stddev   min     max     ewma    window"));
+  Display_field("PM2.5", SEN55_FLD_PM2);
+  Display_field("PM10", SEN55_FLD_PM10);
+  Display_field("VOC", SEN55_FLD_VOC);
+  Display_field("NOx", SEN55_FLD_NOX);
+
+  Serial.print(F("PM2.5 P50 "));
+  Serial.print(pm25.Quantile(0.50));
+  Serial.print(F(", P95 "));
+  Serial.print(pm25.Quantile(0.95));
+  Serial.print(F(", P99 "));
+  Serial.print(pm25.Quantile(0.99));
+  Serial.print(F(" (max error "));
+  Serial.print(pm25.RelError() * 100);
+  Serial.println(F("%)"));
+}
+
+void Display_field(const char *name, uint8_t fld)
+{
+  SEN55Stat *s = stats.Field(fld);
+
+  if (s == NULL || s->Count() == 0) return;
+
+  Serial.print(name);
+  Serial.print(F("\t "));
+  Serial.print(s->Count());
+  Serial.print(F("\t"));
+  Serial.print(s->Mean());
+  Serial.print(F("\t"));
+  Serial.print(s->StdDev());
+  Serial.print(F("\t"));
+  Serial.print(s->Min());
+  Serial.print(F("\t"));
+  Serial.print(s->Max());
+  Serial.print(F("\t"));
+  Serial.print(s->Ewma());
+  Serial.print(F("\t"));
+  Serial.println(s->WindowAvg());
+}
@@ -0,0 +1,174 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example reads the SEN55 every second and keeps the history of PM2.5,
+ *  PM10 and VOC with SEN55Rollup as min / mean / max per minute, per hour and
+ *  per day. No samples are stored, the memory use does not grow.
+ *  
+ *  Enter during measurement :
+ *   m + <enter> : display the last minutes
+ *   h + <enter> : display the last 24 hours, hourly
+ *   d + <enter> : display the last days
+ *  
+ *  
+ *  Enter during measurement :
+ *   c + <enter> : clear the statistics
+ *  
+ *  Tested on UNOR4, ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *  
+ *  SEN55 pin     UNO R4
+ *  1 VCC -------- 5V
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA
+ *  4 SCL -------- SCL
+ *  5 Select ----- GND  (select I2c)
+ *  6 NOT used/connected
+ *  
+ *  The pull-up resistors should be to 5V.
+ * 
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+#include "sen55_rollup.h"
+
+SEN55 sen55;
+SEN55Rollup hist(SEN55_FLD(SEN55_FLD_PM2) | SEN55_FLD(SEN55_FLD_PM10) | SEN55_FLD(SEN55_FLD_VOC));
+
+struct sen_values val;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example14: history per minute, hour and day"));
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  // Begin communication channel;
+  if (! sen55.begin(&Wire)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  if (! sen55.start()) {
+    Serial.println(F("could not start SEN55."));
+    while(1);
+  }
+
+  Serial.println(F("Enter m, h or d to display the history"));
+}
+
+void loop() {
+
+  delay(1000);
+
+  if (Serial.available()) {
+    char c = Serial.read();
+
+    if (c == 'm' || c == 'M') Display_hist(0, 15);
+    else if (c == 'h' || c == 'H') Display_hist(1, 24);
+    else if (c == 'd' || c == 'D') Display_hist(2, 7);
+  }
+
+  if (sen55.GetValues(&val) != SEN55_ERR_OK) {
+    Serial.println(F("Error during reading values"));
+    return;
+  }
+
+  hist.Add(&val, sen55.Millis() / 1000);
+}
+
+/**
+ * display the last cnt buckets of a level, newest first
+ */
+void Display_hist(uint8_t level, uint16_t cnt)
+{
+  struct sen_agg pm2, pm10, voc;
+  uint32_t start;
+
+  if (cnt > hist.Buckets(level)) cnt = hist.Buckets(level);
+
+  Serial.println(F("\nstart [s]\tcount\tPM2.5 min/mean/max\tPM10 mean/max\tVOC mean"));
+
+  for (uint16_t age = 0; age < cnt; age++) {
+
+    if (hist.Get(level, age, SEN55_FLD_PM2, &pm2, &start) != SEN55_ERR_OK) continue;
+    hist.Get(level, age, SEN55_FLD_PM10, &pm10);
+    hist.Get(level, age, SEN55_FLD_VOC, &voc);
+
+    Serial.print(start);
+    Serial.print(F("\t"));
+    Serial.print(pm2.count);
+    Serial.print(F("\t"));
+    Serial.print(pm2.min);
+    Serial.print(F(" / "));
+    Serial.print(pm2.mean);
+    Serial.print(F(" / "));
+    Serial.print(pm2.max);
+    Serial.print(F("\t"));
+    Serial.print(pm10.mean);
+    Serial.print(F(" / "));
+    Serial.print(pm10.max);
+    Serial.print(F("\t"));
+    Serial.println(voc.mean);
+  }
+}
@@ -0,0 +1,154 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example reads the SEN55 every second and displays the air quality
+ *  index (AQI) every minute : the index of the current PM2.5 and PM10 values
+ *  and the NowCast index. The NowCast is a weighted average of the last 12
+ *  hourly means, it is updated each time SEN55Rollup finishes an hour. It
+ *  needs 2 of the last 3 hours, so it takes 2 hours before it is shown.
+ *  
+ *  The breakpoint table (US EPA, UK DAQI or EU EAQI) is selected in
+ *  sen55_aqi.h.
+ *  
+ *  Tested on UNOR4, ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *  
+ *  SEN55 pin     UNO R4
+ *  1 VCC -------- 5V
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA
+ *  4 SCL -------- SCL
+ *  5 Select ----- GND  (select I2c)
+ *  6 NOT used/connected
+ *  
+ *  The pull-up resistors should be to 5V.
+ * 
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+#include "sen55_aqi.h"
+
+SEN55 sen55;
+SEN55Rollup hist(SEN55_FLD(SEN55_FLD_PM2) | SEN55_FLD(SEN55_FLD_PM10));
+SEN55NowCast nowcast;
+
+struct sen_values val;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example15: air quality index"));
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  // Begin communication channel;
+  if (! sen55.begin(&Wire)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  if (! sen55.start()) {
+    Serial.println(F("could not start SEN55."));
+    while(1);
+  }
+
+  // each finished hour updates the NowCast
+  hist.SetCallback(SEN55NowCast::RollupHour, &nowcast);
+}
+
+void loop() {
+  static uint8_t cnt = 0;
+
+  delay(1000);
+
+  if (sen55.GetValues(&val) != SEN55_ERR_OK) {
+    Serial.println(F("Error during reading values"));
+    return;
+  }
+
+  hist.Add(&val, sen55.Millis() / 1000);
+
+  if (++cnt < 60) return;
+  cnt = 0;
+
+  Serial.print(F("PM2.5 "));
+  Serial.print(val.MassPM2);
+  Serial.print(F(" AQI "));
+  Serial.print(SEN55AqiIndex(SEN55_FLD_PM2, val.MassPM2));
+  Serial.print(F(", PM10 "));
+  Serial.print(val.MassPM10);
+  Serial.print(F(" AQI "));
+  Serial.print(SEN55AqiIndex(SEN55_FLD_PM10, val.MassPM10));
+
+  if (nowcast.Index() != SEN55_AQI_NONE) {
+    Serial.print(F(", NowCast PM2.5 "));
+    Serial.print(nowcast.Conc(SEN55_FLD_PM2));
+    Serial.print(F(" AQI "));
+    Serial.print(nowcast.Index());
+#if not defined SMALLFOOTPRINT
+    Serial.print(F(" "));
+    Serial.print(SEN55AqiName(nowcast.Index()));
+#endif
+  }
+
+  Serial.println();
+}
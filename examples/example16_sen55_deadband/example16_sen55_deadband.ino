@@ -0,0 +1,172 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example reads the SEN55 every second, but only "sends" (here : prints)
+ *  the values when one of them moved more than its deadband, or when nothing
+ *  was sent for HEARTBEAT seconds. On a stable indoor site this saves most of
+ *  the messages (and radio power) of a node.
+ *  
+ *  Enter during measurement :
+ *   s + <enter> : display how many samples were sent
+ *  
+ *  Tested on UNOR4, ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *  
+ *  SEN55 pin     UNO R4
+ *  1 VCC -------- 5V
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA
+ *  4 SCL -------- SCL
+ *  5 Select ----- GND  (select I2c)
+ *  6 NOT used/connected
+ *  
+ *  The pull-up resistors should be to 5V.
+ * 
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+/////////////////////////////////////////////////////////////
+/* define max seconds without sending */
+//////////////////////////////////////////////////////////////
+#define HEARTBEAT 300
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+#include "sen55_deadband.h"
+
+SEN55 sen55;
+SEN55Deadband filter(HEARTBEAT * 1000UL);
+
+struct sen_values val;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example16: send only the values that moved"));
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  // Begin communication channel;
+  if (! sen55.begin(&Wire)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  if (! sen55.start()) {
+    Serial.println(F("could not start SEN55."));
+    while(1);
+  }
+
+  // e.g. a wider band for the temperature
+  filter.SetBand(SEN55_FLD_TEMP, 0.5);
+}
+
+void loop() {
+
+  delay(1000);
+
+  if (Serial.available()) {
+    char c = Serial.read();
+
+    if (c == 's' || c == 'S') Display_stats();
+  }
+
+  if (sen55.GetValues(&val) != SEN55_ERR_OK) {
+    Serial.println(F("Error during reading values"));
+    return;
+  }
+
+  if (filter.Check(&val, millis())) Send_val();
+}
+
+/**
+ * replace with sending the values (LoRa, MQTT, ...)
+ */
+void Send_val()
+{
+  Serial.print(millis() / 1000);
+  Serial.print(filter.Changed() ? F("\tchanged 0x") : F("\theartbeat 0x"));
+  Serial.print(filter.Changed(), HEX);
+  Serial.print(F("\tPM2.5 "));
+  Serial.print(val.MassPM2);
+  Serial.print(F("\tPM10 "));
+  Serial.print(val.MassPM10);
+  Serial.print(F("\tRH "));
+  Serial.print(val.Hum);
+  Serial.print(F("\tT "));
+  Serial.print(val.Temp);
+  Serial.print(F("\tVOC "));
+  Serial.print(val.VOC);
+  Serial.print(F("\tNOx "));
+  Serial.println(val.NOX);
+}
+
+void Display_stats()
+{
+  uint32_t checked, sent;
+
+  filter.GetStats(&checked, &sent);
+
+  Serial.print(F("sent "));
+  Serial.print(sent);
+  Serial.print(F(" of "));
+  Serial.print(checked);
+  Serial.println(F(" samples"));
+}
@@ -0,0 +1,197 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example reads the SEN55 every second and keeps the values in a
+ *  compressed buffer while the node is "offline" (e.g. no WiFi / LoRa). When
+ *  the node is online again, all stored samples are sent (here : printed)
+ *  with their time, oldest first. If the buffer is full, the oldest samples
+ *  are dropped.
+ *  
+ *  Enter during measurement :
+ *   o + <enter> : toggle offline / online
+ *   i + <enter> : display the samples and bytes stored
+ *  
+ *  Tested on UNOR4, ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *  
+ *  SEN55 pin     UNO R4
+ *  1 VCC -------- 5V
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA
+ *  4 SCL -------- SCL
+ *  5 Select ----- GND  (select I2c)
+ *  6 NOT used/connected
+ *  
+ *  The pull-up resistors should be to 5V.
+ * 
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+/////////////////////////////////////////////////////////////
+/* define buffer size in bytes */
+//////////////////////////////////////////////////////////////
+#define BUFSIZE 8192
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+#include "sen55_series.h"
+
+SEN55 sen55;
+
+uint8_t buf[BUFSIZE];
+SEN55Series series(buf, sizeof(buf));
+
+struct sen_values val;
+bool offline = true;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example17: store the values while offline"));
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  // Begin communication channel;
+  if (! sen55.begin(&Wire)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  if (! sen55.start()) {
+    Serial.println(F("could not start SEN55."));
+    while(1);
+  }
+
+  Serial.println(F("offline : storing, enter o to go online"));
+}
+
+void loop() {
+
+  delay(1000);
+
+  if (Serial.available()) {
+    char c = Serial.read();
+
+    if (c == 'o' || c == 'O') {
+      offline = ! offline;
+      Serial.println(offline ? F("offline : storing") : F("online : sending"));
+    }
+    else if (c == 'i' || c == 'I') Display_info();
+  }
+
+  if (sen55.GetValues(&val) != SEN55_ERR_OK) {
+    Serial.println(F("Error during reading values"));
+    return;
+  }
+
+  if (offline) {
+    series.Append(&val, millis() / 1000);
+    return;
+  }
+
+  // back online : first the stored samples
+  if (series.Count()) Send_stored();
+
+  Send_val(&val, millis() / 1000);
+}
+
+void Send_stored()
+{
+  struct sen_series_iter it;
+  struct sen_values v;
+  uint32_t t;
+
+  Display_info();
+
+  series.Begin(&it);
+  while (series.Next(&it, &v, &t)) Send_val(&v, t);
+
+  series.Clear();
+}
+
+/**
+ * replace with sending the values (LoRa, MQTT, ...)
+ */
+void Send_val(struct sen_values *v, uint32_t t)
+{
+  Serial.print(t);
+  Serial.print(F("\tPM2.5 "));
+  Serial.print(v->MassPM2);
+  Serial.print(F("\tPM10 "));
+  Serial.print(v->MassPM10);
+  Serial.print(F("\tRH "));
+  Serial.print(v->Hum);
+  Serial.print(F("\tT "));
+  Serial.print(v->Temp);
+  Serial.print(F("\tVOC "));
+  Serial.print(v->VOC);
+  Serial.print(F("\tNOx "));
+  Serial.println(v->NOX);
+}
+
+void Display_info()
+{
+  Serial.print(F("stored "));
+  Serial.print(series.Count());
+  Serial.print(F(" samples in "));
+  Serial.print(series.Bytes());
+  Serial.print(F(" bytes, dropped "));
+  Serial.println(series.Dropped());
+}
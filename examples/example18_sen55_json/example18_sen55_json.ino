@@ -0,0 +1,214 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example reads the SEN55 every INTERVAL seconds and creates the JSON
+ *  text and the CBOR map of the values and status, as they would be sent with
+ *  MQTT or HTTP. Both are written in a fixed buffer : no String, no heap and
+ *  no printf. It displays the JSON, the CBOR in hex and the time it took.
+ *  
+ *  Enter during measurement :
+ *   v + <enter> : add the version of the SEN55 to the next message
+ *  
+ *  Tested on UNOR4, ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *  
+ *  SEN55 pin     UNO R4
+ *  1 VCC -------- 5V
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA
+ *  4 SCL -------- SCL
+ *  5 Select ----- GND  (select I2c)
+ *  6 NOT used/connected
+ *  
+ *  The pull-up resistors should be to 5V.
+ * 
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+/////////////////////////////////////////////////////////////
+/* define seconds between messages */
+//////////////////////////////////////////////////////////////
+#define INTERVAL 5
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+#include "sen55_encode.h"
+
+SEN55 sen55;
+
+char json[300];
+uint8_t cbor[300];
+
+SEN55Json js(json, sizeof(json));
+SEN55Cbor cb(cbor, sizeof(cbor));
+
+struct sen_values val;
+struct sen_version ver;
+bool add_version = false;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example18: values as JSON and CBOR"));
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  // Begin communication channel;
+  if (! sen55.begin(&Wire)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  if (sen55.GetVersion(&ver) != SEN55_ERR_OK) {
+    Serial.println(F("could not read the version."));
+    while(1);
+  }
+
+  if (! sen55.start()) {
+    Serial.println(F("could not start SEN55."));
+    while(1);
+  }
+}
+
+void loop() {
+  uint8_t status;
+
+  delay(INTERVAL * 1000UL);
+
+  if (Serial.available()) {
+    char c = Serial.read();
+
+    if (c == 'v' || c == 'V') add_version = true;
+  }
+
+  if (sen55.GetValuesStatus(&val, &status) != SEN55_ERR_OK) {
+    Serial.println(F("Error during reading values"));
+    return;
+  }
+
+  Send_json(status);
+  Send_cbor(status);
+
+  add_version = false;
+}
+
+/**
+ * replace the print with sending the text (e.g. mqtt.publish("sen55", json))
+ */
+void Send_json(uint8_t status)
+{
+  unsigned long start = micros();
+  uint16_t len;
+
+  js.Begin();
+  js.Add(&val);
+  js.AddStatus(status);
+  if (add_version) js.Add(&ver);
+  len = js.End();
+
+  start = micros() - start;
+
+  if (len == 0) {
+    Serial.println(F("JSON buffer too small"));
+    return;
+  }
+
+  Serial.print(F("JSON "));
+  Serial.print(len);
+  Serial.print(F(" bytes, "));
+  Serial.print(start);
+  Serial.print(F(" uS : "));
+  Serial.println(json);
+}
+
+/**
+ * replace the print with sending the bytes
+ */
+void Send_cbor(uint8_t status)
+{
+  unsigned long start = micros();
+  uint16_t len;
+
+  cb.Begin();
+  cb.Add(&val);
+  cb.AddStatus(status);
+  if (add_version) cb.Add(&ver);
+  len = cb.End();
+
+  start = micros() - start;
+
+  if (len == 0) {
+    Serial.println(F("CBOR buffer too small"));
+    return;
+  }
+
+  Serial.print(F("CBOR "));
+  Serial.print(len);
+  Serial.print(F(" bytes, "));
+  Serial.print(start);
+  Serial.print(F(" uS : "));
+
+  for (uint16_t i = 0; i < len; i++) {
+    if (cbor[i] < 0x10) Serial.print('0');
+    Serial.print(cbor[i], HEX);
+  }
+
+  Serial.println();
+}
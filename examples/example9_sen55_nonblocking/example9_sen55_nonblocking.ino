@@ -0,0 +1,157 @@
+/*  
+ *  version 1.0 / October 2026 / paulvha
+ *    
+ *  This example will connect to the SEN55 and read the values WITHOUT blocking
+ *  loop(). The SEN55 is handled with poll() : each call performs at most one 
+ *  step (start, data-ready check or read) and never waits.
+ *  
+ *  To show that loop() stays responsive, the built-in LED blinks every 100mS
+ *  while the values are read every INTERVAL mS.
+ *  
+ *  Tested on UNOR4, ESP32
+ *   ..........................................................
+ *  SEN55 Pinout (back  sideview)
+ *  ---------------------
+ *  ! 1 2 3 4 5 6        |
+ *  !___________         |
+ *              \        |  
+ *               |       |
+ *               """""""""
+ *  .........................................................
+ *
+ *  SEN55 pin     ESP32
+ *  1 VCC -------- VUSB
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA (pin 21)
+ *  4 SCL -------- SCL (pin 22)
+ *  5 Select ----- GND (select I2c)
+ *  6 NOT used/connected
+ *
+ *  The pull-up resistors should be to 3V3
+ *  ..........................................................
+ *  
+ *  SEN55 pin     UNO R4
+ *  1 VCC -------- 5V
+ *  2 GND -------- GND
+ *  3 SDA -------- SDA
+ *  4 SCL -------- SCL
+ *  5 Select ----- GND  (select I2c)
+ *  6 NOT used/connected
+ *  
+ *  The pull-up resistors should be to 5V.
+ * 
+ *  ================================ Disclaimer ======================================
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  ===================================================================================
+ *
+ *  NO support, delivered as is, have fun, good luck !!
+ *  
+ */
+
+/////////////////////////////////////////////////////////////
+/* define driver debug
+ * 0 : no messages
+ * 1 : request debug messages */
+ //////////////////////////////////////////////////////////////
+#define DEBUG 0
+
+/////////////////////////////////////////////////////////////
+/* define the interval in mS to read the values (minimum 1000) */
+//////////////////////////////////////////////////////////////
+#define INTERVAL 2000
+
+///////////////////////////////////////////////////////////////
+/////////// NO CHANGES BEYOND THIS POINT NEEDED ///////////////
+///////////////////////////////////////////////////////////////
+#include "sen55.h"
+
+SEN55 sen55;
+
+struct sen_values val;
+bool header = true;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(100);
+
+  Serial.println(F("SEN55-Example9: non-blocking reading of values"));
+
+  pinMode(LED_BUILTIN, OUTPUT);
+
+  // set library debug level
+  sen55.EnableDebugging(DEBUG);
+
+  Wire.begin();
+
+  // Begin communication channel;
+  if (! sen55.begin(&Wire)) {
+    Serial.println(F("could not initialize communication channel."));
+    while(1);
+  }
+
+  // check for SEN55 connection
+  if (! sen55.probe()) {
+    Serial.println(F("could not probe / connect with SEN55."));
+    while(1);
+  }
+  else  {
+    Serial.println(F("Detected SEN5x."));
+  }
+
+  // reset SEN55
+  if (! sen55.reset()) {
+    Serial.println(F("could not reset SEN55."));
+    while(1);
+  }
+
+  // start non-blocking measurement
+  sen55.PollStart(INTERVAL);
+}
+
+void loop() {
+  static unsigned long blink = 0;
+
+  // other duties : blink LED
+  if (millis() - blink > 100) {
+    digitalWrite(LED_BUILTIN, ! digitalRead(LED_BUILTIN));
+    blink = millis();
+  }
+
+  // next step for SEN55
+  if (sen55.poll()) {
+    if (sen55.GetPollValues(&val) == SEN55_ERR_OK) Display_val();
+  }
+}
+
+void Display_val()
+{
+  if (header) {
+    Serial.print(F("\n-------------Mass -----------    VOC:  NOX:  Humidity:  Temperature:"));
+    Serial.print(F("\n     Concentration [μg/m3]      index  index   %        [*C]"));
+    Serial.println(F("\nP1.0\tP2.5\tP4.0\tP10\t\n"));
+    header = false;
+  }
+
+  Serial.print(val.MassPM1);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM2);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM4);
+  Serial.print(F("\t"));
+  Serial.print(val.MassPM10);
+  Serial.print(F("\t")); 
+  Serial.print(val.VOC);
+  Serial.print(F("\t"));
+  Serial.print(val.NOX);
+  Serial.print(F("\t"));
+  Serial.print(val.Hum);
+  Serial.print(F("\t"));
+  Serial.print(val.Temp,2);
+  Serial.println();
+}
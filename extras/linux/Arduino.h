@@ -0,0 +1,117 @@
+/**
+ * Minimal Arduino shim to build the SEN55 library on Linux
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * This is NOT a complete Arduino core. It only provides what the SEN55
+ * library and the host tools in this folder need.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+typedef uint8_t byte;
+
+#define F(x) (x)
+#define DEC 10
+#define HEX 16
+
+/**
+ * time
+ *
+ * By default delay() sleeps. With ShimRealDelay(false) delay() only moves
+ * the shim clock forward, millis() and micros() include this offset.
+ */
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+void ShimRealDelay(bool act);
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t len) {
+      size_t n = 0;
+      while (len--) n += write(*buf++);
+      return n;
+    }
+    size_t write(const char *str) {return write((const uint8_t *) str, strlen(str));}
+
+    size_t print(const char *str) {return write(str);}
+    size_t print(char c) {return write((uint8_t) c);}
+    size_t print(unsigned char v, int base = DEC) {return print((unsigned long) v, base);}
+    size_t print(int v, int base = DEC) {return print((long) v, base);}
+    size_t print(unsigned int v, int base = DEC) {return print((unsigned long) v, base);}
+    size_t print(long v, int base = DEC) {
+      char buf[24];
+      if (base == HEX) snprintf(buf, sizeof(buf), "%lX", (unsigned long) v);
+      else snprintf(buf, sizeof(buf), "%ld", v);
+      return print(buf);
+    }
+    size_t print(unsigned long v, int base = DEC) {
+      char buf[24];
+      snprintf(buf, sizeof(buf), base == HEX ? "%lX" : "%lu", v);
+      return print(buf);
+    }
+    size_t print(double v, int digits = 2) {
+      char buf[40];
+      snprintf(buf, sizeof(buf), "%.*f", digits, v);
+      return print(buf);
+    }
+
+    size_t println() {return write("\n");}
+    template <class T> size_t println(T v) {size_t n = print(v); return n + println();}
+    template <class T> size_t println(T v, int f) {size_t n = print(v, f); return n + println();}
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() {return -1;}
+    virtual void flush() {}
+
+    size_t readBytes(uint8_t *buf, size_t len) {
+      size_t n = 0;
+      int c;
+      while (n < len && (c = read()) >= 0) buf[n++] = (uint8_t) c;
+      return n;
+    }
+    size_t readBytes(char *buf, size_t len) {return readBytes((uint8_t *) buf, len);}
+};
+
+/**
+ * Serial : output to stdout, input from stdin
+ */
+class HostSerial : public Stream
+{
+  public:
+    void begin(unsigned long) {}
+    operator bool() {return true;}
+    size_t write(uint8_t c) {return fputc(c, stdout) == EOF ? 0 : 1;}
+    using Print::write;
+    int available() {return 0;}
+    int read() {return -1;}
+};
+
+extern HostSerial Serial;
+
+#endif /* ARDUINO_SHIM_H */
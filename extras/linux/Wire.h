@@ -0,0 +1,40 @@
+/**
+ * Minimal TwoWire shim to build the SEN55 library on Linux
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All methods are virtual, so a simulated device (see sen55_sim.h) or a
+ * Linux /dev/i2c-N bus can be used where the library expects a TwoWire.
+ * The default Wire object has no device connected.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef WIRE_SHIM_H
+#define WIRE_SHIM_H
+
+#include "Arduino.h"
+
+class TwoWire : public Stream
+{
+  public:
+    virtual void begin() {}
+    virtual void setClock(uint32_t) {}
+    virtual void beginTransmission(uint8_t) {}
+    virtual uint8_t endTransmission(bool stop = true) {(void) stop; return 2;}  // NACK on address
+    virtual uint8_t requestFrom(uint8_t addr, uint8_t cnt, uint8_t stop = 1) {(void) addr; (void) cnt; (void) stop; return 0;}
+
+    using Print::write;
+    virtual size_t write(uint8_t) {return 0;}
+    virtual int available() {return 0;}
+    virtual int read() {return -1;}
+};
+
+extern TwoWire Wire;
+
+#endif /* WIRE_SHIM_H */
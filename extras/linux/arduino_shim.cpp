@@ -0,0 +1,57 @@
+/**
+ * Minimal Arduino shim to build the SEN55 library on Linux
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Arduino.h"
+#include "Wire.h"
+#include <time.h>
+#include <sched.h>
+
+HostSerial Serial;
+TwoWire Wire;
+
+static bool _RealDelay = true;
+static uint64_t _Offset_us = 0;         // time added by delay() without sleeping
+static uint64_t _Start_us = 0;
+
+static uint64_t now_us()
+{
+  struct timespec ts;
+  uint64_t t;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  t = (uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+
+  if (_Start_us == 0) _Start_us = t;
+
+  return(t - _Start_us + _Offset_us);
+}
+
+unsigned long micros() {return((unsigned long) now_us());}
+unsigned long millis() {return((unsigned long) (now_us() / 1000));}
+
+void ShimRealDelay(bool act) {_RealDelay = act;}
+
+void delay(unsigned long ms)
+{
+  if (! _RealDelay) {
+    _Offset_us += (uint64_t) ms * 1000;
+    return;
+  }
+
+  struct timespec ts;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000L;
+  nanosleep(&ts, NULL);
+}
+
+void yield() {sched_yield();}
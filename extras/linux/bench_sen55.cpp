@@ -0,0 +1,120 @@
+/**
+ * SEN55 host benchmark
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Measures the time (ns/op) and heap allocations per operation of the hot
+ * path in the SEN55 library against the simulated device (sen55_sim.h).
+ * The waits for the SEN55 are not slept (see ShimRealDelay()) so the
+ * end-to-end results show the cost of the driver only.
+ *
+ * usage : make bench  or  ./build/bench_sen55 [iterations]
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55.h"
+#include "sen55_sim.h"
+#include <time.h>
+#include <new>
+
+/**
+ * count heap allocations (malloc is wrapped by the linker, see Makefile)
+ */
+static unsigned long _Allocs = 0;
+
+extern "C" void *__real_malloc(size_t size);
+extern "C" void *__wrap_malloc(size_t size) {_Allocs++; return(__real_malloc(size));}
+
+void *operator new(size_t size) {_Allocs++; return(__real_malloc(size));}
+void operator delete(void *p) noexcept {free(p);}
+void operator delete(void *p, size_t) noexcept {free(p);}
+
+/**
+ * access to the private routines of the library
+ */
+class SEN55Bench
+{
+  public:
+    static void fill_buffer(SEN55 &s, uint16_t cmd, void *val = NULL) {s.I2C_fill_buffer(cmd, val);}
+    static uint8_t calc_CRC(SEN55 &s, uint8_t *d) {return(s.I2C_calc_CRC(d));}
+    static uint8_t SetPointer(SEN55 &s) {return(s.I2C_SetPointer());}
+    static uint8_t ReadToBuffer(SEN55 &s, uint8_t cnt) {return(s.I2C_ReadToBuffer(cnt, false));}
+    static uint32_t byte_to_U32(SEN55 &s, int x) {return(s.byte_to_U32(x));}
+    static uint16_t byte_to_Uint16_t(SEN55 &s, int x) {return(s.byte_to_Uint16_t(x));}
+    static int16_t byte_to_int16_t(SEN55 &s, int x) {return(s.byte_to_int16_t(x));}
+};
+
+static volatile uint32_t _Sink;         // keep results alive
+
+static uint64_t now_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+/**
+ * @brief : run and report a benchmark
+ */
+template <class T>
+static void Bench(const char *name, unsigned long iter, T fn)
+{
+  uint64_t st;
+  unsigned long allocs;
+
+  for (unsigned long i = 0; i < iter / 10 + 1; i++) fn();    // warm up
+
+  allocs = _Allocs;
+  st = now_ns();
+
+  for (unsigned long i = 0; i < iter; i++) fn();
+
+  st = now_ns() - st;
+  allocs = _Allocs - allocs;
+
+  printf("%-24s %12.1f ns/op %10.3f allocs/op\n", name, (double) st / iter, (double) allocs / iter);
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned long iter = 1000000;
+  SEN55Sim sim;
+  SEN55 sen55;
+  struct sen_values val;
+  struct sen_values_pm valPM;
+  struct sen_xox nox = {1, 12, 12, 720, 50, 230};
+  uint8_t d[2] = {0xbe, 0xef};
+
+  if (argc > 1) iter = strtoul(argv[1], NULL, 10);
+
+  ShimRealDelay(false);
+  sen55.begin(&sim);
+
+  printf("SEN55 library %d.%d host benchmark, %lu iterations\n\n", DRIVER_MAJOR, DRIVER_MINOR, iter);
+
+  Bench("I2C_calc_CRC", iter, [&]() {_Sink = SEN55Bench::calc_CRC(sen55, d); d[0]++;});
+  Bench("I2C_fill_buffer cmd", iter, [&]() {SEN55Bench::fill_buffer(sen55, SEN55_READ_MEASURED_VALUE);});
+  Bench("I2C_fill_buffer nox", iter, [&]() {SEN55Bench::fill_buffer(sen55, SEN55_SET_NOX_TUNING, &nox);});
+
+  // the simulator will answer the last command for each read
+  sen55.start();
+  SEN55Bench::fill_buffer(sen55, SEN55_READ_MEASURED_VALUE_PM);
+  SEN55Bench::SetPointer(sen55);
+
+  Bench("I2C_ReadToBuffer 20", iter, [&]() {_Sink = SEN55Bench::ReadToBuffer(sen55, 20);});
+  Bench("byte_to_U32", iter, [&]() {_Sink = SEN55Bench::byte_to_U32(sen55, 4);});
+  Bench("byte_to_Uint16_t", iter, [&]() {_Sink = SEN55Bench::byte_to_Uint16_t(sen55, 2);});
+  Bench("byte_to_int16_t", iter, [&]() {_Sink = SEN55Bench::byte_to_int16_t(sen55, 2);});
+
+  iter /= 10;
+  Bench("GetValues", iter, [&]() {_Sink = sen55.GetValues(&val);});
+  Bench("GetValuesPM", iter, [&]() {_Sink = sen55.GetValuesPM(&valPM);});
+
+  return(0);
+}
@@ -0,0 +1,805 @@
+/**
+ * SEN55 host regression checks
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Checks the binary formats and encoders of the library against the
+ * simulated device (sen55_sim.h) : each part writes samples, reads them
+ * back and compares them with what was written. It prints the figures that
+ * are mentioned in the README (e.g. bytes per sample) and at the end the
+ * number of failed checks. The exit code is 1 if a check failed.
+ *
+ * usage : make check  or  ./build/check_sen55
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_series.h"
+#include "sen55_deadband.h"
+#include "sen55_encode.h"
+#include "sen55_sim.h"
+#include "sen55_log.h"
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+static unsigned long _Checks, _Failed;
+
+#define CHECK(c) check((c), #c, __LINE__)
+
+static void check(bool ok, const char *what, int line)
+{
+  _Checks++;
+
+  if (ok) return;
+
+  _Failed++;
+  printf("  FAILED line %d : %s\n", line, what);
+}
+
+/**
+ * @brief : equal, including NaN (the stores keep a NaN as NaN)
+ */
+static bool same(float a, float b)
+{
+  return((isnan(a) && isnan(b)) || a == b);
+}
+
+static double now_ms()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+/**
+ * samples of the simulator, one per second
+ */
+struct sample {
+  uint32_t t;                           // seconds
+  struct sen_values v;
+  struct sen_values_pm pm;
+};
+
+static void Samples(std::vector<struct sample> &s, uint32_t cnt, uint32_t seed)
+{
+  SEN55Sim sim(seed);
+  SEN55 sen;
+  struct sample x;
+
+  sen.begin(&sim);
+  sen.SetWait(SEN55_WAIT_VIRTUAL);
+  sen.start();
+
+  s.clear();
+
+  for (uint32_t i = 0; i < cnt; i++) {
+    delay(1000);
+    x.t = i;
+    sen.GetValues(&x.v);
+    sen.GetValuesPM(&x.pm);
+    s.push_back(x);
+  }
+}
+
+/////////////////////////// SEN55Deadband ///////////////////////////
+
+/**
+ * @brief : run a day through a filter and a model of the documented rule
+ * @param abs, rel : bands per field of sen_values (abs < 0 = not compared)
+ * @return : samples sent
+ */
+static uint32_t Deadband_Day(std::vector<struct sample> &s, SEN55Deadband &db,
+  const float *abs, const float *rel, uint32_t heartbeat)
+{
+  float last[SEN55_FLD_NOX + 1], x, d;
+  uint32_t i, sent = 0, last_sent = 0, bad = 0;
+  uint16_t changed;
+  bool send;
+
+  for (i = 0; i < s.size(); i++) {
+
+    changed = 0;
+
+    for (uint8_t f = SEN55_FLD_PM1; f <= SEN55_FLD_NOX; f++) {
+
+      if (abs[f] < 0) continue;
+
+      // the first sample is always sent
+      if (i == 0) {
+        changed |= SEN55_FLD(f);
+        continue;
+      }
+
+      x = SEN55Field(&s[i].v, f);
+      d = fabs(x - last[f]);
+
+      if (d > abs[f] && d > rel[f] * fabs(last[f])) changed |= SEN55_FLD(f);
+    }
+
+    send = i == 0 || changed || s[i].t * 1000 - last_sent >= heartbeat;
+
+    if (db.Check(&s[i].v, s[i].t * 1000) != send || db.Changed() != changed) bad++;
+
+    if (! send) continue;
+
+    for (uint8_t f = SEN55_FLD_PM1; f <= SEN55_FLD_NOX; f++) last[f] = SEN55Field(&s[i].v, f);
+    last_sent = s[i].t * 1000;
+    sent++;
+  }
+
+  CHECK(bad == 0);
+  return(sent);
+}
+
+static void Check_Deadband(std::vector<struct sample> &s)
+{
+  float abs[] = {SEN55_DB_MASS_ABS, SEN55_DB_MASS_ABS, SEN55_DB_MASS_ABS, SEN55_DB_MASS_ABS,
+    SEN55_DB_HUM_ABS, SEN55_DB_TEMP_ABS, SEN55_DB_INDEX_ABS, SEN55_DB_INDEX_ABS};
+  float rel[] = {SEN55_DB_MASS_REL, SEN55_DB_MASS_REL, SEN55_DB_MASS_REL, SEN55_DB_MASS_REL, 0, 0, 0, 0};
+  SEN55Deadband db, other(60000);
+  uint32_t sent, checked, n;
+
+  printf("SEN55Deadband\n");
+
+  // default bands and heartbeat
+  sent = Deadband_Day(s, db, abs, rel, SEN55_DB_HEARTBEAT);
+  db.GetStats(&checked, &n);
+  CHECK(checked == s.size() && n == sent);
+  printf("  a day at 1 second, default bands : %u of %u samples sent (%.1f%%)\n",
+    sent, checked, 100.0 * sent / checked);
+
+  // other bands, VOC not compared, 1 minute heartbeat
+  abs[SEN55_FLD_TEMP] = 0.05;
+  abs[SEN55_FLD_VOC] = -1;
+  rel[SEN55_FLD_PM2] = 0;
+  other.SetBand(SEN55_FLD_TEMP, abs[SEN55_FLD_TEMP]);
+  other.SetBand(SEN55_FLD_VOC, abs[SEN55_FLD_VOC]);
+  other.SetBand(SEN55_FLD_PM2, abs[SEN55_FLD_PM2], rel[SEN55_FLD_PM2]);
+  Deadband_Day(s, other, abs, rel, 60000);
+
+  // Force() sends the next sample
+  other.Force();
+  CHECK(other.Check(&s.back().v, s.back().t * 1000) && other.Changed() == 0);
+  CHECK(! other.Check(&s.back().v, s.back().t * 1000));
+}
+
+/////////////////////////// SEN55Series ///////////////////////////
+
+static bool same_values(struct sen_values *a, struct sen_values *b)
+{
+  for (uint8_t f = SEN55_FLD_PM1; f <= SEN55_FLD_NOX; f++)
+    if (! same(SEN55Field(a, f), SEN55Field(b, f))) return(false);
+
+  return(true);
+}
+
+static bool same_pm(struct sen_values_pm *a, struct sen_values_pm *b)
+{
+  for (uint8_t f = SEN55_FLD_PM1; f < SEN55_FLD_NUM; f++) {
+    if (f == SEN55_FLD_HUM) f = SEN55_FLD_NUMPM0;
+    if (! same(SEN55Field(a, f), SEN55Field(b, f))) return(false);
+  }
+
+  return(true);
+}
+
+static void Check_Series(std::vector<struct sample> &s)
+{
+  static uint8_t buf[16 * SEN55_SERIES_BLOCK];
+  SEN55Series series(buf, sizeof(buf));
+  SEN55Series pm(buf, sizeof(buf), SEN55_FLD_ALL);
+  struct sen_series_iter it;
+  std::vector<struct sample> in;
+  struct sen_values v;
+  struct sen_values_pm p;
+  uint32_t t, i, first, bad = 0;
+  uint32_t day = s.size() < 86400 ? s.size() : 86400;
+
+  printf("SEN55Series (%u byte blocks)\n", SEN55_SERIES_BLOCK);
+
+  // a day in a large enough buffer : bytes per sample
+  {
+    static uint8_t big[2000000];
+    SEN55Series d(big, sizeof(big));
+
+    for (i = 0; i < day; i++) d.Append(&s[i].v, s[i].t);
+
+    CHECK(d.Count() == day && d.Dropped() == 0);
+    printf("  %u samples of sen_values at 1 second : %.2f bytes per sample\n",
+      day, (float) d.Bytes() / d.Count());
+  }
+
+  // values with NaN, jitter, a gap and a step back in time
+  for (i = 0; i < 4000 && i < s.size(); i++) {
+    in.push_back(s[i]);
+    in[i].t = i * 1000 + (i * 7) % 13;
+    if (i >= 2000) in[i].t += 3600000;
+    if (i == 3000) in[i].t = in[i - 1].t - 5;
+    if (i % 97 == 0) in[i].v.NOX = NAN;
+    if (i % 89 == 0) in[i].v.MassPM2 = NAN;
+  }
+
+  for (i = 0; i < in.size(); i++) CHECK(series.Append(&in[i].v, in[i].t));
+
+  // the oldest blocks were dropped, the rest is exact
+  CHECK(series.Dropped() > 0);
+  CHECK(series.Count() + series.Dropped() == in.size());
+
+  first = series.Dropped();
+  series.Begin(&it);
+
+  for (i = first; series.Next(&it, &v, &t); i++) {
+    if (i >= in.size() || t != in[i].t || ! same_values(&v, &in[i].v)) bad++;
+  }
+
+  CHECK(bad == 0);
+  CHECK(i == in.size());
+
+  // reading is stopped when Append() drops the block being read
+  series.Begin(&it);
+  CHECK(series.Next(&it, &v, &t));
+
+  for (i = 0; series.Dropped() == first; i++) series.Append(&in[i].v, 5000000 + i);
+
+  CHECK(! series.Next(&it, &v, &t));
+
+  series.Clear();
+  CHECK(series.Count() == 0 && series.Dropped() == 0);
+
+  // all fields of sen_values_pm
+  for (i = 0, bad = 0; i < 500; i++) CHECK(pm.Append(&in[i].pm, in[i].t));
+
+  pm.Begin(&it);
+
+  for (i = pm.Dropped(); pm.Next(&it, &p, &t); i++) {
+    if (t != in[i].t || ! same_pm(&p, &in[i].pm)) bad++;
+  }
+
+  CHECK(bad == 0);
+  CHECK(i == 500);
+
+  // less than 2 blocks
+  SEN55Series small(buf, SEN55_SERIES_BLOCK);
+  CHECK(! small.Append(&in[0].v, 0));
+}
+
+/////////////////////////// SEN55Quantile ///////////////////////////
+
+static bool same_sketch(SEN55Quantile *a, SEN55Quantile *b)
+{
+  static const float q[] = {0.01, 0.1, 0.5, 0.9, 0.95, 0.99, 0.999};
+
+  if (a->Count() != b->Count() || a->Min() != b->Min() || a->Max() != b->Max()) return(false);
+
+  for (uint8_t i = 0; i < sizeof(q) / sizeof(q[0]); i++)
+    if (a->Quantile(q[i]) != b->Quantile(q[i])) return(false);
+
+  return(true);
+}
+
+static void Check_Quantile(std::vector<struct sample> &s)
+{
+  static const float q[] = {0.5, 0.95, 0.99};
+  SEN55Quantile all, a, b, c, other(1, 100);
+  std::vector<float> sorted;
+  uint8_t buf[SEN55_QUANT_HDR + 5 * SEN55_QUANT_BUCKETS];
+  uint16_t len, lb;
+  float x, err, worst = 0;
+  uint32_t i;
+
+  printf("SEN55Quantile (%u buckets)\n", SEN55_QUANT_BUCKETS);
+
+  // the first half in a, the second in b
+  for (i = 0; i < s.size(); i++) {
+    x = s[i].v.MassPM2;
+    all.Add(x);
+    if (i < s.size() / 2) a.Add(x);
+    else b.Add(x);
+    sorted.push_back(x);
+  }
+
+  // against the exact quantiles
+  std::sort(sorted.begin(), sorted.end());
+
+  for (i = 0; i < sizeof(q) / sizeof(q[0]); i++) {
+    x = sorted[(size_t) (q[i] * (sorted.size() - 1))];
+    err = fabs(all.Quantile(q[i]) - x) / x;
+    if (err > worst) worst = err;
+  }
+
+  CHECK(worst <= all.RelError() * 1.0001);
+  printf("  P50 / P95 / P99 of PM2.5 over a day : max relative error %.2f%% (bound %.2f%%)\n",
+    worst * 100, all.RelError() * 100);
+
+  // merge is exact
+  c = a;
+  CHECK(c.Merge(&b) == SEN55_ERR_OK);
+  CHECK(same_sketch(&c, &all));
+  CHECK(c.Merge(&other) == SEN55_ERR_PARAMETER);
+
+  // save, load and merge a loaded sketch
+  len = all.Save(buf, sizeof(buf));
+  CHECK(len > SEN55_QUANT_HDR && (len - SEN55_QUANT_HDR) % 5 == 0);
+
+  c.Clear();
+  CHECK(c.Load(buf, len) == SEN55_ERR_OK);
+  CHECK(same_sketch(&c, &all));
+
+  lb = b.Save(buf, sizeof(buf));
+  c = a;
+  CHECK(c.Load(buf, lb, true) == SEN55_ERR_OK);
+  CHECK(same_sketch(&c, &all));
+
+  // damaged or too short
+  CHECK(b.Save(buf, lb - 1) == 0);
+  CHECK(c.Load(buf, lb - 1) == SEN55_ERR_DATALENGTH);
+  buf[SEN55_QUANT_HDR + 1]++;
+  CHECK(c.Load(buf, lb) == SEN55_ERR_DATALENGTH);
+  CHECK(same_sketch(&c, &all));
+
+  // other range : can be loaded, not merged
+  len = other.Save(buf, sizeof(buf));
+  CHECK(c.Load(buf, len, true) == SEN55_ERR_PARAMETER);
+  CHECK(c.Load(buf, len) == SEN55_ERR_OK && c.Count() == 0);
+
+  // the saved format, byte for byte
+  static const uint8_t saved[] = {
+    'Q', SEN55_QUANT_BUCKETS,
+    0x00, 0x00, 0x80, 0x3f,             // low 1.0
+    0x00, 0x00, 0xc8, 0x42,             // high 100.0
+    0x03, 0x00, 0x00, 0x00,             // count
+    0x00, 0x00, 0x00, 0x3f,             // min 0.5
+    0x00, 0x00, 0x7a, 0x44,             // max 1000.0
+    0x00, 0x02, 0x00, 0x00, 0x00,       // bucket 0 : 2 samples
+    SEN55_QUANT_BUCKETS - 1, 0x01, 0x00, 0x00, 0x00
+  };
+
+  other.Add(0.5);
+  other.Add(NAN);
+  other.Add(1000);
+  other.Add(0.7);
+  len = other.Save(buf, sizeof(buf));
+  CHECK(len == sizeof(saved) && memcmp(buf, saved, len) == 0);
+}
+
+/////////////////////////// binary log ///////////////////////////
+
+#define LOG_START 1790000000000000ULL   // uS
+
+/**
+ * what was written per sensor, in the order of writing
+ */
+typedef std::vector<std::vector<struct sen55_record> > log_model;
+
+static void Log_Append(SEN55LogWriter &wr, log_model &m, uint16_t sensor, struct sample *x, bool pm)
+{
+  struct sen55_record r;
+
+  memset(&r, 0x0, sizeof(r));
+  r.time_us = LOG_START + (uint64_t) x->t * 1000000ULL;
+  r.sensor = sensor;
+  r.status = x->t % 3;
+  r.flags = SEN55_REC_VALUES;
+  r.v = x->v;
+
+  if (pm) {
+    r.flags |= SEN55_REC_PM;
+    r.pm = x->pm;
+  }
+
+  CHECK(wr.Append(sensor, r.status, &x->v, pm ? &x->pm : NULL, r.time_us));
+  m[sensor].push_back(r);
+}
+
+/**
+ * @brief : compare all records of the log with the model
+ */
+static void Log_Compare(SEN55LogReader &rd, log_model &m)
+{
+  struct sen55_log_pos pos;
+  const struct sen55_record *rec;
+  unsigned long total = 0, bad = 0;
+  size_t i;
+
+  for (uint16_t s = 0; s < m.size(); s++) {
+
+    total += m[s].size();
+    rd.Begin(&pos, s);
+
+    for (i = 0; (rec = rd.Next(&pos)); i++) {
+
+      if (i >= m[s].size() || rec->time_us != m[s][i].time_us || rec->sensor != s ||
+          rec->status != m[s][i].status) {
+        bad++;
+        continue;
+      }
+
+      for (uint8_t f = 0; f < SEN55_FLD_NUM; f++)
+        if (! same(SEN55LogField(rec, f), SEN55LogField(&m[s][i], f))) bad++;
+    }
+
+    CHECK(i == m[s].size());
+  }
+
+  CHECK(bad == 0);
+  CHECK(rd.Records == total);
+}
+
+/**
+ * @brief : header and offset in the file of the last valid block of a sensor (-1 = any)
+ */
+static off_t Log_Last(SEN55LogReader &rd, const char *path, int sensor, struct sen55_log_block *bh)
+{
+  struct sen55_log_block fb;
+  uint32_t last = rd.Blocks();
+  off_t off, ret = -1;
+  int fd;
+
+  for (uint32_t i = 0; i < rd.Blocks(); i++)
+    if (sensor < 0 || rd.Block(i)->sensor == sensor) last = i;
+
+  if (last == rd.Blocks()) return(-1);
+
+  memcpy(bh, rd.Block(last), sizeof(*bh));
+
+  // skipped blocks are not in the index : find it in the file
+  fd = open(path, O_RDONLY);
+  if (fd < 0) return(-1);
+
+  for (off = SEN55_LOG_HDR; pread(fd, &fb, sizeof(fb), off) == sizeof(fb); off += SEN55_LOG_BLOCK) {
+    if (fb.magic == SEN55_LOG_BMAGIC && fb.seq == bh->seq) ret = off;
+  }
+
+  close(fd);
+  return(ret);
+}
+
+/**
+ * @brief : aggregate of a field over a time range from the model
+ */
+static void Log_Scan(std::vector<struct sen55_record> &m, uint64_t from, uint64_t to, uint8_t fld, struct sen_agg *a)
+{
+  double sum = 0;
+  float x;
+
+  a->count = 0;
+  a->min = a->max = a->mean = NAN;
+
+  for (size_t i = 0; i < m.size(); i++) {
+
+    if (m[i].time_us < from || m[i].time_us > to) continue;
+
+    x = SEN55LogField(&m[i], fld);
+    if (isnan(x)) continue;
+
+    if (a->count == 0 || x < a->min) a->min = x;
+    if (a->count == 0 || x > a->max) a->max = x;
+    sum += x;
+    a->count++;
+  }
+
+  if (a->count) a->mean = sum / a->count;
+}
+
+/**
+ * @brief : Query() of random ranges must give the same as a scan of all records
+ */
+static void Log_Query(SEN55LogReader &rd, log_model &m)
+{
+  struct sen_agg q, b;
+  uint64_t from, to, span;
+  uint32_t r = 12345, bad = 0;
+  uint16_t sensor;
+  uint8_t fld;
+  double st;
+
+  span = m[0].back().time_us - LOG_START + 20000000ULL;
+
+  for (int i = 0; i < 2000; i++) {
+
+    r = r * 1103515245 + 12345;
+    sensor = (r >> 8) % m.size();
+    fld = (r >> 16) % SEN55_FLD_NUM;
+
+    r = r * 1103515245 + 12345;
+    from = LOG_START - 10000000ULL + (uint64_t) r * 4099 % span;
+    r = r * 1103515245 + 12345;
+    to = from + (uint64_t) r * 4099 % (span / (i % 2 ? 1 : 100));
+
+    CHECK(rd.Query(sensor, from, to, fld, &q) == SEN55_ERR_OK);
+    Log_Scan(m[sensor], from, to, fld, &b);
+
+    if (q.count != b.count) bad++;
+    else if (b.count && (q.min != b.min || q.max != b.max ||
+      fabs(q.mean - b.mean) > 1e-5 * fabs(b.mean) + 1e-6)) bad++;
+  }
+
+  CHECK(bad == 0);
+
+  // whole sensor
+  st = now_ms();
+  CHECK(rd.Query(0, 0, UINT64_MAX, SEN55_FLD_PM2, &q) == SEN55_ERR_OK);
+  st = now_ms() - st;
+
+  Log_Scan(m[0], 0, UINT64_MAX, SEN55_FLD_PM2, &b);
+  CHECK(q.count == b.count && q.count == m[0].size());
+  CHECK(rd.Scanned == 0);
+  printf("  query of all %u samples : %u blocks from the header, %.3f mS\n", q.count, rd.Summed, st);
+
+  // no samples in the range, other field or sensor
+  CHECK(rd.Query(0, 1, 2, SEN55_FLD_PM2, &q) == SEN55_ERR_OK && q.count == 0 && isnan(q.mean));
+  CHECK(rd.Query(0, 0, UINT64_MAX, SEN55_FLD_NUM, &q) == SEN55_ERR_PARAMETER);
+  CHECK(rd.Query(m.size(), 0, UINT64_MAX, SEN55_FLD_PM2, &q) == SEN55_ERR_PARAMETER);
+}
+
+static void Check_Log(std::vector<struct sample> &s, const char *path)
+{
+  SEN55LogWriter wr;
+  SEN55LogReader rd;
+  log_model m(2);
+  struct sen55_log_block bh;
+  uint32_t i, t;
+  off_t off;
+  double st;
+  int fd;
+
+  printf("binary log (%u records per block)\n", SEN55_LOG_RECS);
+
+  unlink(path);
+
+  // sensor 0 with and sensor 1 without the PM number concentrations
+  CHECK(wr.Open(path));
+  CHECK(wr.AddSensor("s0") == 0);
+  CHECK(wr.AddSensor("s1") == 1);
+
+  for (i = 0; i < s.size(); i++) {
+    Log_Append(wr, m, 0, &s[i], true);
+    Log_Append(wr, m, 1, &s[i], false);
+  }
+
+  wr.Close();
+  CHECK(wr.Errors == 0);
+
+  st = now_ms();
+  CHECK(rd.Open(path, false));
+  printf("  %lu records : open without CRC check %.1f mS", rd.Records, now_ms() - st);
+  rd.Close();
+
+  st = now_ms();
+  CHECK(rd.Open(path));
+  printf(", with CRC check %.1f mS\n", now_ms() - st);
+
+  CHECK(rd.Bad == 0);
+  CHECK(rd.FindSensor("s1") == 1 && strcmp(rd.SensorName(0), "s0") == 0);
+  Log_Compare(rd, m);
+  Log_Query(rd, m);
+
+  // damage a record in the last (not full) block of sensor 0
+  off = Log_Last(rd, path, 0, &bh);
+  CHECK(off > 0 && bh.count < SEN55_LOG_RECS);
+
+  fd = open(path, O_RDWR);
+  CHECK(pwrite(fd, "x", 1, off + sizeof(bh) + 10 * sizeof(struct sen55_record) + 30) == 1);
+  close(fd);
+
+  CHECK(rd.Open(path));
+  CHECK(rd.Bad == 1);
+  m[0].resize(m[0].size() - bh.count);
+  Log_Compare(rd, m);
+  rd.Close();
+
+  // continue : the damaged block is skipped, the block of sensor 1 is continued
+  t = s.back().t;
+  CHECK(wr.Open(path));
+
+  for (i = 1; i <= 300; i++) {
+    struct sample x = s[i];
+    x.t = t + i;
+    Log_Append(wr, m, 0, &x, true);
+    if (i <= 10) Log_Append(wr, m, 1, &x, false);
+  }
+
+  wr.Close();
+  CHECK(wr.Errors == 0);
+
+  CHECK(rd.Open(path));
+  CHECK(rd.Bad == 1);
+  Log_Compare(rd, m);
+
+  // cut the file in the records of the last block (as a crash while writing)
+  off = Log_Last(rd, path, -1, &bh);
+  CHECK(off > 0);
+  rd.Close();
+
+  CHECK(truncate(path, off + sizeof(bh) + bh.count / 2 * sizeof(struct sen55_record)) == 0);
+
+  CHECK(rd.Open(path));
+  CHECK(rd.Bad == 2);
+  m[bh.sensor].resize(m[bh.sensor].size() - bh.count);
+  Log_Compare(rd, m);
+  rd.Close();
+
+  CHECK(wr.Open(path));
+
+  for (i = 1; i <= 50; i++) {
+    struct sample x = s[i];
+    x.t = t + 1000 + i;
+    Log_Append(wr, m, bh.sensor, &x, bh.sensor == 0);
+  }
+
+  wr.Close();
+  CHECK(wr.Errors == 0);
+
+  CHECK(rd.Open(path));
+  CHECK(rd.Bad == 2);
+  Log_Compare(rd, m);
+  Log_Query(rd, m);
+  rd.Close();
+
+  // a log of another version is not read or continued
+  struct sen55_log_hdr hdr;
+
+  fd = open(path, O_RDWR);
+  CHECK(pread(fd, &hdr, sizeof(hdr), 0) == sizeof(hdr) && hdr.version == SEN55_LOG_VERSION);
+  hdr.version = 1;
+  CHECK(pwrite(fd, &hdr, sizeof(hdr), 0) == sizeof(hdr));
+  close(fd);
+
+  CHECK(! rd.Open(path));
+  CHECK(! wr.Open(path));
+
+  unlink(path);
+}
+
+/////////////////////////// JSON and CBOR ///////////////////////////
+
+static void Check_Encode()
+{
+  static const char json[] =
+    "{\"MassPM1\":4.6,\"MassPM2\":6.6,\"MassPM4\":7.3,\"MassPM10\":8.2,\"Hum\":44.99,"
+    "\"Temp\":-3.215,\"VOC\":99.0,\"NOX\":null,\"Status\":3}";
+
+  static const char json_more[] =
+    "{\"Firmware\":\"2.10\",\"Debug\":false,\"Hardware\":\"4.0\",\"Protocol\":\"1.0\","
+    "\"Library\":\"1.1\",\"zero\":0.0,\"int\":5,\"min\":-2147483648,\"big\":null,"
+    "\"inf\":null,\"text\":\"a\\\"b\\\\c\\u000a\\u0001\",\"ok\":true}";
+
+  static const uint8_t cbor[] = {
+    0xbf,                                                   // map
+    0x67, 'M', 'a', 's', 's', 'P', 'M', '1', 0xfa, 0x40, 0x93, 0x33, 0x33,
+    0x67, 'M', 'a', 's', 's', 'P', 'M', '2', 0xfa, 0x40, 0xd3, 0x33, 0x33,
+    0x67, 'M', 'a', 's', 's', 'P', 'M', '4', 0xfa, 0x40, 0xe9, 0x99, 0x9a,
+    0x68, 'M', 'a', 's', 's', 'P', 'M', '1', '0', 0xfa, 0x41, 0x03, 0x33, 0x33,
+    0x63, 'H', 'u', 'm', 0xfa, 0x42, 0x33, 0xf5, 0xc3,
+    0x64, 'T', 'e', 'm', 'p', 0xfa, 0xc0, 0x4d, 0xc2, 0x8f,
+    0x63, 'V', 'O', 'C', 0xfa, 0x42, 0xc6, 0x00, 0x00,
+    0x63, 'N', 'O', 'X', 0xf6,                              // null
+    0x66, 'S', 't', 'a', 't', 'u', 's', 0x03,
+    0xff                                                    // break
+  };
+
+  static const uint8_t cbor_more[] = {
+    0xbf,
+    0x61, 'a', 0x17,                                        // 23
+    0x61, 'b', 0x18, 0x18,                                  // 24
+    0x61, 'c', 0x39, 0x01, 0xf3,                            // -500
+    0x61, 'd', 0x1a, 0x00, 0x01, 0x11, 0x70,                // 70000
+    0x61, 'e', 0x3a, 0x7f, 0xff, 0xff, 0xff,                // -2147483648
+    0x61, 'f', 0xfa, 0x3f, 0xc0, 0x00, 0x00,                // 1.5
+    0x61, 't', 0xf5,
+    0x61, 's', 0x62, 'h', 'i',
+    0xff
+  };
+
+  struct sen_values v;
+  struct sen_version ver = {2, 10, false, 4, 0, 1, 0, 1, 1};
+  char jb[200];
+  uint8_t cb[200];
+  uint16_t len;
+
+  printf("JSON and CBOR\n");
+
+  v.MassPM1 = 4.6; v.MassPM2 = 6.6; v.MassPM4 = 7.3; v.MassPM10 = 8.2;
+  v.Hum = 44.99; v.Temp = -3.215; v.VOC = 99; v.NOX = NAN;
+
+  SEN55Json js(jb, sizeof(jb));
+  js.Add(&v);
+  js.AddStatus(3);
+  len = js.End();
+  CHECK(len == strlen(json) && strcmp(jb, json) == 0);
+
+  js.Begin();
+  js.Add(&ver);
+  js.AddFloat("zero", -0.04, 1);
+  js.AddFloat("int", 5.2, 0);
+  js.AddInt("min", INT32_MIN);
+  js.AddFloat("big", 1e10);
+  js.AddFloat("inf", INFINITY);
+  js.AddText("text", "a\"b\\c\n\x01");
+  js.AddBool("ok", true);
+  CHECK(js.End() == strlen(json_more) && strcmp(jb, json_more) == 0);
+
+  SEN55Cbor cs(cb, sizeof(cb));
+  cs.Add(&v);
+  cs.AddStatus(3);
+  len = cs.End();
+  CHECK(len == sizeof(cbor) && memcmp(cb, cbor, len) == 0);
+
+  cs.Begin();
+  cs.AddInt("a", 23);
+  cs.AddInt("b", 24);
+  cs.AddInt("c", -500);
+  cs.AddInt("d", 70000);
+  cs.AddInt("e", INT32_MIN);
+  cs.AddFloat("f", 1.5);
+  cs.AddBool("t", true);
+  cs.AddText("s", "hi");
+  CHECK(cs.End() == sizeof(cbor_more) && memcmp(cb, cbor_more, sizeof(cbor_more)) == 0);
+
+  // buffer too small : 0, the JSON text is still terminated
+  SEN55Json exact(jb, strlen(json) + 1);
+  exact.Add(&v);
+  exact.AddStatus(3);
+  CHECK(exact.End() == strlen(json));
+
+  memset(jb, 'x', sizeof(jb));
+  SEN55Json js_small(jb, strlen(json));
+  js_small.Add(&v);
+  js_small.AddStatus(3);
+  CHECK(js_small.End() == 0);
+  CHECK(jb[strlen(json) - 1] == 0x0 && jb[strlen(json)] == 'x');
+
+  SEN55Cbor cs_exact(cb, sizeof(cbor));
+  cs_exact.Add(&v);
+  cs_exact.AddStatus(3);
+  CHECK(cs_exact.End() == sizeof(cbor));
+
+  memset(cb, 0xaa, sizeof(cb));
+  SEN55Cbor cs_small(cb, sizeof(cbor) - 1);
+  cs_small.Add(&v);
+  cs_small.AddStatus(3);
+  CHECK(cs_small.End() == 0);
+  CHECK(cb[sizeof(cbor) - 1] == 0xaa);
+
+  printf("  sen_values and status : JSON %u bytes, CBOR %u bytes\n",
+    (unsigned) strlen(json), (unsigned) sizeof(cbor));
+}
+
+int main()
+{
+  std::vector<struct sample> s;
+  char dir[] = "/tmp/check_sen55.XXXXXX";
+  std::string path;
+
+  ShimRealDelay(false);
+
+  if (! mkdtemp(dir)) {
+    perror("can not create a directory in /tmp");
+    return(1);
+  }
+
+  path = std::string(dir) + "/check.log";
+
+  // a simulated day
+  Samples(s, 86400, 3);
+
+  Check_Deadband(s);
+  Check_Series(s);
+  Check_Quantile(s);
+  Check_Log(s, path.c_str());
+  Check_Encode();
+
+  rmdir(dir);
+
+  printf("\n%lu checks, %lu failed\n", _Checks, _Failed);
+
+  return(_Failed ? 1 : 0);
+}
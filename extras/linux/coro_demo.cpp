@@ -0,0 +1,128 @@
+/**
+ * SEN55 coroutine demo
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Reads many simulated SEN55 sensors from one thread with coroutines. Each
+ * sensor has its own coroutine that reads the values every second and the
+ * status register every 10 seconds. The settings are written and read back
+ * before the measurement starts.
+ *
+ * usage : ./build/coro_demo [sensors] [seconds] [real]
+ *   sensors : number of virtual sensors (default 100)
+ *   seconds : seconds to run (default 600)
+ *   real    : 1 = run in real time, 0 = virtual time (default 0)
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_coro.h"
+#include "sen55_sim.h"
+#include <time.h>
+
+static unsigned long reads = 0, errors = 0, faults = 0, settings = 0;
+static double pm25 = 0;
+
+SEN55Task<void> Sensor(SEN55Async *s, SEN55Loop *loop, unsigned long seconds)
+{
+  struct sen_values v;
+  struct sen_xox nox = {1, 12, 12, 720, 50, 230}, nox_r;
+  uint16_t warm = 1000, warm_r = 0;
+  uint32_t ac = 3600, ac_r = 0;
+  unsigned long next = millis(), sec;
+  uint8_t status, ret;
+  bool ok;
+
+  // settings round trip
+  co_await s->Set(SEN55_SET_WARM_START_PARAM, &warm);
+  co_await s->Set(SEN55_SET_NOX_TUNING, &nox);
+  co_await s->Set(SEN55_SET_AUTO_CLEANING_INTERVAL, &ac);
+  co_await s->Get(SEN55_WARM_START_PARAM, &warm_r);
+  co_await s->Get(SEN55_NOX_TUNING, &nox_r);
+  co_await s->Get(SEN55_AUTO_CLEANING_INTERVAL, &ac_r);
+  if (warm_r == warm && ac_r == ac && nox_r.GainFactor == nox.GainFactor) settings++;
+
+  ok = co_await s->Start();
+  if (! ok) {
+    errors++;
+    co_return;
+  }
+
+  for (sec = 0; sec < seconds; sec++) {
+
+    next += 1000;
+
+    reads++;
+    ret = co_await s->GetValues(&v);
+    if (ret != SEN55_ERR_OK) errors++;
+    else pm25 += v.MassPM2;
+
+    if (sec % 10 == 0) {
+      ret = co_await s->GetStatusReg(&status);
+      if (ret == SEN55_ERR_OUTOFRANGE) faults++;
+    }
+
+    co_await loop->SleepUntil(next);
+  }
+
+  co_await s->Stop();
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned long sensors = 100, seconds = 600, i;
+  bool real = false;
+  struct timespec t0, t1;
+  double wall;
+
+  if (argc > 1) sensors = strtoul(argv[1], NULL, 10);
+  if (argc > 2) seconds = strtoul(argv[2], NULL, 10);
+  if (argc > 3) real = atoi(argv[3]) != 0;
+
+  ShimRealDelay(real);
+
+  SEN55Loop loop;
+  std::vector<SEN55Sim *> sim(sensors);
+  std::vector<SEN55 *> sen(sensors);
+  std::vector<SEN55Async *> as(sensors);
+
+  for (i = 0; i < sensors; i++) {
+    sim[i] = new SEN55Sim(i + 1);
+    sen[i] = new SEN55();
+    sen[i]->begin(sim[i]);
+    as[i] = new SEN55Async(sen[i], &loop);
+    loop.Spawn(Sensor(as[i], &loop, seconds));
+  }
+
+  // one sensor gets a fan failure
+  sim[0]->InjectStatus(SIM_STATUS_FAN);
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+
+  loop.Run();
+
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+  printf("sensors          : %lu (1 thread)\n", sensors);
+  printf("seconds          : %lu %s\n", seconds, real ? "" : "(virtual)");
+  printf("wall time        : %.3f s (%.0f reads/s)\n", wall, reads / wall);
+  printf("reads            : %lu, failed %lu\n", reads, errors);
+  printf("mean PM2.5       : %.1f ug/m3\n", reads > errors ? pm25 / (reads - errors) : 0);
+  printf("settings checked : %lu of %lu\n", settings, sensors);
+  printf("status faults    : %lu\n", faults);
+  printf("resumes          : %lu, loop waits %lu\n", loop.Resumes, loop.Waits);
+
+  for (i = 0; i < sensors; i++) {
+    delete as[i];
+    delete sen[i];
+    delete sim[i];
+  }
+
+  return(0);
+}
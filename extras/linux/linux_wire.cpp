@@ -0,0 +1,120 @@
+/**
+ * TwoWire on a Linux /dev/i2c-N bus
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "linux_wire.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+
+LinuxWire::LinuxWire()
+{
+  _Fd = _Addr = -1;
+  _Dev[0] = 0x0;
+  _TxAddr = _TxLen = _RxLen = _RxPos = 0;
+}
+
+LinuxWire::~LinuxWire()
+{
+  Close();
+}
+
+bool LinuxWire::Open(const char *dev)
+{
+  Close();
+
+  _Fd = open(dev, O_RDWR | O_CLOEXEC);
+  if (_Fd < 0) return(false);
+
+  strncpy(_Dev, dev, sizeof(_Dev) - 1);
+  _Dev[sizeof(_Dev) - 1] = 0x0;
+  return(true);
+}
+
+void LinuxWire::Close()
+{
+  if (_Fd >= 0) close(_Fd);
+  _Fd = _Addr = -1;
+}
+
+/**
+ * @brief : set the device address for the next transfer
+ */
+bool LinuxWire::Address(uint8_t addr)
+{
+  if (_Fd < 0) return(false);
+  if (_Addr == addr) return(true);
+
+  if (ioctl(_Fd, I2C_SLAVE, addr) < 0) return(false);
+
+  _Addr = addr;
+  return(true);
+}
+
+void LinuxWire::beginTransmission(uint8_t addr)
+{
+  _TxAddr = addr;
+  _TxLen = 0;
+}
+
+size_t LinuxWire::write(uint8_t c)
+{
+  if (_TxLen >= LINUX_WIRE_BUF) return(0);
+  _Tx[_TxLen++] = c;
+  return(1);
+}
+
+/**
+ * return as Arduino :
+ *  0 : success
+ *  1 : data too long
+ *  2 : NACK on address (or bus not open)
+ *  4 : other error
+ */
+uint8_t LinuxWire::endTransmission(bool stop)
+{
+  ssize_t n;
+
+  (void) stop;
+
+  if (! Address(_TxAddr)) return(2);
+
+  n = ::write(_Fd, _Tx, _TxLen);
+
+  if (n < 0) return(2);
+  if (n != _TxLen) return(4);
+
+  return(0);
+}
+
+/**
+ * return : number of bytes received
+ */
+uint8_t LinuxWire::requestFrom(uint8_t addr, uint8_t cnt, uint8_t stop)
+{
+  ssize_t n;
+
+  (void) stop;
+
+  _RxLen = _RxPos = 0;
+
+  if (cnt > LINUX_WIRE_BUF) cnt = LINUX_WIRE_BUF;
+
+  if (! Address(addr)) return(0);
+
+  n = ::read(_Fd, _Rx, cnt);
+
+  if (n > 0) _RxLen = n;
+
+  return(_RxLen);
+}
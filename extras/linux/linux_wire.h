@@ -0,0 +1,66 @@
+/**
+ * TwoWire on a Linux /dev/i2c-N bus
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Plugs in where the SEN55 library expects a TwoWire (see Wire.h in this
+ * folder). Uses the i2c-dev interface, the kernel module i2c-dev must be
+ * loaded and the user needs access to /dev/i2c-N.
+ *
+ *   LinuxWire bus;
+ *   if (! bus.Open("/dev/i2c-1")) ...
+ *   sen55.begin(&bus);
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LINUX_WIRE_H
+#define LINUX_WIRE_H
+
+#include "Wire.h"
+
+#define LINUX_WIRE_BUF 64                // max bytes in one transfer
+
+class LinuxWire : public TwoWire
+{
+  public:
+    LinuxWire();
+    ~LinuxWire();
+
+    /**
+     * @brief : open the I2C bus
+     * @param dev : device (e.g. "/dev/i2c-1")
+     * @return : true if opened
+     */
+    bool Open(const char *dev);
+    void Close();
+    const char *Device() {return(_Dev);}
+
+    void begin() {}
+    void setClock(uint32_t) {}          // set in the device tree / kernel
+    void beginTransmission(uint8_t addr);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t addr, uint8_t cnt, uint8_t stop = 1);
+
+    using Print::write;
+    size_t write(uint8_t c);
+    int available() {return(_RxLen - _RxPos);}
+    int read() {return(_RxPos < _RxLen ? _Rx[_RxPos++] : -1);}
+
+  private:
+    bool Address(uint8_t addr);
+
+    int _Fd;
+    int _Addr;                          // address set with I2C_SLAVE
+    char _Dev[32];
+    uint8_t _TxAddr;
+    uint8_t _Tx[LINUX_WIRE_BUF], _TxLen;
+    uint8_t _Rx[LINUX_WIRE_BUF], _RxLen, _RxPos;
+};
+
+#endif /* LINUX_WIRE_H */
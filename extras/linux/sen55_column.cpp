@@ -0,0 +1,228 @@
+/**
+ * SEN55 column export (Linux build)
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_column.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  #define NPY_ORDER "<"
+#else
+  #define NPY_ORDER ">"
+#endif
+
+/**
+ * name, .npy type and size of a column
+ */
+struct sen55_col {
+  const char *name;
+  const char *descr;
+  uint8_t size;
+};
+
+static const struct sen55_col Col[SEN55_COL_NUM] = {
+  {"time_us", NPY_ORDER "u8", 8}, {"sensor", NPY_ORDER "u2", 2}, {"status", "|u1", 1},
+  {"pm1", NPY_ORDER "f4", 4}, {"pm2", NPY_ORDER "f4", 4}, {"pm4", NPY_ORDER "f4", 4},
+  {"pm10", NPY_ORDER "f4", 4}, {"hum", NPY_ORDER "f4", 4}, {"temp", NPY_ORDER "f4", 4},
+  {"voc", NPY_ORDER "f4", 4}, {"nox", NPY_ORDER "f4", 4}, {"num0", NPY_ORDER "f4", 4},
+  {"num1", NPY_ORDER "f4", 4}, {"num2", NPY_ORDER "f4", 4}, {"num4", NPY_ORDER "f4", 4},
+  {"num10", NPY_ORDER "f4", 4}, {"size", NPY_ORDER "f4", 4}
+};
+
+/**
+ * @brief : write all of buf at offset
+ */
+static bool write_at(int fd, const void *buf, size_t len, off_t off)
+{
+  const uint8_t *p = (const uint8_t *) buf;
+  ssize_t n;
+
+  while (len > 0) {
+    n = pwrite(fd, p, len, off);
+    if (n <= 0) return(false);
+    p += n;
+    off += n;
+    len -= n;
+  }
+
+  return(true);
+}
+
+SEN55ColumnWriter::SEN55ColumnWriter()
+{
+  for (uint8_t c = 0; c < SEN55_COL_NUM; c++) {
+    _Fd[c] = -1;
+    _Buf[c] = NULL;
+  }
+
+  Rows = Errors = 0;
+  _Fill = 0;
+}
+
+SEN55ColumnWriter::~SEN55ColumnWriter()
+{
+  Close();
+}
+
+const char *SEN55ColumnWriter::Name(uint8_t col)
+{
+  if (col >= SEN55_COL_NUM) return("?");
+
+  return(Col[col].name);
+}
+
+bool SEN55ColumnWriter::Open(const char *dir)
+{
+  std::string path;
+
+  Close();
+
+  if (mkdir(dir, 0755) < 0 && errno != EEXIST) return(false);
+
+  _Names.clear();
+  memset(_Code, 0xff, sizeof(_Code));
+  Rows = Errors = 0;
+  _Fill = 0;
+
+  for (uint8_t c = 0; c < SEN55_COL_NUM; c++) {
+
+    path = std::string(dir) + "/" + Col[c].name + ".npy";
+
+    _Fd[c] = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    _Buf[c] = (uint8_t *) malloc(SEN55_COL_CHUNK * Col[c].size);
+
+    if (_Fd[c] < 0 || ! _Buf[c]) {
+      Close();
+      return(false);
+    }
+
+    // the number of rows is written again at Close()
+    Header(c);
+  }
+
+  _Dir = dir;
+  return(true);
+}
+
+/**
+ * @brief : write the .npy header of a column with the current number of rows
+ */
+void SEN55ColumnWriter::Header(uint8_t col)
+{
+  char hdr[SEN55_COL_HDR];
+  int n;
+
+  memcpy(hdr, "\x93NUMPY\x01\x00", 8);
+  hdr[8] = (SEN55_COL_HDR - 10) & 0xff;
+  hdr[9] = (SEN55_COL_HDR - 10) >> 8;
+
+  n = snprintf(hdr + 10, SEN55_COL_HDR - 10, "{'descr': '%s', 'fortran_order': False, 'shape': (%lu,), }",
+    Col[col].descr, Rows);
+
+  // padded with spaces, ends with a newline
+  memset(hdr + 10 + n, ' ', SEN55_COL_HDR - 10 - n);
+  hdr[SEN55_COL_HDR - 1] = '\n';
+
+  if (! write_at(_Fd[col], hdr, SEN55_COL_HDR, 0)) Errors++;
+}
+
+/**
+ * @brief : append the rows in the buffers to the files
+ */
+bool SEN55ColumnWriter::Flush()
+{
+  off_t off;
+
+  for (uint8_t c = 0; c < SEN55_COL_NUM; c++) {
+    off = SEN55_COL_HDR + (off_t) Rows * Col[c].size;
+    if (! write_at(_Fd[c], _Buf[c], (size_t) _Fill * Col[c].size, off)) Errors++;
+  }
+
+  Rows += _Fill;
+  _Fill = 0;
+
+  return(Errors == 0);
+}
+
+bool SEN55ColumnWriter::Append(const struct sen55_record *rec, const char *name)
+{
+  uint16_t code = 0xffff;
+  float *x;
+
+  if (_Dir.empty()) return(false);
+
+  // dictionary : code of the sensor
+  if (rec->sensor < SEN55_SHM_SENSORS) code = _Code[rec->sensor];
+
+  if (code == 0xffff) {
+
+    for (code = 0; code < _Names.size(); code++) {
+      if (_Names[code] == name) break;
+    }
+
+    if (code == _Names.size()) _Names.push_back(name);
+    if (rec->sensor < SEN55_SHM_SENSORS) _Code[rec->sensor] = code;
+  }
+
+  ((uint64_t *) _Buf[SEN55_COL_TIME])[_Fill] = rec->time_us;
+  ((uint16_t *) _Buf[SEN55_COL_SENSOR])[_Fill] = code;
+  _Buf[SEN55_COL_STATUS][_Fill] = rec->status;
+
+  for (uint8_t f = 0; f < SEN55_FLD_NUM; f++) {
+    x = (float *) _Buf[SEN55_COL_FIELD + f];
+    x[_Fill] = SEN55LogField(rec, f);
+  }
+
+  if (++_Fill < SEN55_COL_CHUNK) return(true);
+
+  return(Flush());
+}
+
+bool SEN55ColumnWriter::Close()
+{
+  bool opened = ! _Dir.empty();
+  std::string path;
+  FILE *fp;
+
+  if (opened) Flush();
+
+  for (uint8_t c = 0; c < SEN55_COL_NUM; c++) {
+
+    if (_Fd[c] >= 0) {
+      if (opened) Header(c);
+      close(_Fd[c]);
+      _Fd[c] = -1;
+    }
+
+    free(_Buf[c]);
+    _Buf[c] = NULL;
+  }
+
+  if (! opened) return(false);
+
+  // dictionary : line (code + 1) is the name of code
+  path = _Dir + "/sensors.txt";
+  _Dir.clear();
+
+  fp = fopen(path.c_str(), "w");
+
+  if (fp) {
+    for (size_t i = 0; i < _Names.size(); i++) fprintf(fp, "%s\n", _Names[i].c_str());
+    if (fclose(fp) != 0) Errors++;
+  }
+  else Errors++;
+
+  return(Errors == 0);
+}
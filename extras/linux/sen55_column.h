@@ -0,0 +1,100 @@
+/**
+ * SEN55 column export (Linux build)
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Writes samples (e.g. from a binary log, see sen55_log.h) as columns : one
+ * file per field with a contiguous typed array, so an analysis tool reads
+ * only the fields it needs and scans them without a transpose. The files are
+ * NumPy .npy (a 128 byte header, then the array) and can be mapped directly :
+ *
+ *   time_us.npy  uint64   CLOCK_REALTIME in uS
+ *   sensor.npy   uint16   code of the sensor, the name is line (code + 1) of sensors.txt
+ *   status.npy   uint8    device status
+ *   pm1.npy ... size.npy  float32 per SEN55_FLD_xxx, NaN if not in the sample
+ *
+ *   >>> import numpy as np
+ *   >>> pm2 = np.load("out/pm2.npy", mmap_mode="r")
+ *
+ * The rows are collected in chunks of SEN55_COL_CHUNK and then appended to
+ * the files : the memory use does not depend on the number of samples. The
+ * number of rows in the headers is written at Close().
+ *
+ *   SEN55ColumnWriter col;
+ *
+ *   col.Open("out");
+ *   while ((rec = rd.Next(&pos))) col.Append(rec, rd.SensorName(rec->sensor));
+ *   col.Close();
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SEN55_COLUMN_H
+#define SEN55_COLUMN_H
+
+#include "sen55_log.h"
+#include <string>
+
+#define SEN55_COL_CHUNK   4096          // rows kept in memory
+#define SEN55_COL_HDR     128           // bytes of the .npy header (keeps the array aligned)
+
+/** columns */
+#define SEN55_COL_TIME    0
+#define SEN55_COL_SENSOR  1
+#define SEN55_COL_STATUS  2
+#define SEN55_COL_FIELD   3             // first field, + SEN55_FLD_xxx
+#define SEN55_COL_NUM     (SEN55_COL_FIELD + SEN55_FLD_NUM)
+
+class SEN55ColumnWriter
+{
+  public:
+    SEN55ColumnWriter();
+    ~SEN55ColumnWriter();
+
+    /**
+     * @brief : create the directory (if needed) and the column files
+     * @return : false if a file could not be created
+     */
+    bool Open(const char *dir);
+
+    /**
+     * @brief : add a sample
+     * @param rec  : the sample
+     * @param name : name of its sensor (rec->sensor is only used to find the
+     * code of a sensor that was seen before)
+     * @return : false if writing the columns failed
+     */
+    bool Append(const struct sen55_record *rec, const char *name);
+
+    /**
+     * @brief : write the last rows, the headers and sensors.txt
+     * @return : false if writing failed (now or before)
+     */
+    bool Close();
+
+    /**
+     * @brief : file name (without .npy) of a column
+     */
+    static const char *Name(uint8_t col);
+
+    unsigned long Rows;                 // rows written
+    unsigned long Errors;               // failed writes
+
+  private:
+    bool Flush();
+    void Header(uint8_t col);
+
+    int _Fd[SEN55_COL_NUM];
+    uint8_t *_Buf[SEN55_COL_NUM];       // SEN55_COL_CHUNK values per column
+    uint32_t _Fill;                     // rows in the buffers
+    uint16_t _Code[SEN55_SHM_SENSORS];  // code per sensor of the record (0xffff = not seen)
+    std::vector<std::string> _Names;    // name per code
+    std::string _Dir;
+};
+
+#endif /* SEN55_COLUMN_H */
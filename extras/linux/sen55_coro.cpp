@@ -0,0 +1,245 @@
+/**
+ * C++20 coroutine interface for the SEN55 library (Linux build)
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_coro.h"
+
+/////////////////////////// scheduler ////////////////////////////
+
+SEN55Loop::~SEN55Loop()
+{
+  for (auto h : _Tasks) h.destroy();
+}
+
+void SEN55Loop::At(unsigned long due, std::coroutine_handle<> h)
+{
+  _Timers.push(Entry{due, _Seq++, h});
+}
+
+void SEN55Loop::Spawn(SEN55Task<void> &&t)
+{
+  SEN55Task<void>::Handle h = t.Release();
+
+  _Tasks.push_back(h);
+  At(millis(), h);
+}
+
+/**
+ * @brief : resume the coroutines in order of their due time
+ *
+ * In between the loop waits with delay(), in virtual time (ShimRealDelay(false))
+ * the clock is moved forward to the next due time.
+ */
+void SEN55Loop::Run()
+{
+  long wait;
+
+  _Stop = false;
+
+  while (! _Stop && ! _Timers.empty()) {
+
+    Entry e = _Timers.top();
+
+    wait = (long) (e.due - millis());
+
+    if (wait > 0) {
+      Waits++;
+      delay(wait);
+      continue;
+    }
+
+    _Timers.pop();
+    Resumes++;
+    e.h.resume();
+  }
+
+  // remove the finished tasks
+  for (size_t i = 0; i < _Tasks.size();) {
+    if (_Tasks[i].done()) {
+      _Tasks[i].destroy();
+      _Tasks[i] = _Tasks.back();
+      _Tasks.pop_back();
+    }
+    else i++;
+  }
+}
+
+///////////////////////// SEN55 interface ////////////////////////
+
+// NOTE : the result of co_await is always stored before it is tested, GCC 12
+// does not resume a coroutine that has co_await in the condition of an if().
+
+SEN55Async::SEN55Async(SEN55 *sen, SEN55Loop *loop)
+{
+  _Sen = sen;
+  _Loop = loop;
+  _Busy = false;
+  _Started = false;
+  _FWChecked = false;
+  _Ready = millis();
+}
+
+/**
+ * @brief : hand the SEN55 to the next waiting coroutine
+ */
+void SEN55Async::Unlock()
+{
+  if (_Waiting.empty()) {
+    _Busy = false;
+    return;
+  }
+
+  // stays busy, the next one continues from the loop
+  _Loop->At(millis(), _Waiting.front());
+  _Waiting.pop_front();
+}
+
+/**
+ * @brief : perform one transaction
+ * @param cmd    : SEN55 command
+ * @param val    : value for a set-command (else NULL)
+ * @param result : to hold the answer of a read command (else NULL)
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  else error
+ */
+SEN55Task<uint8_t> SEN55Async::Transact(uint16_t cmd, void *val, void *result)
+{
+  uint8_t ret;
+
+  co_await Lock{this};
+
+  // previous command still executing ?
+  co_await _Loop->SleepUntil(_Ready);
+
+  ret = _Sen->Request(cmd, val);
+
+  if (ret == SEN55_ERR_OK) {
+    co_await _Loop->Sleep(_Sen->RequestDelay(cmd));
+    ret = _Sen->Collect(cmd, result);
+  }
+
+  _Ready = millis();
+  Unlock();
+
+  co_return(ret);
+}
+
+SEN55Task<bool> SEN55Async::Instruct(uint16_t cmd)
+{
+  uint8_t ret;
+
+  if (cmd == SEN55_START_FAN_CLEANING && ! _Started) co_return(false);
+
+  ret = co_await Transact(cmd, NULL, NULL);
+
+  if (ret != SEN55_ERR_OK) co_return(false);
+
+  if (cmd == SEN55_START_MEASUREMENT || cmd == SEN55_START_RHTG_MEASUREMENT) _Started = true;
+  else if (cmd == SEN55_STOP_MEASUREMENT || cmd == SEN55_RESET) _Started = false;
+
+  co_return(true);
+}
+
+/**
+ * @brief : start the measurement if not started yet (for reading values)
+ * @param laser : start with the laser (else only RHT and gas)
+ *
+ * return
+ *  true = measurement is started
+ *  false = could not start
+ */
+SEN55Task<bool> SEN55Async::StartIfNeeded(bool laser)
+{
+  bool ok;
+
+  if (_Started) co_return(true);
+
+  ok = co_await Instruct(laser ? SEN55_START_MEASUREMENT : SEN55_START_RHTG_MEASUREMENT);
+  if (! ok) co_return(false);
+
+  co_await _Loop->Sleep(100);
+
+  co_return(true);
+}
+
+SEN55Task<uint8_t> SEN55Async::GetValues(struct sen_values *v, bool laser)
+{
+  uint8_t ret;
+  bool ok;
+
+  ok = co_await StartIfNeeded(laser);
+  if (! ok) co_return(SEN55_ERR_CMDSTATE);
+
+  ret = co_await Transact(SEN55_READ_MEASURED_VALUE, NULL, v);
+
+  co_return(ret);
+}
+
+SEN55Task<uint8_t> SEN55Async::GetValuesPM(struct sen_values_pm *v)
+{
+  uint8_t ret;
+  bool ok;
+
+  ok = co_await StartIfNeeded(true);
+  if (! ok) co_return(SEN55_ERR_CMDSTATE);
+
+  ret = co_await Transact(SEN55_READ_MEASURED_VALUE_PM, NULL, v);
+
+  co_return(ret);
+}
+
+SEN55Task<uint8_t> SEN55Async::GetStatusReg(uint8_t *status)
+{
+  struct sen_version ver;
+  uint8_t ret;
+
+  *status = STATUS_OK_55;
+
+  // check for minimum Firmware level
+  if (! _FWChecked) {
+    ret = co_await Transact(SEN55_READ_VERSION, NULL, &ver);
+    if (ret != SEN55_ERR_OK) co_return(ret);
+    if (ver.F_major < 2) co_return(SEN55_ERR_FIRMWARE);
+    _FWChecked = true;
+  }
+
+  ret = co_await Transact(SEN55_READ_DEVICE_REGISTER, NULL, status);
+
+  // clear status register only if there was an issue
+  if (ret == SEN55_ERR_OUTOFRANGE) co_await Transact(SEN55_CLEAR_DEVICE_REGISTER, NULL, NULL);
+
+  co_return(ret);
+}
+
+SEN55Task<uint8_t> SEN55Async::Set(uint16_t cmd, void *val)
+{
+  bool save_started = false, ok;
+  uint8_t ret;
+
+  // change can only be applied when idle
+  if (cmd == SEN55_SET_AUTO_CLEANING_INTERVAL && _Started) {
+    ok = co_await Stop();
+    if (! ok) co_return(SEN55_ERR_CMDSTATE);
+    save_started = true;
+  }
+
+  ret = co_await Transact(cmd, val, NULL);
+
+  if (save_started) {
+    ok = co_await Start();
+    if (! ok) ret = SEN55_ERR_PROTOCOL;
+  }
+
+  co_return(ret);
+}
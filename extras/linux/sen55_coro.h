@@ -0,0 +1,276 @@
+/**
+ * C++20 coroutine interface for the SEN55 library (Linux build)
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Many SEN55 sensors can be handled by one thread. Each transaction is split
+ * in SEN55::Request() and SEN55::Collect(), in between the coroutine is
+ * suspended and the loop resumes other coroutines. The loop resumes the
+ * coroutine again after SEN55::RequestDelay().
+ *
+ *   SEN55Loop loop;
+ *   SEN55Async sensor(&sen55, &loop);
+ *
+ *   SEN55Task<void> read(SEN55Async *s, SEN55Loop *loop) {
+ *     struct sen_values v;
+ *     uint8_t ret;
+ *     co_await s->Start();
+ *     while (1) {
+ *       ret = co_await s->GetValues(&v);
+ *       if (ret == SEN55_ERR_OK) printf("%f\n", v.MassPM2);
+ *       co_await loop->Sleep(1000);
+ *     }
+ *   }
+ *
+ *   loop.Spawn(read(&sensor, &loop));
+ *   loop.Run();
+ *
+ * Store the result of co_await before testing it (see sen55_coro.cpp).
+ *
+ * The loop uses millis() and delay() of the Arduino shim. With
+ * ShimRealDelay(false) the loop runs in virtual time (simulations).
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SEN55_CORO_H
+#define SEN55_CORO_H
+
+#if __cplusplus < 202002L
+#error "sen55_coro.h needs C++20 (-std=c++20)"
+#endif
+
+#include "sen55.h"
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <queue>
+#include <utility>
+#include <vector>
+
+template <typename T> class SEN55Task;
+
+/**
+ * promise : result and continuation of a SEN55Task
+ */
+class SEN55PromiseBase
+{
+  public:
+    std::coroutine_handle<> Continuation;
+
+    std::suspend_always initial_suspend() noexcept {return {};}
+
+    // resume the awaiting coroutine (if any) when done
+    struct Final {
+      bool await_ready() noexcept {return(false);}
+      template <typename P>
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+        std::coroutine_handle<> c = h.promise().Continuation;
+        return(c ? c : std::noop_coroutine());
+      }
+      void await_resume() noexcept {}
+    };
+    Final final_suspend() noexcept {return {};}
+
+    void unhandled_exception() {std::terminate();}
+};
+
+template <typename T>
+class SEN55Promise : public SEN55PromiseBase
+{
+  public:
+    T Value{};
+    SEN55Task<T> get_return_object();
+    void return_value(T v) {Value = v;}
+};
+
+template <>
+class SEN55Promise<void> : public SEN55PromiseBase
+{
+  public:
+    SEN55Task<void> get_return_object();
+    void return_void() {}
+};
+
+/**
+ * coroutine task, starts when awaited (or spawned on the loop)
+ */
+template <typename T>
+class SEN55Task
+{
+  public:
+    using promise_type = SEN55Promise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit SEN55Task(Handle h) : _h(h) {}
+    SEN55Task(SEN55Task &&t) noexcept : _h(std::exchange(t._h, nullptr)) {}
+    SEN55Task(const SEN55Task &) = delete;
+    SEN55Task &operator=(const SEN55Task &) = delete;
+    ~SEN55Task() {if (_h) _h.destroy();}
+
+    bool Done() const {return(! _h || _h.done());}
+    Handle Release() {return(std::exchange(_h, nullptr));}
+
+    bool await_ready() const noexcept {return(false);}
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept {
+      _h.promise().Continuation = c;
+      return(_h);
+    }
+    T await_resume() {
+      if constexpr (! std::is_void_v<T>) return(_h.promise().Value);
+    }
+
+  private:
+    Handle _h;
+};
+
+template <typename T>
+SEN55Task<T> SEN55Promise<T>::get_return_object()
+{
+  return(SEN55Task<T>(std::coroutine_handle<SEN55Promise<T>>::from_promise(*this)));
+}
+
+inline SEN55Task<void> SEN55Promise<void>::get_return_object()
+{
+  return(SEN55Task<void>(std::coroutine_handle<SEN55Promise<void>>::from_promise(*this)));
+}
+
+/**
+ * timer driven scheduler (single thread)
+ */
+class SEN55Loop
+{
+  public:
+    SEN55Loop() {Resumes = Waits = _Seq = 0; _Stop = false;}
+    ~SEN55Loop();
+
+    /**
+     * @brief : co_await Sleep(ms) / SleepUntil(millis()) to suspend the coroutine
+     */
+    struct Timer {
+      SEN55Loop *loop;
+      unsigned long due;
+      bool await_ready() const noexcept {return((long) (due - millis()) <= 0);}
+      void await_suspend(std::coroutine_handle<> h) {loop->At(due, h);}
+      void await_resume() const noexcept {}
+    };
+    Timer Sleep(unsigned long ms) {return Timer{this, millis() + ms};}
+    Timer SleepUntil(unsigned long due) {return Timer{this, due};}
+
+    /**
+     * @brief : resume coroutine h at millis() due
+     */
+    void At(unsigned long due, std::coroutine_handle<> h);
+
+    /**
+     * @brief : start a task, the loop owns it from now on
+     */
+    void Spawn(SEN55Task<void> &&t);
+
+    /**
+     * @brief : resume the coroutines until nothing is waiting or Stop() is called
+     */
+    void Run();
+    void Stop() {_Stop = true;}
+
+    unsigned long Resumes;              // coroutines resumed
+    unsigned long Waits;                // times the loop waited for a timer
+
+  private:
+    struct Entry {
+      unsigned long due;
+      unsigned long seq;                // keep order for equal due
+      std::coroutine_handle<> h;
+      bool operator>(const Entry &e) const {
+        long d = (long) (due - e.due);
+        return(d > 0 || (d == 0 && seq > e.seq));
+      }
+    };
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> _Timers;
+    std::vector<SEN55Task<void>::Handle> _Tasks;
+    unsigned long _Seq;
+    bool _Stop;
+};
+
+/**
+ * coroutine interface for one SEN55
+ *
+ * The routines follow the SEN55 routines with the same name and return the same
+ * error codes. One transaction at a time is performed on the SEN55, other
+ * coroutines that want to use the same SEN55 wait in order of arrival.
+ * Do not use the SEN55 routines directly while coroutines are using it.
+ */
+class SEN55Async
+{
+  public:
+    SEN55Async(SEN55 *sen, SEN55Loop *loop);
+
+    /**
+     * @brief : SEN55 instructions, see SEN55::start() etc.
+     */
+    SEN55Task<bool> Start()     {return(Instruct(SEN55_START_MEASUREMENT));}
+    SEN55Task<bool> StartRHTG() {return(Instruct(SEN55_START_RHTG_MEASUREMENT));}
+    SEN55Task<bool> Stop()      {return(Instruct(SEN55_STOP_MEASUREMENT));}
+    SEN55Task<bool> Reset()     {return(Instruct(SEN55_RESET));}
+    SEN55Task<bool> Clean()     {return(Instruct(SEN55_START_FAN_CLEANING));}
+
+    /**
+     * @brief : retrieve values, see SEN55::GetValues() and SEN55::GetValuesPM()
+     * The measurement is started if needed.
+     */
+    SEN55Task<uint8_t> GetValues(struct sen_values *v, bool laser = true);
+    SEN55Task<uint8_t> GetValuesPM(struct sen_values_pm *v);
+
+    /**
+     * @brief : read (and clear) the status register, see SEN55::GetStatusReg()
+     */
+    SEN55Task<uint8_t> GetStatusReg(uint8_t *status);
+
+    /**
+     * @brief : read or write a setting
+     *
+     * @param cmd    : read command (e.g. SEN55_WARM_START_PARAM) or set-command
+     *                 (e.g. SEN55_SET_WARM_START_PARAM)
+     * @param result / val : as SEN55::Collect() / SEN55::Request()
+     *
+     * SEN55_SET_AUTO_CLEANING_INTERVAL is only accepted when the measurement is
+     * stopped, Set() will stop and restart the measurement (as SetAutoCleanInt())
+     */
+    SEN55Task<uint8_t> Get(uint16_t cmd, void *result) {return(Transact(cmd, NULL, result));}
+    SEN55Task<uint8_t> Set(uint16_t cmd, void *val);
+
+    /**
+     * @brief : one complete transaction : Request(), wait, Collect()
+     */
+    SEN55Task<uint8_t> Transact(uint16_t cmd, void *val, void *result);
+
+    SEN55 *Sensor() {return(_Sen);}
+
+  private:
+    SEN55Task<bool> Instruct(uint16_t cmd);
+    SEN55Task<bool> StartIfNeeded(bool laser);
+
+    // one transaction at a time on the SEN55
+    struct Lock {
+      SEN55Async *s;
+      bool await_ready() const noexcept {return(! s->_Busy);}
+      void await_suspend(std::coroutine_handle<> h) {s->_Waiting.push_back(h);}
+      void await_resume() noexcept {s->_Busy = true;}
+    };
+    void Unlock();
+
+    SEN55 *_Sen;
+    SEN55Loop *_Loop;
+    bool _Busy;
+    bool _Started;                      // measurement started
+    bool _FWChecked;                    // firmware level for the status register checked
+    unsigned long _Ready;               // millis() the SEN55 accepts the next command
+    std::deque<std::coroutine_handle<>> _Waiting;
+};
+
+#endif /* SEN55_CORO_H */
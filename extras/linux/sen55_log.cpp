@@ -0,0 +1,565 @@
+/**
+ * SEN55 binary sample log (Linux build)
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_log.h"
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static_assert(sizeof(struct sen55_log_hdr) <= SEN55_LOG_HDR, "SEN55_LOG_HDR too small");
+
+/**
+ * @brief : CRC32 (IEEE 802.3, as zlib), 8 bytes per step (slicing-by-8)
+ */
+static uint32_t crc32(const void *buf, size_t len)
+{
+  static uint32_t table[8][256];
+  const uint8_t *p = (const uint8_t *) buf;
+  uint32_t crc = 0xffffffff, c, lo, hi;
+
+  if (table[0][1] == 0) {
+    for (uint32_t i = 0; i < 256; i++) {
+      c = i;
+      for (int j = 0; j < 8; j++) c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      table[0][i] = c;
+    }
+
+    for (uint32_t i = 0; i < 256; i++) {
+      for (int k = 1; k < 8; k++) table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+    }
+  }
+
+  while (len >= 8) {
+    lo = (p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24) ^ crc;
+    hi = p[4] | p[5] << 8 | p[6] << 16 | (uint32_t) p[7] << 24;
+
+    crc = table[7][lo & 0xff] ^ table[6][(lo >> 8) & 0xff] ^ table[5][(lo >> 16) & 0xff] ^ table[4][lo >> 24] ^
+          table[3][hi & 0xff] ^ table[2][(hi >> 8) & 0xff] ^ table[1][(hi >> 16) & 0xff] ^ table[0][hi >> 24];
+
+    p += 8;
+    len -= 8;
+  }
+
+  while (len--) crc = table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+
+  return(crc ^ 0xffffffff);
+}
+
+/**
+ * @brief : CRC of a block (the aggregates are just before the records)
+ */
+static uint32_t block_crc(const struct sen55_log_block *blk)
+{
+  return(crc32(blk->agg, sizeof(blk->agg) + blk->count * sizeof(struct sen55_record)));
+}
+
+float SEN55LogField(const struct sen55_record *rec, uint8_t fld)
+{
+  if (rec->flags & SEN55_REC_VALUES && fld <= SEN55_FLD_NOX)
+    return(SEN55Field((struct sen_values *) &rec->v, fld));
+
+  if (rec->flags & SEN55_REC_PM)
+    return(SEN55Field((struct sen_values_pm *) &rec->pm, fld));
+
+  return(NAN);
+}
+
+/**
+ * @brief : add samples to an aggregate
+ */
+static void agg_add(struct sen55_log_agg *a, float min, float max, double sum, uint32_t count)
+{
+  if (count == 0) return;
+
+  if (a->count == 0 || min < a->min) a->min = min;
+  if (a->count == 0 || max > a->max) a->max = max;
+  a->sum += sum;
+  a->count += count;
+}
+
+/**
+ * @brief : can a file with this header be read / continued
+ */
+static bool log_valid(const struct sen55_log_hdr *hdr)
+{
+  return(hdr->magic == SEN55_LOG_MAGIC && hdr->version == SEN55_LOG_VERSION &&
+    hdr->rec_size == sizeof(struct sen55_record) && hdr->block_recs == SEN55_LOG_RECS &&
+    hdr->sensors <= SEN55_SHM_SENSORS);
+}
+
+/////////////////////////// writer ///////////////////////////////
+
+SEN55LogWriter::SEN55LogWriter()
+{
+  _Fd = -1;
+  Errors = 0;
+}
+
+SEN55LogWriter::~SEN55LogWriter()
+{
+  Close();
+}
+
+bool SEN55LogWriter::Open(const char *path)
+{
+  struct timespec ts;
+  struct stat st;
+
+  Close();
+
+  _Fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (_Fd < 0) return(false);
+
+  _Blk.assign(SEN55_SHM_SENSORS, NULL);
+  _Off.assign(SEN55_SHM_SENSORS, 0);
+  _Dirty.assign(SEN55_SHM_SENSORS, false);
+  _End = SEN55_LOG_HDR;
+  _Seq = 0;
+  Errors = 0;
+
+  if (fstat(_Fd, &st) < 0) {
+    Close();
+    return(false);
+  }
+
+  // new file
+  if (st.st_size == 0) {
+    memset(&_Hdr, 0x0, sizeof(_Hdr));
+    _Hdr.magic = SEN55_LOG_MAGIC;
+    _Hdr.version = SEN55_LOG_VERSION;
+    _Hdr.rec_size = sizeof(struct sen55_record);
+    _Hdr.block_recs = SEN55_LOG_RECS;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    _Hdr.created_us = (uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+
+    if (! WriteHeader()) {
+      Close();
+      return(false);
+    }
+
+    return(true);
+  }
+
+  if (pread(_Fd, &_Hdr, sizeof(_Hdr), 0) != sizeof(_Hdr) || ! log_valid(&_Hdr) || ! Resume()) {
+    Close();
+    return(false);
+  }
+
+  return(true);
+}
+
+/**
+ * @brief : continue an existing file : find the next block number and load
+ * the last block of each sensor if it was not full
+ */
+bool SEN55LogWriter::Resume()
+{
+  struct sen55_log_block bh, *blk;
+  std::vector<uint64_t> last(SEN55_SHM_SENSORS, 0);
+  std::vector<bool> found(SEN55_SHM_SENSORS, false);
+  struct stat st;
+  uint64_t off;
+  size_t len;
+
+  if (fstat(_Fd, &st) < 0) return(false);
+
+  for (off = SEN55_LOG_HDR; off < (uint64_t) st.st_size; off += SEN55_LOG_BLOCK) {
+
+    _End = off + SEN55_LOG_BLOCK;
+
+    if (pread(_Fd, &bh, sizeof(bh), off) != sizeof(bh)) continue;
+    if (bh.magic != SEN55_LOG_BMAGIC || bh.sensor >= SEN55_SHM_SENSORS) continue;
+
+    if (bh.seq >= _Seq) _Seq = bh.seq + 1;
+
+    if (! found[bh.sensor] || bh.seq > last[bh.sensor]) {
+      found[bh.sensor] = true;
+      last[bh.sensor] = bh.seq;
+      _Off[bh.sensor] = off;
+    }
+  }
+
+  for (uint16_t s = 0; s < SEN55_SHM_SENSORS; s++) {
+
+    if (! found[s]) continue;
+
+    blk = (struct sen55_log_block *) calloc(1, SEN55_LOG_BLOCK);
+    if (! blk) return(false);
+
+    _Blk[s] = blk;
+
+    if (pread(_Fd, blk, sizeof(*blk), _Off[s]) != sizeof(*blk) || blk->count >= SEN55_LOG_RECS) {
+      blk->count = 0;
+      continue;
+    }
+
+    // not full : continue it if it was written completely
+    len = blk->count * sizeof(struct sen55_record);
+
+    if (pread(_Fd, SEN55LogRecords(blk), len, _Off[s] + sizeof(*blk)) != (ssize_t) len ||
+        block_crc(blk) != blk->crc)
+      blk->count = 0;
+  }
+
+  return(true);
+}
+
+void SEN55LogWriter::Close()
+{
+  if (_Fd < 0) return;
+
+  Flush();
+
+  for (size_t i = 0; i < _Blk.size(); i++) free(_Blk[i]);
+  _Blk.clear();
+
+  close(_Fd);
+  _Fd = -1;
+}
+
+bool SEN55LogWriter::WriteHeader()
+{
+  if (pwrite(_Fd, &_Hdr, sizeof(_Hdr), 0) == sizeof(_Hdr)) return(true);
+
+  Errors++;
+  return(false);
+}
+
+uint16_t SEN55LogWriter::AddSensor(const char *name)
+{
+  uint32_t i;
+
+  if (_Fd < 0) return(0xffff);
+
+  for (i = 0; i < _Hdr.sensors; i++) {
+    if (strncmp(_Hdr.names[i], name, SEN55_SHM_NAME - 1) == 0) return(i);
+  }
+
+  if (i >= SEN55_SHM_SENSORS) return(0xffff);
+
+  strncpy(_Hdr.names[i], name, SEN55_SHM_NAME - 1);
+  _Hdr.sensors = i + 1;
+
+  WriteHeader();
+
+  return(i);
+}
+
+/**
+ * @brief : write the open block of a sensor (header and the records so far)
+ */
+bool SEN55LogWriter::WriteBlock(uint16_t sensor)
+{
+  struct sen55_log_block *blk = _Blk[sensor];
+  size_t len = sizeof(*blk) + blk->count * sizeof(struct sen55_record);
+
+  blk->crc = block_crc(blk);
+
+  _Dirty[sensor] = false;
+
+  if (pwrite(_Fd, blk, len, _Off[sensor]) == (ssize_t) len) return(true);
+
+  Errors++;
+  return(false);
+}
+
+bool SEN55LogWriter::Append(uint16_t sensor, uint8_t status, struct sen_values *v, struct sen_values_pm *pm, uint64_t time_us)
+{
+  struct sen55_log_block *blk;
+  struct sen55_record *rec;
+  struct timespec ts;
+  float x;
+
+  if (_Fd < 0 || sensor >= _Hdr.sensors) return(false);
+
+  if (time_us == 0) {
+    clock_gettime(CLOCK_REALTIME, &ts);
+    time_us = (uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+  }
+
+  blk = _Blk[sensor];
+
+  if (! blk) {
+    blk = (struct sen55_log_block *) calloc(1, SEN55_LOG_BLOCK);
+    if (! blk) return(false);
+    _Blk[sensor] = blk;
+  }
+
+  // start a new block at the end of the file
+  if (blk->count == 0) {
+    blk->magic = SEN55_LOG_BMAGIC;
+    blk->sensor = sensor;
+    blk->seq = _Seq++;
+    blk->first_us = blk->last_us = time_us;
+    memset(blk->agg, 0x0, sizeof(blk->agg));
+    _Off[sensor] = _End;
+    _End += SEN55_LOG_BLOCK;
+  }
+
+  rec = &SEN55LogRecords(blk)[blk->count];
+  memset(rec, 0x0, sizeof(*rec));
+
+  rec->time_us = time_us;
+  rec->sensor = sensor;
+  rec->status = status;
+
+  if (v) {
+    rec->v = *v;
+    rec->flags |= SEN55_REC_VALUES;
+  }
+
+  if (pm) {
+    rec->pm = *pm;
+    rec->flags |= SEN55_REC_PM;
+  }
+
+  for (uint8_t f = 0; f < SEN55_FLD_NUM; f++) {
+    x = SEN55LogField(rec, f);
+    if (! isnan(x)) agg_add(&blk->agg[f], x, x, x, 1);
+  }
+
+  if (time_us < blk->first_us) blk->first_us = time_us;
+  if (time_us > blk->last_us) blk->last_us = time_us;
+  blk->count++;
+  _Dirty[sensor] = true;
+
+  if (blk->count < SEN55_LOG_RECS) return(true);
+
+  // full : write, the next record starts a new block
+  bool ret = WriteBlock(sensor);
+  blk->count = 0;
+
+  return(ret);
+}
+
+bool SEN55LogWriter::Flush(bool sync)
+{
+  bool ret = true;
+
+  if (_Fd < 0) return(false);
+
+  for (uint16_t s = 0; s < _Hdr.sensors; s++) {
+    if (_Dirty[s] && ! WriteBlock(s)) ret = false;
+  }
+
+  if (sync && fdatasync(_Fd) < 0) {
+    Errors++;
+    ret = false;
+  }
+
+  return(ret);
+}
+
+/////////////////////////// reader ///////////////////////////////
+
+SEN55LogReader::SEN55LogReader()
+{
+  _Map = NULL;
+  _Size = 0;
+  _Hdr = NULL;
+  Records = Bad = 0;
+  Summed = Scanned = 0;
+}
+
+SEN55LogReader::~SEN55LogReader()
+{
+  Close();
+}
+
+bool SEN55LogReader::Open(const char *path, bool verify)
+{
+  const struct sen55_log_block *blk;
+  struct stat st;
+  size_t off;
+  int fd;
+  void *p;
+
+  Close();
+
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return(false);
+
+  if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(struct sen55_log_hdr)) {
+    close(fd);
+    return(false);
+  }
+
+  p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (p == MAP_FAILED) return(false);
+
+  _Map = (uint8_t *) p;
+  _Size = st.st_size;
+  _Hdr = (const struct sen55_log_hdr *) p;
+
+  if (! log_valid(_Hdr)) {
+    Close();
+    return(false);
+  }
+
+  // without verify only the block headers are read
+  if (verify) madvise(_Map, _Size, MADV_SEQUENTIAL);
+
+  _Sensor.assign(_Hdr->sensors, std::vector<const struct sen55_log_block *>());
+
+  for (off = SEN55_LOG_HDR; off + sizeof(*blk) <= _Size; off += SEN55_LOG_BLOCK) {
+
+    blk = (const struct sen55_log_block *) (_Map + off);
+
+    // never written (the writer stopped before it flushed this block)
+    if (blk->magic == 0) continue;
+
+    if (blk->magic != SEN55_LOG_BMAGIC || blk->count == 0 || blk->count > SEN55_LOG_RECS ||
+        blk->sensor >= _Hdr->sensors ||
+        off + sizeof(*blk) + blk->count * sizeof(struct sen55_record) > _Size ||
+        (verify && block_crc(blk) != blk->crc)) {
+      Bad++;
+      continue;
+    }
+
+    _Index.push_back(blk);
+    _Sensor[blk->sensor].push_back(blk);
+    Records += blk->count;
+  }
+
+  return(true);
+}
+
+void SEN55LogReader::Close()
+{
+  if (! _Map) return;
+
+  munmap(_Map, _Size);
+  _Map = NULL;
+  _Hdr = NULL;
+  _Index.clear();
+  _Sensor.clear();
+  Records = Bad = 0;
+}
+
+void SEN55LogReader::Begin(struct sen55_log_pos *pos, int sensor)
+{
+  pos->block = 0;
+  pos->rec = 0;
+  pos->sensor = sensor;
+}
+
+const struct sen55_record *SEN55LogReader::Next(struct sen55_log_pos *pos)
+{
+  const struct sen55_log_block *blk;
+
+  while (pos->block < _Index.size()) {
+
+    blk = _Index[pos->block];
+
+    if ((pos->sensor < 0 || blk->sensor == pos->sensor) && pos->rec < blk->count)
+      return(&SEN55LogRecords(blk)[pos->rec++]);
+
+    pos->block++;
+    pos->rec = 0;
+  }
+
+  return(NULL);
+}
+
+const char *SEN55LogReader::SensorName(uint16_t sensor)
+{
+  if (! _Hdr || sensor >= _Hdr->sensors) return("?");
+
+  return(_Hdr->names[sensor]);
+}
+
+int SEN55LogReader::FindSensor(const char *name)
+{
+  if (! _Hdr) return(-1);
+
+  for (uint32_t i = 0; i < _Hdr->sensors; i++) {
+    if (strncmp(_Hdr->names[i], name, SEN55_SHM_NAME - 1) == 0) return(i);
+  }
+
+  return(-1);
+}
+
+/**
+ * @brief : blocks of a sensor are in time order : first block that ends at or after t
+ */
+static size_t first_block(const std::vector<const struct sen55_log_block *> &idx, uint64_t t)
+{
+  size_t lo = 0, hi = idx.size(), mid;
+
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (idx[mid]->last_us < t) lo = mid + 1;
+    else hi = mid;
+  }
+
+  return(lo);
+}
+
+uint8_t SEN55LogReader::Query(uint16_t sensor, uint64_t from_us, uint64_t to_us, uint8_t fld, struct sen_agg *a)
+{
+  const struct sen55_log_block *blk;
+  const struct sen55_record *rec;
+  struct sen55_log_agg sum;
+  size_t i;
+  float x;
+
+  Summed = Scanned = 0;
+
+  if (sensor >= _Sensor.size() || fld >= SEN55_FLD_NUM) return(SEN55_ERR_PARAMETER);
+
+  const std::vector<const struct sen55_log_block *> &idx = _Sensor[sensor];
+
+  memset(&sum, 0x0, sizeof(sum));
+
+  for (i = first_block(idx, from_us); i < idx.size() && idx[i]->first_us <= to_us; i++) {
+
+    blk = idx[i];
+
+    // completely in the range : from the header
+    if (blk->first_us >= from_us && blk->last_us <= to_us) {
+      agg_add(&sum, blk->agg[fld].min, blk->agg[fld].max, blk->agg[fld].sum, blk->agg[fld].count);
+      Summed++;
+      continue;
+    }
+
+    // partly : read the records
+    rec = SEN55LogRecords(blk);
+
+    for (uint16_t r = 0; r < blk->count; r++, rec++) {
+
+      if (rec->time_us < from_us || rec->time_us > to_us) continue;
+
+      x = SEN55LogField(rec, fld);
+      if (! isnan(x)) agg_add(&sum, x, x, x, 1);
+    }
+
+    Scanned++;
+  }
+
+  a->count = sum.count;
+
+  if (sum.count == 0) a->min = a->max = a->mean = NAN;
+  else {
+    a->min = sum.min;
+    a->max = sum.max;
+    a->mean = sum.sum / sum.count;
+  }
+
+  return(SEN55_ERR_OK);
+}
@@ -0,0 +1,263 @@
+/**
+ * SEN55 binary sample log (Linux build)
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Append-only file of sen55_record (see sen55_shm.h), for the long term
+ * storage on a gateway. A CSV line is about 3 times larger and has to be
+ * parsed back, this file is read through mmap() and the records are used
+ * where they are : reading a month of samples is a walk through memory.
+ *
+ * file :
+ *   header (SEN55_LOG_HDR bytes) : magic, version, record size, sensor names
+ *   blocks (SEN55_LOG_BLOCK bytes each) : block header + SEN55_LOG_RECS records
+ *
+ * A block has the records of one sensor, in time order. The block header has
+ * the sensor, the number of records, the first and last time and a CRC32 of
+ * the records and their aggregates : a block that was not completely written
+ * (power loss) is detected and skipped, the rest of the file is still valid.
+ * The reader keeps an index of the valid blocks, a reader for one sensor does
+ * not touch the records of the other sensors.
+ *
+ * The block header also has the min / max / sum / count of each field. An
+ * aggregate over a time range (Query()) finds the first block of the range
+ * with a binary search in the index of the sensor, takes the blocks that are
+ * completely in the range from their header and only reads the records of the
+ * (at most 2) blocks at the ends of the range. A month of 1 second samples is
+ * about 10000 blocks per sensor, a query over all of it adds 10000 headers.
+ *
+ * The writer keeps the open block of each sensor in memory and writes it when
+ * it is full or at Flush(). A file that exists is continued.
+ *
+ *   SEN55LogWriter wr;                  SEN55LogReader rd;
+ *                                       struct sen55_log_pos pos;
+ *   wr.Open("sen55.log");               const struct sen55_record *rec;
+ *   id = wr.AddSensor("kitchen");
+ *   wr.Append(id, status, &val);        rd.Open("sen55.log");
+ *   ...                                 rd.Begin(&pos);
+ *   wr.Flush();                         while ((rec = rd.Next(&pos))) use(rec);
+ *
+ * The time of the samples of a sensor must not go back (e.g. CLOCK_REALTIME
+ * set back), else Query() can miss blocks.
+ *
+ * The records are stored as they are in memory : the file can only be read on
+ * a host with the same sizeof(sen55_record) and byte order (checked at Open()).
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SEN55_LOG_H
+#define SEN55_LOG_H
+
+#include "sen55_shm.h"
+#include "sen55_rollup.h"
+#include <vector>
+
+#define SEN55_LOG_MAGIC   0x4c353553    // "S55L"
+#define SEN55_LOG_BMAGIC  0x42353553    // "S55B"
+#define SEN55_LOG_VERSION 2
+#define SEN55_LOG_RECS    256           // records per block
+#define SEN55_LOG_HDR     12288         // bytes of the file header
+
+/**
+ * start of the file
+ */
+struct sen55_log_hdr {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t rec_size;                    // sizeof(sen55_record) of the writer
+  uint32_t block_recs;                  // SEN55_LOG_RECS of the writer
+  uint64_t created_us;                  // CLOCK_REALTIME in uS
+  uint32_t sensors;                     // entries in the name table
+  uint32_t reserved;
+  char names[SEN55_SHM_SENSORS][SEN55_SHM_NAME];
+};
+
+/**
+ * aggregate of a field in a block
+ */
+struct sen55_log_agg {
+  float min;
+  float max;
+  double sum;
+  uint32_t count;                       // samples with this field
+                                        // (0 : min / max not valid)
+  uint32_t reserved;
+};
+
+/**
+ * start of a block, followed by the records
+ */
+struct sen55_log_block {
+  uint32_t magic;                       // SEN55_LOG_BMAGIC
+  uint16_t sensor;                      // index in the name table
+  uint16_t count;                       // records in the block
+  uint64_t seq;                         // block number in the file
+  uint64_t first_us;                    // time of the oldest record
+  uint64_t last_us;                     // time of the newest record
+  uint32_t crc;                         // CRC32 of agg and the records
+  uint32_t reserved;
+  struct sen55_log_agg agg[SEN55_FLD_NUM];  // per field (SEN55_FLD_xxx)
+};
+
+#define SEN55_LOG_BLOCK (sizeof(struct sen55_log_block) + \
+                         SEN55_LOG_RECS * sizeof(struct sen55_record))
+
+/**
+ * @brief : records of a block
+ */
+inline struct sen55_record *SEN55LogRecords(const struct sen55_log_block *blk)
+{
+  return((struct sen55_record *) (blk + 1));
+}
+
+/**
+ * @brief : field of a record
+ * @param fld : SEN55_FLD_xxx
+ * @return : value, NaN if the field is not in the record
+ */
+float SEN55LogField(const struct sen55_record *rec, uint8_t fld);
+
+class SEN55LogWriter
+{
+  public:
+    SEN55LogWriter();
+    ~SEN55LogWriter();
+
+    /**
+     * @brief : create a log file or continue an existing one
+     * @return : false if the file could not be opened, or is not a log of
+     * this version / record size
+     */
+    bool Open(const char *path);
+
+    /**
+     * @brief : write the open blocks and close the file
+     */
+    void Close();
+
+    /**
+     * @brief : add a sensor to the name table
+     * @return : index to use in Append() (the same as before for a name that
+     * is already in the file), 0xffff if the table is full
+     */
+    uint16_t AddSensor(const char *name);
+
+    /**
+     * @brief : add a sample
+     * @param sensor  : index from AddSensor()
+     * @param status  : device status
+     * @param v       : values (or NULL)
+     * @param pm      : PM values (or NULL)
+     * @param time_us : CLOCK_REALTIME in uS (0 = now)
+     * @return : false if a full block could not be written
+     */
+    bool Append(uint16_t sensor, uint8_t status, struct sen_values *v,
+                struct sen_values_pm *pm = NULL, uint64_t time_us = 0);
+
+    /**
+     * @brief : write the open blocks that have records not written yet
+     * (the header is written by Open() and AddSensor())
+     * @param sync : also wait until the data is on the disk (fdatasync())
+     */
+    bool Flush(bool sync = false);
+
+    unsigned long Errors;               // failed writes
+
+  private:
+    bool WriteBlock(uint16_t sensor);
+    bool WriteHeader();
+    bool Resume();
+
+    int _Fd;
+    struct sen55_log_hdr _Hdr;
+    uint64_t _End;                      // offset of the next new block
+    uint64_t _Seq;                      // next block number
+    std::vector<struct sen55_log_block *> _Blk;  // open block per sensor
+    std::vector<uint64_t> _Off;         // offset of the open block
+    std::vector<bool> _Dirty;           // open block has unwritten records
+};
+
+/**
+ * position of a reader, see Begin() and Next()
+ */
+struct sen55_log_pos {
+  uint32_t block;                       // in the index
+  uint32_t rec;                         // in the block
+  int sensor;                           // only this sensor (-1 = all)
+};
+
+class SEN55LogReader
+{
+  public:
+    SEN55LogReader();
+    ~SEN55LogReader();
+
+    /**
+     * @brief : map a log file and build the index of the valid blocks
+     * @param verify : check the CRC of each block (false : only the block
+     * headers are read at Open(), the records when they are used)
+     * @return : false if the file is not a log of this version / record size
+     */
+    bool Open(const char *path, bool verify = true);
+    void Close();
+
+    /**
+     * @brief : number of valid blocks, and block i of them (file order)
+     */
+    uint32_t Blocks() {return(_Index.size());}
+    const struct sen55_log_block *Block(uint32_t i) {return(_Index[i]);}
+
+    /**
+     * @brief : start reading at the first record
+     * @param sensor : only the records of this sensor (-1 = all sensors)
+     */
+    void Begin(struct sen55_log_pos *pos, int sensor = -1);
+
+    /**
+     * @brief : get the next record (in the file, not copied)
+     * @return : NULL if there are no more records
+     * The records of a sensor are in time order, the blocks of more sensors
+     * overlap in time.
+     */
+    const struct sen55_record *Next(struct sen55_log_pos *pos);
+
+    /**
+     * @brief : name of a sensor, or the index of a name (-1 = not found)
+     */
+    const char *SensorName(uint16_t sensor);
+    int FindSensor(const char *name);
+
+    /**
+     * @brief : aggregate of a field of a sensor over a time range
+     * @param sensor  : index of the sensor
+     * @param from_us : start of the range (CLOCK_REALTIME in uS, included)
+     * @param to_us   : end of the range (included)
+     * @param fld     : SEN55_FLD_xxx
+     * @param a       : to store min / max / mean / count (count 0 : no samples)
+     * @return :
+     *  SEN55_ERR_OK
+     *  SEN55_ERR_PARAMETER : unknown sensor or field
+     */
+    uint8_t Query(uint16_t sensor, uint64_t from_us, uint64_t to_us,
+                  uint8_t fld, struct sen_agg *a);
+
+    unsigned long Records;              // records in the valid blocks
+    unsigned long Bad;                  // blocks skipped (CRC, size)
+    uint32_t Summed, Scanned;           // blocks of the last Query() :
+                                        // taken from the header / read
+
+  private:
+    uint8_t *_Map;
+    size_t _Size;
+    const struct sen55_log_hdr *_Hdr;
+    std::vector<const struct sen55_log_block *> _Index;
+    std::vector<std::vector<const struct sen55_log_block *> > _Sensor;  // index per sensor
+};
+
+#endif /* SEN55_LOG_H */
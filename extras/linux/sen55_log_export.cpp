@@ -0,0 +1,96 @@
+/**
+ * Export a binary SEN55 log of sen55d -l as columns
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Writes the samples of the log as one NumPy .npy file per field in a
+ * directory (see sen55_column.h) and, at the end, the number of rows and the
+ * time it took.
+ *
+ * usage : ./build/sen55_log_export [options] file dir
+ *   file     : log file
+ *   dir      : directory for the column files (created if needed)
+ *   -s name  : only the samples of this sensor
+ *   -b sec   : only the samples from this time (UNIX time)
+ *   -e sec   : only the samples up to this time (UNIX time)
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_column.h"
+#include <time.h>
+#include <unistd.h>
+
+static double now_ms()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+  SEN55LogReader rd;
+  SEN55ColumnWriter col;
+  struct sen55_log_pos pos;
+  const struct sen55_record *rec;
+  const char *name = NULL;
+  uint64_t from = 0, to = UINT64_MAX;
+  double start;
+  int opt, sensor = -1;
+
+  while ((opt = getopt(argc, argv, "s:b:e:")) != -1) {
+    switch(opt) {
+      case 's': name = optarg; break;
+      case 'b': from = strtoull(optarg, NULL, 10) * 1000000ULL; break;
+      case 'e': to = strtoull(optarg, NULL, 10) * 1000000ULL + 999999; break;
+      default:
+        fprintf(stderr, "usage : %s [-s sensor] [-b sec] [-e sec] file dir\n", argv[0]);
+        return(1);
+    }
+  }
+
+  if (optind + 2 > argc) {
+    fprintf(stderr, "no log file and directory given\n");
+    return(1);
+  }
+
+  start = now_ms();
+
+  if (! rd.Open(argv[optind])) {
+    fprintf(stderr, "can not open log %s (missing, or other version / record size)\n", argv[optind]);
+    return(1);
+  }
+
+  if (name && (sensor = rd.FindSensor(name)) < 0) {
+    fprintf(stderr, "sensor %s is not in the log\n", name);
+    return(1);
+  }
+
+  if (! col.Open(argv[optind + 1])) {
+    fprintf(stderr, "can not create the columns in %s : %s\n", argv[optind + 1], strerror(errno));
+    return(1);
+  }
+
+  rd.Begin(&pos, sensor);
+
+  while ((rec = rd.Next(&pos))) {
+    if (rec->time_us < from || rec->time_us > to) continue;
+    col.Append(rec, rd.SensorName(rec->sensor));
+  }
+
+  if (! col.Close()) {
+    fprintf(stderr, "error writing the columns in %s\n", argv[optind + 1]);
+    return(1);
+  }
+
+  fprintf(stderr, "%lu rows of %lu records, %d columns, %lu bad blocks, %.1f mS\n",
+    col.Rows, rd.Records, SEN55_COL_NUM, rd.Bad, now_ms() - start);
+
+  return(0);
+}
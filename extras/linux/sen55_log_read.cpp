@@ -0,0 +1,152 @@
+/**
+ * Read a binary SEN55 log of sen55d -l
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Writes the samples as CSV lines to stdout (same columns as sen55_shm_read)
+ * and, at the end, the number of records and blocks and the time it took.
+ * With -a the min / max / mean of a field of a sensor over a time range is
+ * written instead (see SEN55LogReader::Query()).
+ *
+ * usage : ./build/sen55_log_read [options] file
+ *   file     : log file
+ *   -s name  : only the samples of this sensor
+ *   -f       : do not check the CRC of the blocks (faster)
+ *   -q       : do not write the samples
+ *   -a field : aggregate of field (pm1 pm2 pm4 pm10 hum temp voc nox num0 num1
+ *              num2 num4 num10 size) of the sensor of -s
+ *   -b sec   : start of the aggregate range (UNIX time, default the oldest)
+ *   -e sec   : end of the aggregate range (UNIX time, default the newest)
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_log.h"
+#include <time.h>
+#include <unistd.h>
+
+static volatile float sink;
+
+static const char *fields[SEN55_FLD_NUM] = {"pm1", "pm2", "pm4", "pm10", "hum", "temp",
+  "voc", "nox", "num0", "num1", "num2", "num4", "num10", "size"};
+
+static double now_ms()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return(ts.tv_sec * 1e3 + ts.tv_nsec / 1e6);
+}
+
+/**
+ * @brief : write the aggregate of a field over a time range
+ */
+static int aggregate(SEN55LogReader *rd, int sensor, int fld, uint64_t from, uint64_t to, double start, double open_ms)
+{
+  struct sen_agg a;
+  double q = now_ms();
+
+  rd->Query(sensor, from, to, fld, &a);
+  q = now_ms() - q;
+
+  printf("%s %s : count %lu min %.3f max %.3f mean %.3f\n", rd->SensorName(sensor), fields[fld],
+    (unsigned long) a.count, a.min, a.max, a.mean);
+
+  fprintf(stderr, "%u blocks from the header, %u blocks read, query %.3f mS, open %.1f mS, total %.1f mS\n",
+    rd->Summed, rd->Scanned, q, open_ms, now_ms() - start);
+
+  return(0);
+}
+
+int main(int argc, char *argv[])
+{
+  SEN55LogReader rd;
+  struct sen55_log_pos pos;
+  const struct sen55_record *rec;
+  const char *name = NULL, *field = NULL;
+  unsigned long samples = 0;
+  uint64_t from = 0, to = UINT64_MAX;
+  bool verify = true, quiet = false;
+  double start, open_ms;
+  int opt, sensor = -1, fld;
+
+  while ((opt = getopt(argc, argv, "s:fqa:b:e:")) != -1) {
+    switch(opt) {
+      case 's': name = optarg; break;
+      case 'f': verify = false; break;
+      case 'q': quiet = true; break;
+      case 'a': field = optarg; break;
+      case 'b': from = strtoull(optarg, NULL, 10) * 1000000ULL; break;
+      case 'e': to = strtoull(optarg, NULL, 10) * 1000000ULL + 999999; break;
+      default:
+        fprintf(stderr, "usage : %s [-s sensor] [-f] [-q] [-a field [-b sec] [-e sec]] file\n", argv[0]);
+        return(1);
+    }
+  }
+
+  if (optind >= argc) {
+    fprintf(stderr, "no log file given\n");
+    return(1);
+  }
+
+  start = now_ms();
+
+  if (! rd.Open(argv[optind], verify)) {
+    fprintf(stderr, "can not open log %s (missing, or other version / record size)\n", argv[optind]);
+    return(1);
+  }
+
+  open_ms = now_ms() - start;
+
+  if (name && (sensor = rd.FindSensor(name)) < 0) {
+    fprintf(stderr, "sensor %s is not in the log\n", name);
+    return(1);
+  }
+
+  if (field) {
+    for (fld = 0; fld < SEN55_FLD_NUM; fld++) {
+      if (strcmp(field, fields[fld]) == 0) break;
+    }
+
+    if (sensor < 0 || fld == SEN55_FLD_NUM) {
+      fprintf(stderr, "-a needs a sensor (-s) and a field (pm1 ... size)\n");
+      return(1);
+    }
+
+    return(aggregate(&rd, sensor, fld, from, to, start, open_ms));
+  }
+
+  rd.Begin(&pos, sensor);
+
+  while ((rec = rd.Next(&pos))) {
+
+    samples++;
+
+    // touch the record, else -q would only measure the index
+    if (quiet) {
+      sink = rec->v.MassPM2;
+      continue;
+    }
+
+    printf("%s,%lu.%03lu,%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,%.1f,%.1f,%d",
+      rd.SensorName(rec->sensor), (unsigned long) (rec->time_us / 1000000ULL),
+      (unsigned long) (rec->time_us % 1000000ULL / 1000), rec->v.MassPM1, rec->v.MassPM2,
+      rec->v.MassPM4, rec->v.MassPM10, rec->v.Hum, rec->v.Temp, rec->v.VOC, rec->v.NOX, rec->status);
+
+    if (rec->flags & SEN55_REC_PM)
+      printf(",%.1f,%.1f,%.1f,%.1f,%.1f,%.3f", rec->pm.NumPM0, rec->pm.NumPM1,
+        rec->pm.NumPM2, rec->pm.NumPM4, rec->pm.NumPM10, rec->pm.PartSize);
+
+    printf("\n");
+  }
+
+  fflush(stdout);
+  fprintf(stderr, "samples read %lu of %lu, %u blocks, %lu bad blocks, open %.1f mS, total %.1f mS\n",
+    samples, rd.Records, rd.Blocks(), rd.Bad, open_ms, now_ms() - start);
+
+  return(0);
+}
@@ -0,0 +1,305 @@
+/**
+ * SEN55 samples in POSIX shared memory (Linux build)
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_shm.h"
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/**
+ * @brief : futex on the shared memory (not private, other processes)
+ */
+static void futex_wait(std::atomic<uint32_t> *addr, uint32_t val, uint32_t ms)
+{
+  struct timespec ts;
+
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000L;
+
+  syscall(SYS_futex, (uint32_t *) addr, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t> *addr)
+{
+  syscall(SYS_futex, (uint32_t *) addr, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+/////////////////////////// writer ///////////////////////////////
+
+SEN55ShmWriter::SEN55ShmWriter()
+{
+  _Shm = NULL;
+  _Size = 0;
+  _Name[0] = 0x0;
+}
+
+SEN55ShmWriter::~SEN55ShmWriter()
+{
+  Close();
+}
+
+bool SEN55ShmWriter::Create(const char *name, uint32_t slots)
+{
+  int fd;
+  void *p;
+
+  Close();
+
+  if (slots == 0) return(false);
+
+  _Size = sizeof(struct sen55_shm) + (size_t) slots * sizeof(struct sen55_slot);
+
+  // start fresh, readers of an old ring keep their copy
+  shm_unlink(name);
+
+  // readers need write access for the waiters count
+  fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0660);
+  if (fd < 0) return(false);
+
+  if (ftruncate(fd, _Size) < 0) {
+    close(fd);
+    shm_unlink(name);
+    return(false);
+  }
+
+  p = mmap(NULL, _Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (p == MAP_FAILED) {
+    shm_unlink(name);
+    return(false);
+  }
+
+  // new memory is zero : all slots are empty (ver 0)
+  _Shm = (struct sen55_shm *) p;
+  _Shm->version = SEN55_SHM_VERSION;
+  _Shm->slots = slots;
+  _Shm->rec_size = sizeof(struct sen55_record);
+
+  // magic last, a reader checks it first
+  std::atomic_thread_fence(std::memory_order_release);
+  _Shm->magic = SEN55_SHM_MAGIC;
+
+  strncpy(_Name, name, sizeof(_Name) - 1);
+  _Name[sizeof(_Name) - 1] = 0x0;
+  return(true);
+}
+
+void SEN55ShmWriter::Close()
+{
+  if (! _Shm) return;
+
+  munmap(_Shm, _Size);
+  shm_unlink(_Name);
+  _Shm = NULL;
+}
+
+uint16_t SEN55ShmWriter::AddSensor(const char *name)
+{
+  uint32_t i;
+
+  if (! _Shm) return(0xffff);
+
+  i = _Shm->sensors.load(std::memory_order_relaxed);
+  if (i >= SEN55_SHM_SENSORS) return(0xffff);
+
+  strncpy(_Shm->names[i], name, SEN55_SHM_NAME - 1);
+  _Shm->sensors.store(i + 1, std::memory_order_release);
+
+  return(i);
+}
+
+void SEN55ShmWriter::Write(uint16_t sensor, uint8_t status, struct sen_values *v, struct sen_values_pm *pm)
+{
+  struct sen55_slot *slot;
+  struct timespec ts;
+  uint64_t seq;
+
+  if (! _Shm) return;
+
+  seq = _Shm->head.load(std::memory_order_relaxed);
+  slot = SEN55ShmSlot(_Shm, seq);
+
+  // mark the slot as being written before the record changes
+  slot->ver.store(2 * seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  slot->rec.time_us = (uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+  slot->rec.sensor = sensor;
+  slot->rec.status = status;
+  slot->rec.flags = 0;
+
+  if (v) {
+    slot->rec.v = *v;
+    slot->rec.flags |= SEN55_REC_VALUES;
+  }
+  else memset(&slot->rec.v, 0x0, sizeof(slot->rec.v));
+
+  if (pm) {
+    slot->rec.pm = *pm;
+    slot->rec.flags |= SEN55_REC_PM;
+  }
+  else memset(&slot->rec.pm, 0x0, sizeof(slot->rec.pm));
+
+  slot->ver.store(2 * seq + 2, std::memory_order_release);
+  _Shm->head.store(seq + 1, std::memory_order_release);
+
+  // wake the readers that wait (seq_cst pairs with Wait())
+  _Shm->seq32.store((uint32_t) (seq + 1));
+  if (_Shm->waiters.load() > 0) futex_wake(&_Shm->seq32);
+}
+
+/////////////////////////// reader ///////////////////////////////
+
+SEN55ShmReader::SEN55ShmReader()
+{
+  _Shm = NULL;
+  _Size = 0;
+  _Cursor = 0;
+  Lost = 0;
+}
+
+SEN55ShmReader::~SEN55ShmReader()
+{
+  Close();
+}
+
+bool SEN55ShmReader::Open(const char *name, bool oldest)
+{
+  struct sen55_shm hdr;
+  struct stat st;
+  uint64_t head;
+  int fd;
+  void *p;
+
+  Close();
+
+  fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0) return(false);
+
+  if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(hdr)) {
+    close(fd);
+    return(false);
+  }
+
+  p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (p == MAP_FAILED) return(false);
+
+  _Shm = (struct sen55_shm *) p;
+  _Size = st.st_size;
+
+  if (_Shm->magic != SEN55_SHM_MAGIC || _Shm->version != SEN55_SHM_VERSION ||
+      _Shm->rec_size != sizeof(struct sen55_record) ||
+      _Size < sizeof(struct sen55_shm) + (size_t) _Shm->slots * sizeof(struct sen55_slot)) {
+    Close();
+    return(false);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  head = _Shm->head.load(std::memory_order_acquire);
+
+  if (! oldest) _Cursor = head;
+  else _Cursor = head > _Shm->slots ? head - _Shm->slots + 1 : 0;
+
+  Lost = 0;
+  return(true);
+}
+
+void SEN55ShmReader::Close()
+{
+  if (! _Shm) return;
+
+  munmap(_Shm, _Size);
+  _Shm = NULL;
+}
+
+bool SEN55ShmReader::Read(struct sen55_record *rec)
+{
+  struct sen55_slot *slot;
+  uint64_t head, v1, v2, resync;
+
+  if (! _Shm) return(false);
+
+  while (1) {
+
+    head = _Shm->head.load(std::memory_order_acquire);
+
+    if (_Cursor >= head) return(false);
+
+    // overtaken by the writer : continue with the oldest record
+    // (the slot of head - slots is the next to be written)
+    resync = head > _Shm->slots ? head - _Shm->slots + 1 : 0;
+    if (_Cursor < resync) {
+      Lost += resync - _Cursor;
+      _Cursor = resync;
+    }
+
+    slot = SEN55ShmSlot(_Shm, _Cursor);
+
+    v1 = slot->ver.load(std::memory_order_acquire);
+
+    // not complete yet
+    if (v1 < 2 * _Cursor + 2) return(false);
+
+    if (v1 == 2 * _Cursor + 2) {
+
+      memcpy(rec, &slot->rec, sizeof(struct sen55_record));
+
+      // did the writer change the slot during the copy ?
+      std::atomic_thread_fence(std::memory_order_acquire);
+      v2 = slot->ver.load(std::memory_order_relaxed);
+
+      if (v2 == v1) {
+        _Cursor++;
+        return(true);
+      }
+    }
+
+    // slot is reused, read head again to resync
+    Lost++;
+    _Cursor++;
+  }
+}
+
+bool SEN55ShmReader::Wait(uint32_t ms)
+{
+  uint32_t seq;
+
+  if (! _Shm) return(false);
+
+  if (_Cursor < _Shm->head.load(std::memory_order_acquire)) return(true);
+
+  // seq_cst pairs with Write()
+  _Shm->waiters.fetch_add(1);
+  seq = _Shm->seq32.load();
+
+  if (seq == (uint32_t) _Cursor) futex_wait(&_Shm->seq32, seq, ms);
+
+  _Shm->waiters.fetch_sub(1);
+
+  return(_Cursor < _Shm->head.load(std::memory_order_acquire));
+}
+
+const char *SEN55ShmReader::SensorName(uint16_t sensor)
+{
+  if (! _Shm || sensor >= _Shm->sensors.load(std::memory_order_acquire)) return("?");
+
+  return(_Shm->names[sensor]);
+}
@@ -0,0 +1,183 @@
+/**
+ * SEN55 samples in POSIX shared memory (Linux build)
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * One process (e.g. sen55d -m) reads the sensors and writes each sample in a
+ * ring of records in shared memory. Any number of local processes can read
+ * the ring, each with its own cursor, without locks and without a system call
+ * per sample. Only the writer touches the I2C bus.
+ *
+ * The writer never waits for a reader : when the ring is full the oldest
+ * record is overwritten. Each record has its own sequence number, a reader
+ * that was overtaken detects it, skips to the oldest record still in the ring
+ * and counts the records it lost. A reader only writes the count of waiting
+ * readers, it needs read/write access (the ring is created with mode 0660).
+ *
+ *   SEN55ShmReader rd;
+ *   struct sen55_record rec;
+ *
+ *   rd.Open("/sen55");
+ *   while (1) {
+ *     while (rd.Read(&rec)) printf("%s %f\n", rd.SensorName(rec.sensor), rec.v.MassPM2);
+ *     rd.Wait(1000);
+ *   }
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SEN55_SHM_H
+#define SEN55_SHM_H
+
+#include "sen55.h"
+#include <atomic>
+
+#if ATOMIC_LLONG_LOCK_FREE != 2
+#error "sen55_shm.h needs lock-free 64 bit atomics"
+#endif
+
+#define SEN55_SHM_MAGIC   0x53353553    // "S55S"
+#define SEN55_SHM_VERSION 1
+#define SEN55_SHM_SLOTS   1024          // default number of records in the ring
+#define SEN55_SHM_SENSORS 256           // max sensors in the name table
+#define SEN55_SHM_NAME    32            // max length of a sensor name (incl. 0x0)
+
+/** record flags */
+#define SEN55_REC_VALUES  0x01          // v is valid
+#define SEN55_REC_PM      0x02          // pm is valid
+
+/**
+ * one sample
+ */
+struct sen55_record {
+  uint64_t time_us;                     // CLOCK_REALTIME in uS
+  uint16_t sensor;                      // index in the name table
+  uint8_t status;                       // last device status (as GetStatusReg())
+  uint8_t flags;                        // SEN55_REC_xxx
+  struct sen_values v;
+  struct sen_values_pm pm;
+};
+
+/**
+ * slot in the ring
+ * ver = 2 * seq + 1 : record seq is being written
+ * ver = 2 * seq + 2 : record seq is complete
+ */
+struct sen55_slot {
+  std::atomic<uint64_t> ver;
+  struct sen55_record rec;
+};
+
+/**
+ * start of the shared memory, followed by the slots
+ */
+struct sen55_shm {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slots;
+  uint32_t rec_size;                    // sizeof(sen55_record) of the writer
+  std::atomic<uint64_t> head;           // records written
+  std::atomic<uint32_t> seq32;          // low 32 bits of head (futex)
+  std::atomic<uint32_t> waiters;        // readers in Wait()
+  std::atomic<uint32_t> sensors;        // entries in the name table
+  char names[SEN55_SHM_SENSORS][SEN55_SHM_NAME];
+  // followed by the slots
+};
+
+/**
+ * @brief : slot i in the shared memory
+ */
+inline struct sen55_slot *SEN55ShmSlot(struct sen55_shm *shm, uint64_t i)
+{
+  return((struct sen55_slot *) (shm + 1) + i % shm->slots);
+}
+
+class SEN55ShmWriter
+{
+  public:
+    SEN55ShmWriter();
+    ~SEN55ShmWriter();
+
+    /**
+     * @brief : create the shared memory
+     * @param name  : name of the shared memory (e.g. "/sen55")
+     * @param slots : number of records in the ring
+     * @return : true if created
+     */
+    bool Create(const char *name, uint32_t slots = SEN55_SHM_SLOTS);
+
+    /**
+     * @brief : remove the shared memory (readers that have it open keep it)
+     */
+    void Close();
+
+    /**
+     * @brief : add a sensor to the name table
+     * @return : index to use in Write(), 0xffff if the table is full
+     */
+    uint16_t AddSensor(const char *name);
+
+    /**
+     * @brief : add a sample to the ring
+     * @param sensor : index from AddSensor()
+     * @param status : device status
+     * @param v      : values (or NULL)
+     * @param pm     : PM values (or NULL)
+     */
+    void Write(uint16_t sensor, uint8_t status, struct sen_values *v, struct sen_values_pm *pm = NULL);
+
+  private:
+    struct sen55_shm *_Shm;
+    size_t _Size;
+    char _Name[64];
+};
+
+class SEN55ShmReader
+{
+  public:
+    SEN55ShmReader();
+    ~SEN55ShmReader();
+
+    /**
+     * @brief : open the shared memory
+     * @param name   : name of the shared memory (e.g. "/sen55")
+     * @param oldest : true : start with the oldest record in the ring
+     *                 false : start with the next new record
+     * @return : true if opened
+     */
+    bool Open(const char *name, bool oldest = false);
+    void Close();
+
+    /**
+     * @brief : get the next record
+     * @param rec : to hold the record
+     * @return : true if a record was copied, false if no new record
+     */
+    bool Read(struct sen55_record *rec);
+
+    /**
+     * @brief : wait for a new record
+     * @param ms : max mS to wait
+     * @return : true if a new record is available
+     */
+    bool Wait(uint32_t ms);
+
+    /**
+     * @brief : name of a sensor in the name table
+     */
+    const char *SensorName(uint16_t sensor);
+
+    unsigned long Lost;                 // records overwritten before they were read
+
+  private:
+    struct sen55_shm *_Shm;
+    size_t _Size;
+    uint64_t _Cursor;                   // next record to read
+};
+
+#endif /* SEN55_SHM_H */
@@ -0,0 +1,95 @@
+/**
+ * Read the SEN55 samples from the shared memory ring of sen55d -m
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Writes the samples as CSV lines to stdout (same columns as sen55d) and, at
+ * the end, the number of samples read and lost (overwritten before this reader
+ * got to them).
+ *
+ * usage : ./build/sen55_shm_read [options] name
+ *   name     : shared memory (e.g. /sen55)
+ *   -o       : start with the oldest sample in the ring
+ *   -n cnt   : stop after cnt samples (default 0 = run until stopped)
+ *   -q       : do not write the samples
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_shm.h"
+#include <signal.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig)
+{
+  (void) sig;
+  stop = 1;
+}
+
+int main(int argc, char *argv[])
+{
+  SEN55ShmReader rd;
+  struct sen55_record rec;
+  unsigned long cnt = 0, samples = 0;
+  bool oldest = false, quiet = false;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "on:q")) != -1) {
+    switch(opt) {
+      case 'o': oldest = true; break;
+      case 'n': cnt = strtoul(optarg, NULL, 10); break;
+      case 'q': quiet = true; break;
+      default:
+        fprintf(stderr, "usage : %s [-o] [-n cnt] [-q] name\n", argv[0]);
+        return(1);
+    }
+  }
+
+  if (optind >= argc) {
+    fprintf(stderr, "no shared memory name given (e.g. /sen55)\n");
+    return(1);
+  }
+
+  if (! rd.Open(argv[optind], oldest)) {
+    fprintf(stderr, "can not open shared memory %s\n", argv[optind]);
+    return(1);
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  while (! stop && (cnt == 0 || samples < cnt)) {
+
+    if (! rd.Read(&rec)) {
+      rd.Wait(1000);
+      continue;
+    }
+
+    samples++;
+
+    if (quiet) continue;
+
+    printf("%s,%lu.%03lu,%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,%.1f,%.1f,%d",
+      rd.SensorName(rec.sensor), (unsigned long) (rec.time_us / 1000000ULL),
+      (unsigned long) (rec.time_us % 1000000ULL / 1000), rec.v.MassPM1, rec.v.MassPM2,
+      rec.v.MassPM4, rec.v.MassPM10, rec.v.Hum, rec.v.Temp, rec.v.VOC, rec.v.NOX, rec.status);
+
+    if (rec.flags & SEN55_REC_PM)
+      printf(",%.1f,%.1f,%.1f,%.1f,%.1f,%.3f", rec.pm.NumPM0, rec.pm.NumPM1,
+        rec.pm.NumPM2, rec.pm.NumPM4, rec.pm.NumPM10, rec.pm.PartSize);
+
+    printf("\n");
+  }
+
+  fflush(stdout);
+  fprintf(stderr, "samples read %lu, lost %lu\n", samples, rd.Lost);
+
+  return(0);
+}
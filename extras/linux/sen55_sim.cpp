@@ -0,0 +1,502 @@
+/**
+ * SEN55 simulated device for host builds
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55_sim.h"
+
+#define SIM_CLEAN_TIME 10000            // fan cleaning takes 10 seconds
+
+/**
+ * @brief : constructor
+ * @param seed : seed for the generators and error injection
+ */
+SEN55Sim::SEN55Sim(uint32_t seed)
+{
+  _Id = seed;
+  _Seed = seed ? seed : 1;
+  _Addr = 0;
+  _TxLen = _RxLen = _RxPos = 0;
+  _Cmd = 0;
+  _CmdOk = false;
+  _CmdTime = 0;
+  _Clock = NULL;
+  _Strict = false;
+  _Generator = true;
+  _NackRate = _CrcRate = _ShortRate = 0;
+  Commands = Injected = 0;
+
+  // PM1 3.2, PM2.5 5.1, PM4 6.0, PM10 6.4, 45.5 %RH, 21.5 C, VOC 100, NOx 1
+  const uint16_t v[8] = {32, 51, 60, 64, 4550, 4300, 1000, 10};
+  memcpy(Values, v, sizeof(Values));
+
+  const uint16_t pm[10] = {32, 51, 60, 64, 215, 251, 254, 255, 255, 520};
+  memcpy(ValuesPM, pm, sizeof(ValuesPM));
+
+  _PM25 = 2.0 + (Random() % 80) / 10.0;
+  _Spike = 0;
+  _Voc = 100;
+  _Nox = 1;
+
+  Defaults();
+}
+
+/**
+ * @brief : power-on / reset state of the SEN55
+ */
+void SEN55Sim::Defaults()
+{
+  const uint16_t voc[6] = {100, 12, 12, 180, 50, 230};
+  const uint16_t nox[6] = {1, 12, 12, 720, 50, 230};
+
+  _State = SIM_IDLE;
+  _DataReady = false;
+  _Cleaning = false;
+  _MeasStart = _LastTick = _CleanStart = 0;
+
+  _AutoClean = 604800;
+  memset(_TempComp, 0x0, sizeof(_TempComp));
+  _WarmStart = 0;
+  memcpy(_VocTuning, voc, sizeof(_VocTuning));
+  memcpy(_NoxTuning, nox, sizeof(_NoxTuning));
+  _RhtAccel = 0;
+  memset(_VocState, 0x0, sizeof(_VocState));
+  _Status = 0;
+}
+
+/**
+ * @brief : set error injection rates (0.0 - 1.0)
+ */
+void SEN55Sim::SetErrorRate(float nack, float crc, float shortread)
+{
+  _NackRate = (uint32_t) (nack * 4294967295.0);
+  _CrcRate = (uint32_t) (crc * 4294967295.0);
+  _ShortRate = (uint32_t) (shortread * 4294967295.0);
+}
+
+bool SEN55Sim::FanCleaning()
+{
+  Update();
+  return(_Cleaning);
+}
+
+/************************************************************
+ * TwoWire
+ *************************************************************/
+
+void SEN55Sim::beginTransmission(uint8_t addr)
+{
+  _Addr = addr;
+  _TxLen = 0;
+}
+
+size_t SEN55Sim::write(uint8_t c)
+{
+  if (_TxLen >= MAXBUFLENGTH) return(0);
+  _Tx[_TxLen++] = c;
+  return(1);
+}
+
+/**
+ * @brief : command (and data) received
+ *
+ * return : 0 = ok, 2 = NACK on address, 3 = NACK on data
+ */
+uint8_t SEN55Sim::endTransmission(bool stop)
+{
+  uint16_t data[MAXBUFLENGTH / 3];
+  uint8_t i, n = 0;
+
+  (void) stop;
+
+  if (_Addr != SEN55_ADDRESS) return(2);
+
+  _CmdOk = false;
+  if (_TxLen < 2) return(3);
+
+  Commands++;
+  _Cmd = _Tx[0] << 8 | _Tx[1];
+  _CmdTime = Now();
+
+  if (Chance(_NackRate)) {
+    Injected++;
+    return(3);
+  }
+
+  // data words : 2 bytes + CRC
+  if ((_TxLen - 2) % 3 != 0) return(3);
+
+  for (i = 2; i < _TxLen; i += 3) {
+    if (CRC(&_Tx[i]) != _Tx[i + 2]) return(3);
+    data[n++] = _Tx[i] << 8 | _Tx[i + 1];
+  }
+
+  Update();
+
+  _CmdOk = Execute(_Cmd, data, n);
+
+  return(_CmdOk ? 0 : 3);
+}
+
+/**
+ * @brief : answer the last command
+ *
+ * return : number of bytes available (0 = NACK)
+ */
+uint8_t SEN55Sim::requestFrom(uint8_t addr, uint8_t cnt, uint8_t stop)
+{
+  // firmware 2.0, hardware 4.0, protocol 1.0
+  const uint16_t version[4] = {0x0200, 0x0004, 0x0001, 0x0000};
+  uint16_t w[10];
+  uint8_t i;
+  char ser[SEN55_ID_LENGTH + 1];
+
+  (void) stop;
+  _RxLen = _RxPos = 0;
+
+  if (addr != SEN55_ADDRESS || ! _CmdOk) return(0);
+
+  if (_Strict && Now() - _CmdTime < ExecTime(_Cmd)) return(0);
+
+  Update();
+
+  switch(_Cmd) {
+    case SEN55_READ_DATA_RDY_FLAG:
+      w[0] = _DataReady;                // padding byte + flag
+      Respond(w, 1);
+      break;
+
+    case SEN55_READ_MEASURED_VALUE:
+      memcpy(w, Values, sizeof(Values));
+      if (_State == SIM_MEASURE_RHTG) for (i = 0; i < 4; i++) w[i] = 0xffff;
+      Respond(w, 8);
+      _DataReady = false;
+      break;
+
+    case SEN55_READ_MEASURED_VALUE_PM:
+      memcpy(w, ValuesPM, sizeof(ValuesPM));
+      if (_State == SIM_MEASURE_RHTG) for (i = 0; i < 10; i++) w[i] = 0xffff;
+      Respond(w, 10);
+      _DataReady = false;
+      break;
+
+    case SEN55_TEMP_COMP:              Respond(_TempComp, 3); break;
+    case SEN55_WARM_START_PARAM:       Respond(&_WarmStart, 1); break;
+    case SEN55_VOC_TUNING:             Respond(_VocTuning, 6); break;
+    case SEN55_NOX_TUNING:             Respond(_NoxTuning, 6); break;
+    case SEN55_RHT_ACCEL:              Respond(&_RhtAccel, 1); break;
+    case SEN55_VOC_ALGO:               Respond(_VocState, 4); break;
+
+    case SEN55_AUTO_CLEANING_INTERVAL:
+      w[0] = _AutoClean >> 16;
+      w[1] = _AutoClean & 0xffff;
+      Respond(w, 2);
+      break;
+
+    case SEN55_READ_PRODUCT_NAME:      Respond_Str("SEN55"); break;
+
+    case SEN55_READ_SERIAL_NUMBER:
+      snprintf(ser, sizeof(ser), "SIM55%011lX", (unsigned long) _Id);
+      Respond_Str(ser);
+      break;
+
+    case SEN55_READ_VERSION:           Respond(version, 4); break;
+
+    case SEN55_READ_DEVICE_REGISTER:
+      w[0] = (_Status | (_Cleaning ? SIM_STATUS_CLEAN : 0)) >> 16;
+      w[1] = _Status & 0xffff;
+      Respond(w, 2);
+      break;
+
+    default:                            // command without data to read
+      return(0);
+  }
+
+  if (_RxLen > 3 && Chance(_CrcRate)) {
+    Injected++;
+    _Rx[(Random() % (_RxLen / 3)) * 3 + 2] ^= 0x5a;
+  }
+
+  if (_RxLen > 3 && Chance(_ShortRate)) {
+    Injected++;
+    _RxLen = 1 + Random() % (_RxLen - 1);
+  }
+
+  if (_RxLen > cnt) _RxLen = cnt;
+
+  return(_RxLen);
+}
+
+/************************************************************
+ * state machine
+ *************************************************************/
+
+/**
+ * @brief : execute a command
+ * @param cmd  : SEN55 command
+ * @param data : data words received with the command
+ * @param n    : number of data words (0 = read request)
+ *
+ * return : true if accepted in the current state
+ */
+bool SEN55Sim::Execute(uint16_t cmd, const uint16_t *data, uint8_t n)
+{
+  bool idle = (_State == SIM_IDLE);
+
+  switch(cmd) {
+    case SEN55_START_MEASUREMENT:
+    case SEN55_START_RHTG_MEASUREMENT:
+      if (! idle || n) return(false);
+      _State = (cmd == SEN55_START_MEASUREMENT) ? SIM_MEASURE : SIM_MEASURE_RHTG;
+      _MeasStart = Now();
+      _LastTick = 0;
+      _DataReady = false;
+      return(true);
+
+    case SEN55_STOP_MEASUREMENT:
+      if (idle || n) return(false);
+      _State = SIM_IDLE;
+      _Cleaning = false;
+      return(true);
+
+    case SEN55_READ_MEASURED_VALUE:
+    case SEN55_READ_MEASURED_VALUE_PM:
+      return(! idle && n == 0);
+
+    case SEN55_START_FAN_CLEANING:
+      if (_State != SIM_MEASURE || n) return(false);
+      _Cleaning = true;
+      _CleanStart = Now();
+      return(true);
+
+    case SEN55_TEMP_COMP:               // any state
+      if (n == 3) memcpy(_TempComp, data, sizeof(_TempComp));
+      return(n == 0 || n == 3);
+
+    case SEN55_WARM_START_PARAM:        // any state
+      if (n == 1) _WarmStart = data[0];
+      return(n <= 1);
+
+    case SEN55_VOC_TUNING:
+    case SEN55_NOX_TUNING:
+      if (n == 0) return(true);
+      if (! idle || n != 6) return(false);
+      memcpy(cmd == SEN55_VOC_TUNING ? _VocTuning : _NoxTuning, data, 6 * sizeof(uint16_t));
+      return(true);
+
+    case SEN55_RHT_ACCEL:
+      if (n == 0) return(true);
+      if (! idle || n != 1) return(false);
+      _RhtAccel = data[0];
+      return(true);
+
+    case SEN55_VOC_ALGO:
+      if (n == 0) return(true);
+      if (! idle || n != 4) return(false);
+      memcpy(_VocState, data, sizeof(_VocState));
+      return(true);
+
+    case SEN55_AUTO_CLEANING_INTERVAL:
+      if (n == 0) return(true);
+      if (! idle || n != 2) return(false);
+      _AutoClean = (uint32_t) data[0] << 16 | data[1];
+      return(true);
+
+    case SEN55_READ_DATA_RDY_FLAG:
+    case SEN55_READ_PRODUCT_NAME:
+    case SEN55_READ_SERIAL_NUMBER:
+    case SEN55_READ_VERSION:
+    case SEN55_READ_DEVICE_REGISTER:
+      return(n == 0);
+
+    case SEN55_CLEAR_DEVICE_REGISTER:
+      _Status = 0;
+      return(n == 0);
+
+    case SEN55_RESET:
+      Defaults();
+      return(n == 0);
+
+    default:
+      return(false);
+  }
+}
+
+/**
+ * @brief : execution time of a command according to the datasheet
+ *
+ * return : milliseconds
+ */
+uint16_t SEN55Sim::ExecTime(uint16_t cmd)
+{
+  switch(cmd) {
+    case SEN55_START_MEASUREMENT:
+    case SEN55_START_RHTG_MEASUREMENT: return(50);
+    case SEN55_STOP_MEASUREMENT:       return(200);
+    case SEN55_RESET:                  return(100);
+    default:                           return(20);
+  }
+}
+
+/**
+ * @brief : update state to the current time
+ */
+void SEN55Sim::Update()
+{
+  unsigned long now = Now(), sec;
+
+  if (_Cleaning && now - _CleanStart >= SIM_CLEAN_TIME) _Cleaning = false;
+
+  if (_State == SIM_IDLE) return;
+
+  // new measurement every second
+  sec = (now - _MeasStart) / 1000;
+
+  if (sec > _LastTick) {
+    if (_Generator) Generate(sec - _LastTick);
+    _LastTick = sec;
+    _DataReady = true;
+  }
+}
+
+/************************************************************
+ * data generators
+ *************************************************************/
+
+/**
+ * @brief : generate new measurement values
+ * @param steps : number of seconds since the last values
+ *
+ * RH/T follow a daily cycle, PM2.5 is a mean reverting random walk with
+ * sporadic events (e.g. cooking) that decay, VOC and NOx stay around their
+ * baseline index (100 and 1) with sporadic events.
+ */
+void SEN55Sim::Generate(unsigned long steps)
+{
+  float day, temp, hum, pm1, pm25, pm4, pm10, decay, s;
+  float phase = (_Id % 1000) * 0.006283f;
+
+  if (steps > 3600) steps = 3600;
+  s = sqrtf((float) steps);
+
+  day = sinf(Now() / 1000.0f * 7.2722e-5f + phase);   // 2 * PI / 86400
+  temp = 21.5f + 2.0f * day + Noise(0.05f);
+  hum = 45.0f - 8.0f * day + Noise(0.2f);
+
+  // PM2.5 reverts to its baseline of 5
+  _PM25 += (5.0f - _PM25) * 0.002f * steps + Noise(0.3f) * s;
+  if (_PM25 < 0.5f) _PM25 = 0.5f;
+
+  decay = powf(0.995f, (float) steps);
+  _Spike *= decay;
+  if (Random() < 596523U * steps) _Spike += 20 + Random() % 100;     // about 1 per 2 hours
+
+  pm25 = _PM25 + _Spike;
+  pm1 = pm25 * 0.7f;
+  pm4 = pm25 * 1.1f;
+  pm10 = pm25 * 1.25f;
+
+  _Voc += (100.0f - _Voc) * 0.01f * steps + Noise(1.0f) * s;
+  if (Random() < 1193046U * steps) _Voc += 150;                       // about 1 per hour
+  if (_Voc < 1) _Voc = 1;
+  if (_Voc > 500) _Voc = 500;
+
+  _Nox += (1.0f - _Nox) * 0.01f * steps;
+  if (Random() < 596523U * steps) _Nox += 20 + Random() % 50;         // about 1 per 2 hours
+  if (_Nox < 1) _Nox = 1;
+  if (_Nox > 500) _Nox = 500;
+
+  Values[0] = (uint16_t) (pm1 * 10);
+  Values[1] = (uint16_t) (pm25 * 10);
+  Values[2] = (uint16_t) (pm4 * 10);
+  Values[3] = (uint16_t) (pm10 * 10);
+  Values[4] = (uint16_t) (int16_t) (hum * 100);
+  Values[5] = (uint16_t) (int16_t) (temp * 200);
+  Values[6] = (uint16_t) (int16_t) (_Voc * 10);
+  Values[7] = (uint16_t) (int16_t) (_Nox * 10);
+
+  memcpy(ValuesPM, Values, 4 * sizeof(uint16_t));
+  ValuesPM[4] = (uint16_t) (pm1 * 65);                  // number PM0.5
+  ValuesPM[5] = (uint16_t) (pm1 * 75);                  // number PM1.0
+  ValuesPM[6] = ValuesPM[5] + (uint16_t) ((pm25 - pm1) * 2);
+  ValuesPM[7] = ValuesPM[6] + (uint16_t) ((pm4 - pm25) * 0.5f);
+  ValuesPM[8] = ValuesPM[7] + (uint16_t) ((pm10 - pm4) * 0.1f);
+  ValuesPM[9] = (uint16_t) ((0.45f + Noise(0.05f) + _Spike / 1000) * 1000);
+}
+
+/**
+ * @brief : xorshift32 random generator
+ */
+uint32_t SEN55Sim::Random()
+{
+  _Seed ^= _Seed << 13;
+  _Seed ^= _Seed >> 17;
+  _Seed ^= _Seed << 5;
+  return(_Seed);
+}
+
+/**
+ * @brief : uniform noise between -range and +range
+ */
+float SEN55Sim::Noise(float range)
+{
+  return(((Random() >> 8) / 8388608.0f - 1.0f) * range);
+}
+
+/************************************************************
+ * response
+ *************************************************************/
+
+/**
+ * @brief : store words with CRC in the receive buffer
+ */
+void SEN55Sim::Respond(const uint16_t *words, uint8_t n)
+{
+  for (uint8_t i = 0; i < n && _RxLen + 3 <= MAXBUFLENGTH; i++) {
+    _Rx[_RxLen] = words[i] >> 8;
+    _Rx[_RxLen + 1] = words[i] & 0xff;
+    _Rx[_RxLen + 2] = CRC(&_Rx[_RxLen]);
+    _RxLen += 3;
+  }
+}
+
+/**
+ * @brief : store string, zero padded to 32 characters, with CRC in the receive buffer
+ */
+void SEN55Sim::Respond_Str(const char *str)
+{
+  uint16_t w;
+  size_t len = strlen(str), i;
+
+  for (i = 0; i < SEN55_ID_LENGTH; i += 2) {
+    w = (i < len ? (uint8_t) str[i] : 0) << 8;
+    if (i + 1 < len) w |= (uint8_t) str[i + 1];
+    Respond(&w, 1);
+  }
+}
+
+/**
+ * @brief : CRC as in the SEN55 datasheet
+ */
+uint8_t SEN55Sim::CRC(const uint8_t *data)
+{
+  uint8_t crc = 0xFF;
+
+  for(int i = 0; i < 2; i++) {
+    crc ^= data[i];
+    for(uint8_t bit = 8; bit > 0; --bit) {
+      if(crc & 0x80) crc = (crc << 1) ^ 0x31u;
+      else crc = (crc << 1);
+    }
+  }
+
+  return(crc);
+}
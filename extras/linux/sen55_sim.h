@@ -0,0 +1,177 @@
+/**
+ * SEN55 simulated device for host builds
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Plugs in where the SEN55 library expects a TwoWire (see Wire.h in this
+ * folder). Each SEN55Sim is a complete behavioural model of one SEN55, so
+ * hundreds of virtual sensors can run in one process :
+ *
+ *  - state machine : idle, measurement, RHT/gas-only measurement, fan cleaning
+ *  - register file for every SEN55_* command, reset to defaults on SEN55_RESET
+ *  - CRC generation on read and CRC check on written data
+ *  - datasheet execution times (optional, see SetStrictTiming())
+ *  - new data every second, data ready flag
+ *  - error injection : NACK, CRC errors, short reads and device status errors
+ *  - data generators for PM, RH/T, VOC and NOx
+ *
+ * The time is taken from millis(), with ShimRealDelay(false) the simulation
+ * runs in virtual time. Another clock can be set with SetClock(), e.g. to
+ * follow a library that uses SEN55_WAIT_VIRTUAL.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SEN55_SIM_H
+#define SEN55_SIM_H
+
+#include "Wire.h"
+#include "sen55.h"
+
+/**
+ * device state
+ */
+enum SEN55Sim_state {
+  SIM_IDLE = 0,
+  SIM_MEASURE,                          // PM, RH/T, VOC and NOx
+  SIM_MEASURE_RHTG                      // RH/T, VOC and NOx only (no laser)
+};
+
+/**
+ * device status register bits (as read with SEN55_READ_DEVICE_REGISTER)
+ */
+#define SIM_STATUS_SPEED   (1UL << 21)  // fan speed warning
+#define SIM_STATUS_CLEAN   (1UL << 19)  // fan cleaning active
+#define SIM_STATUS_GAS     (1UL << 7)   // gas sensor error
+#define SIM_STATUS_RHT     (1UL << 6)   // RH/T communication error
+#define SIM_STATUS_LASER   (1UL << 5)   // laser failure
+#define SIM_STATUS_FAN     (1UL << 4)   // fan failure
+
+class SEN55Sim : public TwoWire
+{
+  public:
+    /**
+     * @param seed : seed for the data generators and error injection,
+     *               use a different seed for each virtual sensor
+     */
+    SEN55Sim(uint32_t seed = 1);
+
+    /** TwoWire */
+    void beginTransmission(uint8_t addr);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t addr, uint8_t cnt, uint8_t stop = 1);
+    using Print::write;
+    size_t write(uint8_t c);
+    int available() {return(_RxLen - _RxPos);}
+    int read() {return(_RxPos < _RxLen ? _Rx[_RxPos++] : -1);}
+
+    /**
+     * @brief : enable the data generators (default) or use fixed values
+     *
+     * When disabled the values in Values[] and ValuesPM[] are returned as set.
+     */
+    void SetGenerator(bool act) {_Generator = act;}
+
+    /**
+     * @brief : enforce the datasheet execution time of each command
+     *
+     * A read before the execution time has passed is not acknowledged.
+     * Default off, as the SEN55 answers much faster than the datasheet states
+     * (the library waits 5mS).
+     */
+    void SetStrictTiming(bool act) {_Strict = act;}
+
+    /**
+     * @brief : set error injection rates (0.0 - 1.0)
+     *
+     * @param nack  : chance a command is not acknowledged
+     * @param crc   : chance a read has a wrong CRC
+     * @param shortread : chance a read returns less bytes
+     */
+    void SetErrorRate(float nack, float crc, float shortread);
+
+    /**
+     * @brief : set or clear device status bits (SIM_STATUS_xxx)
+     * Set bits remain until cleared with SEN55_CLEAR_DEVICE_REGISTER
+     */
+    void InjectStatus(uint32_t bits) {_Status |= bits;}
+
+    /**
+     * @brief : set the clock of the simulation
+     * @param fn : function returning the time in mS, NULL = millis()
+     */
+    void SetClock(unsigned long (*fn)(void)) {_Clock = fn;}
+
+    SEN55Sim_state GetState() {return(_State);}
+    bool FanCleaning();
+
+    /** raw measured values as send by the SEN55 (before scaling) */
+    uint16_t Values[8];                 // SEN55_READ_MEASURED_VALUE
+    uint16_t ValuesPM[10];              // SEN55_READ_MEASURED_VALUE_PM
+
+    /** counters */
+    uint32_t Commands;                  // commands received
+    uint32_t Injected;                  // errors injected
+
+  private:
+    uint32_t _Id;                       // used for the serial number
+    uint32_t _Seed;
+    unsigned long (*_Clock)(void);
+    unsigned long Now() {return(_Clock ? _Clock() : millis());}
+
+    /** I2C */
+    uint8_t _Addr;
+    uint8_t _Tx[MAXBUFLENGTH];
+    uint8_t _TxLen;
+    uint16_t _Cmd;                      // last command received
+    bool _CmdOk;                        // last command accepted
+    unsigned long _CmdTime;             // millis() last command
+    uint8_t _Rx[MAXBUFLENGTH];
+    uint8_t _RxLen, _RxPos;
+
+    /** state */
+    SEN55Sim_state _State;
+    bool _Strict;
+    bool _Generator;
+    bool _DataReady;
+    unsigned long _MeasStart;           // millis() start measurement
+    unsigned long _LastTick;            // last measurement (seconds since start)
+    unsigned long _CleanStart;          // millis() start fan cleaning
+    bool _Cleaning;
+
+    /** error injection */
+    uint32_t _NackRate, _CrcRate, _ShortRate;
+
+    /** register file */
+    uint32_t _AutoClean;
+    uint16_t _TempComp[3];
+    uint16_t _WarmStart;
+    uint16_t _VocTuning[6];
+    uint16_t _NoxTuning[6];
+    uint16_t _RhtAccel;
+    uint16_t _VocState[4];
+    uint32_t _Status;
+
+    /** generators */
+    float _PM25, _Spike, _Voc, _Nox;
+
+    void Defaults();
+    bool Execute(uint16_t cmd, const uint16_t *data, uint8_t n);
+    uint16_t ExecTime(uint16_t cmd);
+    void Update();
+    void Generate(unsigned long sec);
+    uint32_t Random();
+    float Noise(float range);
+    bool Chance(uint32_t rate) {return(rate > 0 && Random() < rate);}
+
+    void Respond(const uint16_t *words, uint8_t n);
+    void Respond_Str(const char *str);
+    static uint8_t CRC(const uint8_t *data);
+};
+
+#endif /* SEN55_SIM_H */
@@ -0,0 +1,582 @@
+/**
+ * SEN55 sampling daemon for Linux
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Reads SEN55 sensors on one or more /dev/i2c-N buses (one SEN55 per bus)
+ * from a single thread. Each sensor has a timerfd, all are waited for with one
+ * epoll. A sensor is read once per interval, aligned to the moment its
+ * measurement was started. Between the command and the answer (5 mS) the other
+ * sensors are served, the daemon does not sleep inside the library.
+ *
+ * The samples are written as CSV lines to stdout and to every consumer that is
+ * connected to the Unix socket (-s). A slow consumer is disconnected, it never
+ * delays the sampling. With -m the samples are also written to a ring in
+ * shared memory (see sen55_shm.h), local consumers read it without a copy
+ * through the kernel and without being disconnected. With -l every sample is
+ * appended to a binary log file (see sen55_log.h).
+ *
+ *   name,time,PM1,PM2.5,PM4,PM10,RH,T,VOC,NOx,status
+ *
+ * SIGUSR1 prints the statistics (including the scheduling jitter : the time
+ * between the deadline and the moment the daemon woke up for it), SIGINT and
+ * SIGTERM stop the measurement and print the statistics.
+ *
+ * usage : ./build/sen55d [options] bus [bus ...]
+ *   bus      : /dev/i2c-N, or sim:N for N simulated sensors (testing)
+ *   -i ms    : interval in mS (default 1000, minimum 1000)
+ *   -s path  : Unix socket to publish the samples
+ *   -S n     : read the status register every n samples and when the values
+ *              look anomalous (default 10, 0 = only on anomalous values)
+ *   -t sec   : stop after sec seconds (default 0 = run until stopped)
+ *   -m name  : shared memory ring to publish the samples (e.g. /sen55)
+ *   -p       : also read the PM number concentrations (only with -m or -l)
+ *   -d sec   : only write a sample to stdout and the socket when a value moved
+ *              more than its deadband, or after sec seconds (the shared memory
+ *              ring still gets every sample)
+ *   -l file  : append every sample to a binary log (flushed every 10 seconds)
+ *   -q       : do not write the samples to stdout
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55.h"
+#include "sen55_sim.h"
+#include "linux_wire.h"
+#include "sen55_shm.h"
+#include "sen55_deadband.h"
+#include "sen55_log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <vector>
+
+/** sensor states */
+#define D_START   0                     // start requested
+#define D_WAIT    1                     // waiting for next interval
+#define D_VALUES  2                     // values requested
+#define D_STATUS  3                     // status register requested
+#define D_CLEAR   4                     // clear status register requested
+#define D_PM      5                     // PM values requested
+#define D_RESTART 6                     // start failed, send it again
+
+#define JIT_BUCKETS 8                   // jitter histogram : < 64uS, < 128uS ... >= 4mS
+
+struct Sensor {
+  char name[32];
+  TwoWire *bus;
+  SEN55 sen;
+  int tfd;                              // timerfd
+  uint8_t state;
+  uint64_t deadline;                    // next interval (uS CLOCK_MONOTONIC)
+  struct sen_values val;
+  struct sen_values_pm pm;
+  uint8_t status;
+  uint16_t shm_idx;                     // index in the shared memory name table
+  uint16_t log_idx;                     // index in the log name table
+  SEN55Deadband db;                     // publish filter (-d)
+
+  // statistics
+  unsigned long samples, errors, missed, faults;
+  uint64_t jit_min, jit_max, jit_sum;
+  unsigned long jit_cnt, jit_hist[JIT_BUCKETS];
+};
+
+static std::vector<Sensor *> sensors;
+static std::vector<int> clients;
+static uint32_t interval = 1000, status_every = 10, deadband = 0;
+static bool to_stdout = true, with_pm = false;
+static SEN55ShmWriter shm;
+static SEN55LogWriter logw;
+static int efd, lfd = -1;
+static unsigned long wakeups = 0;
+
+/**
+ * @brief : monotonic time in uS
+ */
+static uint64_t now_us()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint64_t) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+
+/**
+ * @brief : arm the timer of a sensor at an absolute time
+ */
+static void arm(Sensor *s, uint64_t at_us)
+{
+  struct itimerspec its;
+
+  memset(&its, 0x0, sizeof(its));
+  its.it_value.tv_sec = at_us / 1000000ULL;
+  its.it_value.tv_nsec = (at_us % 1000000ULL) * 1000;
+
+  // 0 would disarm the timer
+  if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) its.it_value.tv_nsec = 1;
+
+  timerfd_settime(s->tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/**
+ * @brief : send a command and arm the timer for the answer
+ *
+ * return : true if sent, false if not (counted as error, nothing to collect)
+ */
+static bool request(Sensor *s, uint16_t cmd, uint8_t state)
+{
+  if (s->sen.Request(cmd) != SEN55_ERR_OK) {
+    s->errors++;
+    return(false);
+  }
+
+  s->state = state;
+  arm(s, now_us() + s->sen.RequestDelay(cmd) * 1000ULL);
+  return(true);
+}
+
+/**
+ * @brief : start measurement, if that fails try again after the start delay
+ */
+static void start_measurement(Sensor *s)
+{
+  if (request(s, SEN55_START_MEASUREMENT, D_START)) return;
+
+  s->state = D_RESTART;
+  arm(s, now_us() + s->sen.RequestDelay(SEN55_START_MEASUREMENT) * 1000ULL);
+}
+
+/**
+ * @brief : wait for the next interval, skip the intervals that were missed
+ */
+static void next_interval(Sensor *s)
+{
+  uint64_t now = now_us();
+
+  s->deadline += interval * 1000ULL;
+
+  while (s->deadline <= now) {
+    s->deadline += interval * 1000ULL;
+    s->missed++;
+  }
+
+  s->state = D_WAIT;
+  arm(s, s->deadline);
+}
+
+/**
+ * @brief : write sample to stdout and the consumers
+ */
+static void publish(Sensor *s)
+{
+  struct timespec ts;
+  char line[200];
+  int len;
+
+  shm.Write(s->shm_idx, s->status, &s->val, with_pm ? &s->pm : NULL);
+  logw.Append(s->log_idx, s->status, &s->val, with_pm ? &s->pm : NULL);
+
+  // nothing moved and no heartbeat due
+  if (deadband && ! s->db.Check(&s->val, now_us() / 1000)) return;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+
+  len = snprintf(line, sizeof(line), "%s,%ld.%03ld,%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,%.1f,%.1f,%d\n",
+    s->name, (long) ts.tv_sec, ts.tv_nsec / 1000000L, s->val.MassPM1, s->val.MassPM2,
+    s->val.MassPM4, s->val.MassPM10, s->val.Hum, s->val.Temp, s->val.VOC, s->val.NOX, s->status);
+
+  if (to_stdout) fwrite(line, 1, len, stdout);
+
+  for (size_t i = 0; i < clients.size();) {
+    if (send(clients[i], line, len, MSG_NOSIGNAL | MSG_DONTWAIT) != len) {
+      // gone or too slow
+      close(clients[i]);
+      clients[i] = clients.back();
+      clients.pop_back();
+    }
+    else i++;
+  }
+}
+
+/**
+ * @brief : record the scheduling jitter of an interval
+ */
+static void jitter(Sensor *s, uint64_t now)
+{
+  uint64_t j = now > s->deadline ? now - s->deadline : 0, b;
+  int bucket;
+
+  if (s->jit_cnt == 0 || j < s->jit_min) s->jit_min = j;
+  if (j > s->jit_max) s->jit_max = j;
+  s->jit_sum += j;
+  s->jit_cnt++;
+
+  for (b = j >> 6, bucket = 0; b && bucket < JIT_BUCKETS - 1; b >>= 1) bucket++;
+  s->jit_hist[bucket]++;
+}
+
+/**
+ * @brief : sample is complete, publish (after reading the status if due)
+ */
+static void sampled(Sensor *s)
+{
+  s->samples++;
+
+  // the status that is read belongs to this sample
+  if (s->sen.HealthDue(&s->val)) {
+    if (request(s, SEN55_READ_DEVICE_REGISTER, D_STATUS)) return;
+  }
+
+  publish(s);
+  next_interval(s);
+}
+
+/**
+ * @brief : next step for a sensor (its timer expired)
+ */
+static void step(Sensor *s)
+{
+  uint64_t now = now_us();
+  uint8_t ret;
+
+  switch(s->state) {
+
+    case D_START:
+      // first values are available now (start waits 1000 mS)
+      s->sen.Collect(SEN55_START_MEASUREMENT);
+      s->deadline = now;
+      s->state = D_WAIT;
+      arm(s, s->deadline);
+      break;
+
+    case D_RESTART:
+      start_measurement(s);
+      break;
+
+    case D_WAIT:
+      jitter(s, now);
+      if (! request(s, SEN55_READ_MEASURED_VALUE, D_VALUES)) next_interval(s);
+      break;
+
+    case D_VALUES:
+      ret = s->sen.Collect(SEN55_READ_MEASURED_VALUE, &s->val);
+
+      if (ret != SEN55_ERR_OK) {
+        s->errors++;
+        next_interval(s);
+      }
+      else if (with_pm) {
+        if (! request(s, SEN55_READ_MEASURED_VALUE_PM, D_PM)) next_interval(s);
+      }
+      else
+        sampled(s);
+      break;
+
+    case D_PM:
+      ret = s->sen.Collect(SEN55_READ_MEASURED_VALUE_PM, &s->pm);
+
+      if (ret != SEN55_ERR_OK) {
+        s->errors++;
+        next_interval(s);
+      }
+      else
+        sampled(s);
+      break;
+
+    case D_STATUS:
+      ret = s->sen.Collect(SEN55_READ_DEVICE_REGISTER, &s->status);
+
+      if (ret != SEN55_ERR_OK && ret != SEN55_ERR_OUTOFRANGE) s->errors++;
+
+      publish(s);
+
+      // clear status register only if there was an issue
+      if (ret == SEN55_ERR_OUTOFRANGE) {
+        s->faults++;
+        if (request(s, SEN55_CLEAR_DEVICE_REGISTER, D_CLEAR)) break;
+      }
+
+      next_interval(s);
+      break;
+
+    case D_CLEAR:
+      s->sen.Collect(SEN55_CLEAR_DEVICE_REGISTER);
+      next_interval(s);
+      break;
+  }
+}
+
+/**
+ * @brief : print the statistics
+ */
+static void statistics(uint64_t start)
+{
+  struct rusage ru;
+  double run = (now_us() - start) / 1e6, cpu;
+  unsigned long hist[JIT_BUCKETS] = {0};
+  int i;
+
+  getrusage(RUSAGE_SELF, &ru);
+  cpu = ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+
+  fprintf(stderr, "\n%-14s %8s %6s %6s %6s %9s %9s %9s\n", "sensor", "samples",
+    "errors", "missed", "faults", "jit min", "jit mean", "jit max");
+
+  for (Sensor *s : sensors) {
+    fprintf(stderr, "%-14s %8lu %6lu %6lu %6lu %7luuS %7luuS %7luuS\n", s->name, s->samples,
+      s->errors, s->missed, s->faults, (unsigned long) s->jit_min,
+      (unsigned long) (s->jit_cnt ? s->jit_sum / s->jit_cnt : 0), (unsigned long) s->jit_max);
+
+    for (i = 0; i < JIT_BUCKETS; i++) hist[i] += s->jit_hist[i];
+  }
+
+  if (deadband) {
+    uint32_t checked, sent, t_checked = 0, t_sent = 0;
+
+    for (Sensor *s : sensors) {
+      s->db.GetStats(&checked, &sent);
+      t_checked += checked;
+      t_sent += sent;
+    }
+
+    fprintf(stderr, "deadband       : %lu of %lu samples published (%.1f%%)\n", (unsigned long) t_sent,
+      (unsigned long) t_checked, t_checked ? t_sent * 100.0 / t_checked : 0);
+  }
+
+  fprintf(stderr, "jitter         :");
+  for (i = 0; i < JIT_BUCKETS - 1; i++) fprintf(stderr, " <%duS %lu", 64 << i, hist[i]);
+  fprintf(stderr, " >=%duS %lu\n", 64 << (JIT_BUCKETS - 2), hist[JIT_BUCKETS - 1]);
+
+  fprintf(stderr, "run time       : %.1f s, cpu %.3f s (%.2f%%), %lu wakeups, %zu consumers\n",
+    run, cpu, run > 0 ? cpu * 100 / run : 0, wakeups, clients.size());
+}
+
+/**
+ * @brief : open the Unix socket for the consumers
+ */
+static int open_socket(const char *path)
+{
+  struct sockaddr_un addr;
+  int fd;
+
+  fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) return(-1);
+
+  memset(&addr, 0x0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  unlink(path);
+
+  if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+    close(fd);
+    return(-1);
+  }
+
+  return(fd);
+}
+
+/**
+ * @brief : add a sensor to the epoll
+ */
+static bool add_sensor(const char *name, TwoWire *bus)
+{
+  struct epoll_event ev;
+  Sensor *s = new Sensor();
+
+  strncpy(s->name, name, sizeof(s->name) - 1);
+  s->bus = bus;
+
+  if (! s->sen.begin(bus) || ! s->sen.probe()) {
+    fprintf(stderr, "%s : no SEN55 detected\n", name);
+    delete s;
+    return(false);
+  }
+
+  s->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+  ev.events = EPOLLIN;
+  ev.data.ptr = s;
+  epoll_ctl(efd, EPOLL_CTL_ADD, s->tfd, &ev);
+
+  s->sen.SetHealthCheck(status_every);
+  s->db.SetHeartbeat(deadband * 1000);
+  sensors.push_back(s);
+  s->shm_idx = shm.AddSensor(name);
+  s->log_idx = logw.AddSensor(name);
+
+  // measurement could still run from an earlier session
+  s->sen.Request(SEN55_STOP_MEASUREMENT);
+  return(true);
+}
+
+int main(int argc, char *argv[])
+{
+  struct epoll_event ev, events[64];
+  struct signalfd_siginfo si;
+  uint64_t start, expired, flushed;
+  const char *sock = NULL, *shm_name = NULL, *log_name = NULL;
+  char name[32];
+  unsigned long run = 0;
+  sigset_t mask;
+  bool stop = false;
+  int opt, sfd, n, i, cnt;
+
+  while ((opt = getopt(argc, argv, "i:s:S:t:m:pd:l:q")) != -1) {
+    switch(opt) {
+      case 'i': interval = strtoul(optarg, NULL, 10); break;
+      case 's': sock = optarg; break;
+      case 'S': status_every = strtoul(optarg, NULL, 10); break;
+      case 't': run = strtoul(optarg, NULL, 10); break;
+      case 'm': shm_name = optarg; break;
+      case 'p': with_pm = true; break;
+      case 'd': deadband = strtoul(optarg, NULL, 10); break;
+      case 'l': log_name = optarg; break;
+      case 'q': to_stdout = false; break;
+      default:
+        fprintf(stderr, "usage : %s [-i ms] [-s socket] [-S n] [-t sec] [-m shm] [-p] [-d sec] [-l file] [-q] bus [bus ...]\n", argv[0]);
+        return(1);
+    }
+  }
+
+  if (optind >= argc) {
+    fprintf(stderr, "no bus given (/dev/i2c-N or sim:N)\n");
+    return(1);
+  }
+
+  if (interval < 1000) interval = 1000;
+
+  efd = epoll_create1(EPOLL_CLOEXEC);
+
+  // signals are handled in the loop
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  sigaddset(&mask, SIGUSR1);
+  sigprocmask(SIG_BLOCK, &mask, NULL);
+  sfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  epoll_ctl(efd, EPOLL_CTL_ADD, sfd, &ev);
+
+  if (sock) {
+    lfd = open_socket(sock);
+    if (lfd < 0) {
+      fprintf(stderr, "can not open socket %s : %s\n", sock, strerror(errno));
+      return(1);
+    }
+    ev.data.ptr = &lfd;
+    epoll_ctl(efd, EPOLL_CTL_ADD, lfd, &ev);
+  }
+
+  if (shm_name && ! shm.Create(shm_name)) {
+    fprintf(stderr, "can not create shared memory %s : %s\n", shm_name, strerror(errno));
+    return(1);
+  }
+
+  errno = 0;
+
+  if (log_name && ! logw.Open(log_name)) {
+    fprintf(stderr, "can not open log %s : %s\n", log_name, errno ? strerror(errno) : "not a log of this version");
+    return(1);
+  }
+
+  if (! shm_name && ! log_name) with_pm = false;
+
+  for (i = optind; i < argc; i++) {
+
+    if (strncmp(argv[i], "sim:", 4) == 0) {
+      cnt = atoi(argv[i] + 4);
+      for (n = 0; n < cnt; n++) {
+        snprintf(name, sizeof(name), "sim%d", n);
+        add_sensor(name, new SEN55Sim(n + 1));
+      }
+      continue;
+    }
+
+    LinuxWire *bus = new LinuxWire();
+
+    if (! bus->Open(argv[i])) {
+      fprintf(stderr, "can not open %s : %s\n", argv[i], strerror(errno));
+      delete bus;
+      continue;
+    }
+
+    add_sensor(argv[i], bus);
+  }
+
+  if (sensors.empty()) {
+    fprintf(stderr, "no sensors\n");
+    return(1);
+  }
+
+  delay(sensors[0]->sen.RequestDelay(SEN55_STOP_MEASUREMENT));
+
+  for (Sensor *s : sensors) {
+    s->sen.Collect(SEN55_STOP_MEASUREMENT);
+    start_measurement(s);
+  }
+
+  start = flushed = now_us();
+
+  while (! stop) {
+
+    n = epoll_wait(efd, events, 64, run ? 1000 : -1);
+    wakeups++;
+
+    for (i = 0; i < n; i++) {
+
+      // signal
+      if (events[i].data.ptr == NULL) {
+        while (read(sfd, &si, sizeof(si)) == sizeof(si)) {
+          if (si.ssi_signo == SIGUSR1) statistics(start);
+          else stop = true;
+        }
+      }
+
+      // new consumer
+      else if (events[i].data.ptr == &lfd) {
+        int c;
+        while ((c = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+          clients.push_back(c);
+      }
+
+      // sensor timer
+      else {
+        Sensor *s = (Sensor *) events[i].data.ptr;
+        if (read(s->tfd, &expired, sizeof(expired)) == sizeof(expired)) step(s);
+      }
+    }
+
+    if (to_stdout) fflush(stdout);
+
+    if (log_name && now_us() - flushed >= 10000000ULL) {
+      logw.Flush();
+      flushed = now_us();
+    }
+
+    if (run && now_us() - start >= run * 1000000ULL) stop = true;
+  }
+
+  for (Sensor *s : sensors) s->sen.stop();
+
+  statistics(start);
+
+  if (sock) unlink(sock);
+  shm.Close();
+  logw.Close();
+
+  return(0);
+}
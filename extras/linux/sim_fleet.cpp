@@ -0,0 +1,114 @@
+/**
+ * SEN55 fleet simulation
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * Runs many SEN55 drivers, each against its own simulated SEN55, in one
+ * process and in virtual time. Each virtual second all sensors are read,
+ * every 10 seconds the status register is read as well.
+ * Use it to load-test a multi-sensor host or to test the error handling of
+ * the library with error injection.
+ *
+ * usage : ./build/sim_fleet [sensors] [seconds] [error rate]
+ *   sensors    : number of virtual sensors (default 100)
+ *   seconds    : virtual seconds to run (default 3600)
+ *   error rate : chance for NACK, CRC error and short read (default 0.001)
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sen55.h"
+#include "sen55_sim.h"
+#include <time.h>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+  unsigned long sensors = 100, seconds = 3600, sec, i, reads = 0, errors = 0, faults = 0;
+  unsigned long crc = 0, shortread = 0, retries = 0, injected = 0;
+  float rate = 0.001;
+  struct sen_values val;
+  struct sen_stats st;
+  struct timespec t0, t1;
+  uint8_t status;
+  double wall, pm25 = 0;
+
+  if (argc > 1) sensors = strtoul(argv[1], NULL, 10);
+  if (argc > 2) seconds = strtoul(argv[2], NULL, 10);
+  if (argc > 3) rate = atof(argv[3]);
+
+  ShimRealDelay(false);
+
+  std::vector<SEN55Sim *> sim(sensors);
+  std::vector<SEN55 *> sen(sensors);
+
+  for (i = 0; i < sensors; i++) {
+    sim[i] = new SEN55Sim(i + 1);
+    sen[i] = new SEN55();
+    sen[i]->begin(sim[i]);
+    sen[i]->SetRetry(1);
+
+    if (! sen[i]->start()) {
+      printf("could not start sensor %lu\n", i);
+      return(1);
+    }
+
+    // inject errors once running (a NACK on start is not detected by the library)
+    sim[i]->SetErrorRate(rate, rate, rate);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+
+  for (sec = 0; sec < seconds; sec++) {
+
+    unsigned long st_sec = millis();
+
+    // one sensor gets a fan failure after half the time
+    if (sec == seconds / 2) sim[0]->InjectStatus(SIM_STATUS_FAN);
+
+    for (i = 0; i < sensors; i++) {
+      reads++;
+      if (sen[i]->GetValues(&val) != SEN55_ERR_OK) errors++;
+      else pm25 += val.MassPM2;
+
+      if (sec % 10 == 0) {
+        if (sen[i]->GetStatusReg(&status) == SEN55_ERR_OUTOFRANGE) faults++;
+      }
+    }
+
+    // wait for next second (virtual time)
+    if (millis() - st_sec < 1000) delay(1000 - (millis() - st_sec));
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+  for (i = 0; i < sensors; i++) {
+    sen[i]->GetStatistics(&st);
+    crc += st.crc_errors;
+    shortread += st.short_reads;
+    retries += st.retries;
+    injected += sim[i]->Injected;
+  }
+
+  printf("sensors          : %lu\n", sensors);
+  printf("virtual seconds  : %lu\n", seconds);
+  printf("wall time        : %.3f s (%.0f reads/s)\n", wall, reads / wall);
+  printf("reads            : %lu, failed %lu\n", reads, errors);
+  printf("mean PM2.5       : %.1f ug/m3\n", reads > errors ? pm25 / (reads - errors) : 0);
+  printf("injected errors  : %lu\n", injected);
+  printf("driver counted   : crc %lu, short reads %lu, retries %lu\n", crc, shortread, retries);
+  printf("status faults    : %lu\n", faults);
+
+  for (i = 0; i < sensors; i++) {
+    delete sen[i];
+    delete sim[i];
+  }
+
+  return(0);
+}
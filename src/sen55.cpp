@@ -23,6 +23,19 @@
  * Version 1.0 / October 2024 /paulvha
  * - Initial version
  *
+ * Version 1.1 / October 2026 /paulvha
+ * - cache device identity, added GetInventory() and PrintInventory()
+ * - added transaction statistics and optional read retry
+ * - added binary trace of I2C frames, option to remove the text debug
+ * - added capture and replay of I2C frames
+ * - added SetWait() to select how to wait (delay, yield or virtual time)
+ * - added non-blocking measurement with poll()
+ * - added split transactions Request() and Collect()
+ * - added latest sample cell SEN55Latest for threaded builds
+ * - added shared bus SEN55Bus and locks for use from more tasks
+ * - added priority command queue SEN55Queue
+ * - added health monitor GetValuesStatus(), status register only cleared on issues
+ *
  *********************************************************************
  */
 
@@ -30,6 +43,25 @@
 #include <stdarg.h>
 #include <stdio.h>
 
+#ifdef SEN55_THREADS
+/**
+ * holds the SEN55 lock until the end of the routine
+ */
+class SEN55Guard
+{
+  public:
+    SEN55Guard(SEN55Mutex *m) {_M = m; _M->Lock();}
+    ~SEN55Guard() {_M->Unlock();}
+
+  private:
+    SEN55Mutex *_M;
+};
+
+#define SEN55_GUARD() SEN55Guard _guard(&_Lock)
+#else
+#define SEN55_GUARD()
+#endif
+
 #if not defined SMALLFOOTPRINT
 /* error descripton */
 struct SEN55_Description SEN55_ERR_desc[11] =
@@ -48,6 +80,19 @@ struct SEN55_Description SEN55_ERR_desc[11] =
 };
 #endif // SMALLFOOTPRINT
 
+#ifdef SEN55_STATISTICS
+/* commands tracked in the statistics */
+static const uint16_t SEN55_Stat_Cmd[SEN55_STAT_CMDS] =
+{
+  SEN55_START_MEASUREMENT, SEN55_START_RHTG_MEASUREMENT, SEN55_STOP_MEASUREMENT,
+  SEN55_READ_DATA_RDY_FLAG, SEN55_READ_MEASURED_VALUE, SEN55_READ_MEASURED_VALUE_PM,
+  SEN55_TEMP_COMP, SEN55_WARM_START_PARAM, SEN55_VOC_TUNING, SEN55_NOX_TUNING,
+  SEN55_RHT_ACCEL, SEN55_VOC_ALGO, SEN55_START_FAN_CLEANING, SEN55_AUTO_CLEANING_INTERVAL,
+  SEN55_READ_PRODUCT_NAME, SEN55_READ_SERIAL_NUMBER, SEN55_READ_VERSION,
+  SEN55_READ_DEVICE_REGISTER, SEN55_CLEAR_DEVICE_REGISTER, SEN55_RESET
+};
+#endif // SEN55_STATISTICS
+
 /**
  * @brief constructor and initialize variables
  */
@@ -57,7 +102,31 @@ SEN55::SEN55(void)
   _Receive_BUF_Length = 0;
   _SEN55_Debug = 0;
   _started = false;
+  _Laser = true;
+  _HealthEvery = SEN55_HEALTH_EVERY;
+  _HealthJump = SEN55_HEALTH_JUMP;
+  _HealthCnt = 0;
+  _HealthPrev = -1;
+  _HealthStatus = STATUS_OK_55;
   _FW_Major = _FW_Minor = 0;
+  _InvValid = 0;
+  _Retry = 0;
+  _Trace = false;
+  _Capture = NULL;
+  _Replay = NULL;
+  _i2cPort = NULL;
+  _Bus = NULL;
+  _WaitMode = SEN55_WAIT_DELAY;
+  _WaitFn = NULL;
+  _VirtualTime = 0;
+  _PollState = SEN55_POLL_OFF;
+  _PollNew = false;
+  _PollCb = NULL;
+#ifdef SEN55_LATEST
+  _Latest = NULL;
+#endif
+  _TraceTail = _TraceUsed = 0;
+  ResetStatistics();
 }
 
 /**
@@ -71,6 +140,7 @@ void SEN55::EnableDebugging(uint8_t act) {
   _SEN55_Debug = act;
 }
 
+#ifndef SEN55_NO_DEBUG_TEXT
 /**
  * @brief Print debug message if enabled 
  */
@@ -86,6 +156,351 @@ void SEN55::DebugPrintf(const char *pcFmt, ...)
 
   SEN55_DEBUGSERIAL.print(prfbuf);
 }
+#endif // SEN55_NO_DEBUG_TEXT
+
+/**
+ * @brief : enable or disable the binary trace
+ *
+ * @param act : true enable, false disable
+ *
+ * return : false if trace is not included
+ */
+bool SEN55::EnableTrace(bool act)
+{
+#if SEN55_TRACE_SIZE > 0
+  _Trace = act;
+  return(true);
+#else
+  return(false);
+#endif
+}
+
+/**
+ * @brief : add an I2C frame to the trace buffer and capture stream
+ *
+ * @param dir    : SEN55_TRACE_WRITE or SEN55_TRACE_READ
+ * @param status : result of the frame
+ * @param data   : raw bytes
+ * @param len    : number of raw bytes
+ */
+void SEN55::Trace(uint8_t dir, uint8_t status, uint8_t *data, uint8_t len)
+{
+  uint8_t hdr[SEN55_TRACE_HDR];
+  uint32_t t;
+
+  if (! _Trace && _Capture == NULL) return;
+
+  t = Micros();
+
+  hdr[0] = len;
+  hdr[1] = dir;
+  hdr[2] = _Send_BUF[0];        // command MSB
+  hdr[3] = _Send_BUF[1];        // command LSB
+  hdr[4] = t >> 24 & 0xff;
+  hdr[5] = t >> 16 & 0xff;
+  hdr[6] = t >> 8 & 0xff;
+  hdr[7] = t & 0xff;
+  hdr[8] = status;
+
+  if (_Capture) {
+    _Capture->write(hdr, SEN55_TRACE_HDR);
+    _Capture->write(data, len);
+  }
+
+#if SEN55_TRACE_SIZE > 0
+  uint16_t e, h, need = SEN55_TRACE_HDR + len;
+  uint8_t i;
+
+  if (! _Trace || need > SEN55_TRACE_SIZE) return;
+
+  // overwrite the oldest entries until it fits
+  while (SEN55_TRACE_SIZE - _TraceUsed < need) {
+    e = SEN55_TRACE_HDR + _TraceBuf[_TraceTail];
+    _TraceTail = (_TraceTail + e) % SEN55_TRACE_SIZE;
+    _TraceUsed -= e;
+  }
+
+  h = (_TraceTail + _TraceUsed) % SEN55_TRACE_SIZE;
+
+  for (i = 0; i < SEN55_TRACE_HDR; i++) {
+    _TraceBuf[h] = hdr[i];
+    if (++h == SEN55_TRACE_SIZE) h = 0;
+  }
+
+  for (i = 0; i < len; i++) {
+    _TraceBuf[h] = data[i];
+    if (++h == SEN55_TRACE_SIZE) h = 0;
+  }
+
+  _TraceUsed += need;
+#endif
+}
+
+/**
+ * @brief : start or stop the capture of I2C frames
+ *
+ * @param out : stream to write to, NULL to stop
+ */
+void SEN55::EnableCapture(Print *out)
+{
+  _Capture = out;
+}
+
+/**
+ * @brief : start or stop replay of captured I2C frames
+ *
+ * @param in : stream to read from, NULL to stop
+ */
+void SEN55::EnableReplay(Stream *in)
+{
+  _Replay = in;
+}
+
+/**
+ * @brief : get the next frame from the replay stream
+ *
+ * @param dir  : expected direction SEN55_TRACE_WRITE or SEN55_TRACE_READ
+ * @param data : to store the raw bytes (MAXBUFLENGTH)
+ * @param len  : to store the number of raw bytes
+ *
+ * return :
+ *  status of the frame
+ *  SEN55_REPLAY_END : end of stream or unexpected frame
+ */
+uint8_t SEN55::Replay_Frame(uint8_t dir, uint8_t *data, uint8_t *len)
+{
+  uint8_t hdr[SEN55_TRACE_HDR], i, b;
+
+  *len = 0;
+
+  if (_Replay->readBytes(hdr, SEN55_TRACE_HDR) != SEN55_TRACE_HDR) {
+    DebugPrintf("Replay: end of stream\n");
+    return(SEN55_REPLAY_END);
+  }
+
+  for (i = 0; i < hdr[0]; i++) {
+    if (_Replay->readBytes(&b, 1) != 1) return(SEN55_REPLAY_END);
+    if (*len < MAXBUFLENGTH) data[(*len)++] = b;
+  }
+
+  if (hdr[1] != dir || hdr[2] != _Send_BUF[0] || hdr[3] != _Send_BUF[1]) {
+    DebugPrintf("Replay: unexpected frame 0x%02X%02X\n", hdr[2], hdr[3]);
+    return(SEN55_REPLAY_END);
+  }
+
+  return(hdr[8]);
+}
+
+/**
+ * @brief : select how the library waits for the SEN55
+ * @param mode : SEN55_WAIT_DELAY, SEN55_WAIT_YIELD or SEN55_WAIT_VIRTUAL
+ * @param fn   : wait function (optional)
+ */
+void SEN55::SetWait(uint8_t mode, void (*fn)(uint32_t ms))
+{
+  _WaitMode = mode;
+  _WaitFn = fn;
+}
+
+/**
+ * @brief : wait for the SEN55 (not during replay)
+ * @param ms : milliseconds to wait
+ */
+void SEN55::Wait(uint32_t ms)
+{
+  uint32_t st, passed;
+
+  if (_Replay) return;
+
+  switch(_WaitMode) {
+
+    case SEN55_WAIT_VIRTUAL:
+      _VirtualTime += ms;
+      if (_WaitFn) _WaitFn(ms);
+      break;
+
+    case SEN55_WAIT_YIELD:
+      st = millis();
+      while ((passed = millis() - st) < ms) {
+        if (_WaitFn) _WaitFn(ms - passed);
+        else yield();
+      }
+      break;
+
+    default:
+      delay(ms);
+      break;
+  }
+}
+
+/**
+ * @brief : get byte from trace buffer
+ * @param offset : offset from the oldest entry
+ */
+uint8_t SEN55::Trace_Get(uint16_t offset)
+{
+#if SEN55_TRACE_SIZE > 0
+  return(_TraceBuf[(_TraceTail + offset) % SEN55_TRACE_SIZE]);
+#else
+  return(0);
+#endif
+}
+
+/**
+ * @brief : remove bytes (complete entries) from the start of the trace
+ * @param n : number of bytes
+ */
+void SEN55::Trace_Drop(uint16_t n)
+{
+#if SEN55_TRACE_SIZE > 0
+  _TraceTail = (_TraceTail + n) % SEN55_TRACE_SIZE;
+  _TraceUsed -= n;
+#endif
+}
+
+/**
+ * @brief : copy complete trace entries (oldest first)
+ *
+ * @param buf   : buffer to hold the entries
+ * @param len   : length of the buffer
+ * @param clear : true : remove the copied entries from the trace
+ *
+ * return : number of bytes copied
+ */
+uint16_t SEN55::GetTrace(uint8_t *buf, uint16_t len, bool clear)
+{
+  SEN55_GUARD();
+
+  uint16_t e, k, n = 0;
+
+  while (n < _TraceUsed) {
+    e = SEN55_TRACE_HDR + Trace_Get(n);
+    if (n + e > len) break;
+
+    for (k = 0; k < e; k++, n++) buf[n] = Trace_Get(n);
+  }
+
+  if (clear) Trace_Drop(n);
+
+  return(n);
+}
+
+/**
+ * @brief : decode and print the trace entries (oldest first)
+ *
+ * @param out   : output to use
+ * @param clear : true : remove the printed entries from the trace
+ *
+ * format : timestamp W|R command status : raw bytes
+ */
+void SEN55::PrintTrace(Print *out, bool clear)
+{
+  SEN55_GUARD();
+
+  uint16_t e, k, n = 0;
+  uint32_t t;
+  uint8_t b;
+
+  while (n < _TraceUsed) {
+    e = SEN55_TRACE_HDR + Trace_Get(n);
+
+    t = (uint32_t) Trace_Get(n + 4) << 24 | (uint32_t) Trace_Get(n + 5) << 16 | 
+        (uint32_t) Trace_Get(n + 6) << 8 | Trace_Get(n + 7);
+
+    out->print(t);
+    out->print(' ');
+    out->print((char) Trace_Get(n + 1));
+    out->print(F(" 0x"));
+    for (k = 2; k < 4; k++) {
+      b = Trace_Get(n + k);
+      if (b < 0x10) out->print('0');
+      out->print(b, HEX);
+    }
+    out->print(F(" status 0x"));
+    out->print(Trace_Get(n + 8), HEX);
+    out->print(F(" :"));
+
+    for (k = SEN55_TRACE_HDR; k < e; k++) {
+      b = Trace_Get(n + k);
+      out->print(' ');
+      if (b < 0x10) out->print('0');
+      out->print(b, HEX);
+    }
+    out->println();
+
+    n += e;
+  }
+
+  if (clear) Trace_Drop(n);
+}
+
+/**
+ * @brief : obtain a snapshot of the transaction statistics
+ *
+ * @param s     : structure to hold the snapshot
+ * @param reset : if true the statistics are reset after the snapshot
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  SEN55_ERR_PARAMETER = statistics not included
+ */
+uint8_t SEN55::GetStatistics(struct sen_stats *s, bool reset)
+{
+  SEN55_GUARD();
+
+#ifdef SEN55_STATISTICS
+  memcpy(s, &_Stats, sizeof(struct sen_stats));
+  if (reset) ResetStatistics();
+  return(SEN55_ERR_OK);
+#else
+  memset(s, 0x0, sizeof(struct sen_stats));
+  return(SEN55_ERR_PARAMETER);
+#endif
+}
+
+/**
+ * @brief : reset all transaction statistics
+ */
+void SEN55::ResetStatistics()
+{
+#ifdef SEN55_STATISTICS
+  memset(&_Stats, 0x0, sizeof(struct sen_stats));
+  for (uint8_t i = 0; i < SEN55_STAT_CMDS; i++) _Stats.cmd[i].cmd = SEN55_Stat_Cmd[i];
+#endif
+}
+
+#ifdef SEN55_STATISTICS
+/**
+ * @brief : find the statistics entry for the command in _Send_BUF
+ *
+ * return : pointer to entry or NULL if not tracked
+ */
+struct sen_cmd_stats * SEN55::Stat_Cmd()
+{
+  uint16_t cmd = _Send_BUF[0] << 8 | _Send_BUF[1];
+
+  for (uint8_t i = 0; i < SEN55_STAT_CMDS; i++) {
+    if (_Stats.cmd[i].cmd == cmd) return(&_Stats.cmd[i]);
+  }
+
+  return(NULL);
+}
+
+/**
+ * @brief : count a transaction of the command in _Send_BUF
+ * @param call : true if this is the start of a transaction
+ * @param ret  : result of (this part of) the transaction
+ */
+void SEN55::Stat_Count(bool call, uint8_t ret)
+{
+  struct sen_cmd_stats *st = Stat_Cmd();
+
+  if (! st) return;
+
+  if (call) st->calls++;
+  if (ret != SEN55_ERR_OK) st->errors++;
+}
+#endif // SEN55_STATISTICS
 
 /**
  * @brief begin communication
@@ -101,6 +516,23 @@ bool SEN55::begin(TwoWire *wirePort)
   return true;
 }
 
+/**
+ * @brief : use an I2C bus that is shared with other drivers
+ * @param bus : shared bus
+ */
+bool SEN55::begin(SEN55Bus *bus)
+{
+  SEN55_GUARD();
+
+  bus->Lock();
+  _Bus = bus;
+  _i2cPort = bus->Port();
+  _i2cPort->setClock(100000);     // some boards do not set 100K
+  bus->Unlock();
+
+  return true;
+}
+
 /**
  * @brief check if SEN55 sensor is available (read version number)
  *
@@ -111,7 +543,8 @@ bool SEN55::probe() {
   
   struct sen_version v;
 
-  if (GetVersion(&v) == SEN55_ERR_OK)  return(true);
+  // always read from the sensor, not from the cache
+  if (Read_Version(&v) == SEN55_ERR_OK)  return(true);
 
   return(false);
 }
@@ -159,6 +592,8 @@ bool SEN55::FWCheck(uint8_t major, uint8_t minor) {
  *  else SEN55_ERR_OUTOFRANGE, issues found
  */
 uint8_t SEN55::GetStatusReg(uint8_t *status) {
+  SEN55_GUARD();
+
   uint8_t ret;
 
   *status = STATUS_OK_55;
@@ -167,27 +602,90 @@ uint8_t SEN55::GetStatusReg(uint8_t *status) {
   if(! FWCheck(2,0)) return(SEN55_ERR_FIRMWARE);
 
   // try to read status register
-  I2C_fill_buffer(SEN55_READ_DEVICE_REGISTER);
-  ret = I2C_SetPointer_Read(4,false);
+  ret = Read_Cmd(SEN55_READ_DEVICE_REGISTER, status);
   
-  // clear status register just in case there was an issue
-  I2C_fill_buffer(SEN55_CLEAR_DEVICE_REGISTER);
-  I2C_SetPointer();
+  // clear status register only if there was an issue
+  if (ret == SEN55_ERR_OUTOFRANGE) Request(SEN55_CLEAR_DEVICE_REGISTER);
 
-  if (ret != SEN55_ERR_OK) return (ret);
+  return(ret);
+}
 
-  if (_Receive_BUF[1] & 0b00100000) *status |= STATUS_SPEED_ERROR_55;
-  if (_Receive_BUF[3] & 0b10000000) *status |= STATUS_GAS_ERROR_55;
-  if (_Receive_BUF[3] & 0b01000000) *status |= STATUS_RHT_ERROR_55;
-  if (_Receive_BUF[3] & 0b00100000) *status |= STATUS_LASER_ERROR_55;
-  if (_Receive_BUF[3] & 0b00010000) *status |= STATUS_FAN_ERROR_55;
-  
-  if (*status != STATUS_OK_55) return(SEN55_ERR_OUTOFRANGE);
-  
-  // NO errors, now add / check that fan clean is active
-  if (_Receive_BUF[1] & 0b00001000) *status = STATUS_FAN_CLEAN_ACTIVE_55;
+/**
+ * @brief : retrieve measurement values with the device status attached
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  else error reading the values
+ */
+uint8_t SEN55::GetValuesStatus(struct sen_values *v, uint8_t *status, bool laser)
+{
+  SEN55_GUARD();
 
-  return(SEN55_ERR_OK);
+  uint8_t ret, st;
+
+  ret = GetValues(v, laser);
+
+  // the status is kept in _HealthStatus
+  if (ret == SEN55_ERR_OK && HealthDue(v)) GetStatusReg(&st);
+
+  *status = _HealthStatus;
+
+  return(ret);
+}
+
+/**
+ * @brief : set when the health monitor reads the status register
+ * @param every : read every N samples (0 = only on anomalous values)
+ * @param jump  : change of PM2.5 between samples that is anomalous (0 = no check)
+ */
+void SEN55::SetHealthCheck(uint16_t every, float jump)
+{
+  _HealthEvery = every;
+  _HealthJump = jump;
+  _HealthCnt = 0;
+}
+
+/**
+ * @brief : is it time to read the status register
+ * @param v : new sample
+ *
+ * return : true if the status register should be read now
+ */
+bool SEN55::HealthDue(struct sen_values *v)
+{
+  bool due = Anomalous(v);
+
+  if (_HealthEvery && ++_HealthCnt >= _HealthEvery) due = true;
+
+  if (due) _HealthCnt = 0;
+
+  _HealthPrev = v->MassPM2;
+
+  return(due);
+}
+
+/**
+ * @brief : does a sample look anomalous
+ *
+ * The SEN55 reports 0xFFFF (mass) or 0x7FFF (others) if a value is unknown,
+ * these are far outside the normal ranges below.
+ */
+bool SEN55::Anomalous(struct sen_values *v)
+{
+  // mass concentrations include the smaller sizes
+  if (v->MassPM1 > v->MassPM2 || v->MassPM2 > v->MassPM4 || v->MassPM4 > v->MassPM10) return(true);
+  if (v->MassPM10 > 1000) return(true);
+
+  if (v->Hum < 0 || v->Hum > 100) return(true);
+  if (v->Temp < -40 || v->Temp > 100) return(true);
+  if (v->VOC > 500 || v->NOX > 500) return(true);
+
+  // sudden change
+  if (_HealthJump > 0 && _HealthPrev >= 0) {
+    if (v->MassPM2 - _HealthPrev > _HealthJump || _HealthPrev - v->MassPM2 > _HealthJump) return(true);
+  }
+
+  return(false);
 }
 
 /**
@@ -205,6 +703,8 @@ uint8_t SEN55::GetStatusReg(uint8_t *status) {
  */
 bool SEN55::Instruct(uint16_t type)
 {
+  SEN55_GUARD();
+
   uint8_t ret;
 
   if (type == SEN55_START_FAN_CLEANING)
@@ -216,25 +716,21 @@ bool SEN55::Instruct(uint16_t type)
     }
   }
 
-  I2C_fill_buffer(type);
-
-  ret = I2C_SetPointer();
+  ret = Request(type);
 
   if (ret == SEN55_ERR_OK) {
 
     if (type == SEN55_START_MEASUREMENT || type == SEN55_START_RHTG_MEASUREMENT) {
-      _started = true;
-      delay(1000);            // needs at least 20ms, we give plenty of time
+      Wait(1000);             // needs at least 20ms, we give plenty of time
     }
-    else if (type == SEN55_STOP_MEASUREMENT)
-      _started = false;
-
     else if (type == SEN55_RESET){
-      _started = false;
-      
-      delay(500); //support for UNOR4 (else it will fail)
-      _i2cPort->begin();       // some I2C channels need a reset
-      delay(500); //support for UNOR4
+      Wait(500); //support for UNOR4 (else it will fail)
+      if (! _Replay) {                // some I2C channels need a reset
+        Bus_Lock();
+        _i2cPort->begin();
+        Bus_Unlock();
+      }
+      Wait(500); //support for UNOR4
     }
 
     return(true);
@@ -247,35 +743,42 @@ bool SEN55::Instruct(uint16_t type)
 /**
  * @brief Read version info
  *
+ * The version is read once from the SEN55 and then taken from the cache.
+ *
  * @return
  *  SEN55_ERR_OK = ok
  *  else error
  */
 uint8_t SEN55::GetVersion(struct sen_version *v) {
+  SEN55_GUARD();
+
+  uint8_t ret;
+
+  if (_InvValid & SEN55_INV_VERSION) {
+    memcpy(v, &_Version, sizeof(struct sen_version));
+    return(SEN55_ERR_OK);
+  }
+
+  ret = Read_Version(v);
+
+  return(ret);
+}
+
+/**
+ * @brief Read version info from the SEN55 and update the cache
+ *
+ * @return
+ *  SEN55_ERR_OK = ok
+ *  else error
+ */
+uint8_t SEN55::Read_Version(struct sen_version *v) {
  
   uint8_t ret; 
 
   memset(v, 0x0, sizeof(struct sen_version));
 
-  I2C_fill_buffer(SEN55_READ_VERSION);
-
-  ret = I2C_SetPointer_Read(8,false);
+  ret = Read_Cmd(SEN55_READ_VERSION, v);
 
-  if( ret  == SEN55_ERR_OK) {
-    v->F_major = _Receive_BUF[0];
-    v->F_minor = _Receive_BUF[1];
-    v->F_debug = _Receive_BUF[2];
-    v->H_major = _Receive_BUF[3];
-    v->H_minor = _Receive_BUF[4];
-    v->P_major = _Receive_BUF[5];
-    v->P_minor = _Receive_BUF[6];
-    v->L_major = DRIVER_MAJOR;
-    v->L_minor = DRIVER_MINOR;
-  
-    // internal libary use
-    _FW_Major = v->F_major;
-    _FW_Minor = v->F_minor;
-  }
   return(ret);
 }
 
@@ -289,38 +792,121 @@ uint8_t SEN55::GetVersion(struct sen_version *v) {
  * @param ser     : buffer to hold the read result
  * @param len     : length of the buffer
  *
+ * The complete name / serial number is read and cached (except on 
+ * SMALLFOOTPRINT). Next calls are served from the cache.
+ *
  * return
  *  SEN55_ERR_OK = ok
  *  else error
  */
 uint8_t SEN55::Get_Device_info(uint16_t type, char *ser, uint8_t len)
 {
+  SEN55_GUARD();
+
   uint8_t ret,i;
+  char *cache;
 
-  // Serial or name code
-  if (type == SEN55_READ_SERIAL_NUMBER || type == SEN55_READ_PRODUCT_NAME) {
-    I2C_fill_buffer(type);
+  if (type != SEN55_READ_SERIAL_NUMBER && type != SEN55_READ_PRODUCT_NAME)
+    return(SEN55_ERR_PARAMETER);
 
-    // true = check zero termination
-    ret =  I2C_SetPointer_Read(len,true);
-  }
-  else
-    ret = SEN55_ERR_PARAMETER;
+#ifndef SMALLFOOTPRINT
+  uint8_t flag = (type == SEN55_READ_SERIAL_NUMBER) ? SEN55_INV_SERIAL : SEN55_INV_PRODUCT;
 
-  if (ret == SEN55_ERR_OK) {
-    // get data
-    for (i = 0; i < len ; i++) {
-      ser[i] = _Receive_BUF[i];
-      if (ser[i] == 0x0) break;
-    }
-  }
+  cache = (flag == SEN55_INV_SERIAL) ? _SerialNumber : _ProductName;
 
-  return(ret);
-}
+  if (! (_InvValid & flag)) {
 
-/**
- * @brief : SET the auto clean interval
- * @param val : The new interval value
+    ret = Read_Cmd(type, cache);
+
+    if (ret != SEN55_ERR_OK) return(ret);
+  }
+#else
+  I2C_fill_buffer(type);
+
+  // true = check zero termination
+  ret = I2C_SetPointer_Read(len, true);
+
+  if (ret != SEN55_ERR_OK) return(ret);
+
+  cache = (char *) _Receive_BUF;
+#endif // SMALLFOOTPRINT
+
+  // get data
+  for (i = 0; i < len ; i++) {
+    ser[i] = cache[i];
+    if (ser[i] == 0x0) break;
+  }
+
+  return(SEN55_ERR_OK);
+}
+
+/**
+ * @brief : retrieve the complete identity of the SEN55
+ *
+ * @param inv : structure to hold the inventory record
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  else error
+ */
+uint8_t SEN55::GetInventory(struct sen_inventory *inv)
+{
+  uint8_t ret;
+
+  memset(inv, 0x0, sizeof(struct sen_inventory));
+
+  ret = GetSerialNumber(inv->SerialNumber, SEN55_ID_LENGTH);
+  if (ret != SEN55_ERR_OK) return(ret);
+
+  ret = GetProductName(inv->ProductName, SEN55_ID_LENGTH);
+  if (ret != SEN55_ERR_OK) return(ret);
+
+  return(GetVersion(&inv->Version));
+}
+
+/**
+ * @brief : print the inventory record as a CSV line
+ *
+ * @param out : output to use
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  else error
+ */
+uint8_t SEN55::PrintInventory(Print *out)
+{
+  struct sen_inventory inv;
+  uint8_t ret;
+
+  ret = GetInventory(&inv);
+  if (ret != SEN55_ERR_OK) return(ret);
+
+  out->print(inv.SerialNumber);
+  out->print(',');
+  out->print(inv.ProductName);
+  out->print(',');
+  out->print(inv.Version.F_major);
+  out->print('.');
+  out->print(inv.Version.F_minor);
+  out->print(',');
+  out->print(inv.Version.H_major);
+  out->print('.');
+  out->print(inv.Version.H_minor);
+  out->print(',');
+  out->print(inv.Version.P_major);
+  out->print('.');
+  out->print(inv.Version.P_minor);
+  out->print(',');
+  out->print(inv.Version.L_major);
+  out->print('.');
+  out->println(inv.Version.L_minor);
+
+  return(SEN55_ERR_OK);
+}
+
+/**
+ * @brief : SET the auto clean interval
+ * @param val : The new interval value
  * 6.1.13 Read/Write Auto Cleaning Interval
  * Return:
  *  OK = SEN55_ERR_OK
@@ -328,6 +914,8 @@ uint8_t SEN55::Get_Device_info(uint16_t type, char *ser, uint8_t len)
  */
 uint8_t SEN55::SetAutoCleanInt(uint32_t val)
 {
+  SEN55_GUARD();
+
   bool save_started = false; 
   bool r = true;
 
@@ -337,9 +925,7 @@ uint8_t SEN55::SetAutoCleanInt(uint32_t val)
     save_started = true;
   }
 
-  I2C_fill_buffer(SEN55_SET_AUTO_CLEANING_INTERVAL);
-
-  if (I2C_SetPointer() == SEN55_ERR_OK)
+  if (Request(SEN55_SET_AUTO_CLEANING_INTERVAL, &val) == SEN55_ERR_OK)
   {
     if (save_started) r = start();
 
@@ -351,46 +937,22 @@ uint8_t SEN55::SetAutoCleanInt(uint32_t val)
 
 uint8_t SEN55::GetWarmStart(uint16_t * val)
 {
-  uint8_t ret;
-
-  I2C_fill_buffer(SEN55_WARM_START_PARAM);
-
-  ret = I2C_SetPointer_Read(2);
-
-  // get data
-  *val = byte_to_Uint16_t(0);
-
-  return(ret);
+  return(Read_Cmd(SEN55_WARM_START_PARAM, val));
 }
 
 uint8_t SEN55::SetWarmStart(uint16_t val) {
   
-  data16 = val;
-
-  I2C_fill_buffer(SEN55_SET_WARM_START_PARAM);
-
-  return(I2C_SetPointer());
+  return(Request(SEN55_SET_WARM_START_PARAM, &val));
 }
 
 uint8_t SEN55::GetRHTAccelMode(uint16_t *val){
-  uint8_t ret;
-
-  I2C_fill_buffer(SEN55_RHT_ACCEL);
 
-  ret = I2C_SetPointer_Read(2);
-
-  // get data
-  *val = byte_to_Uint16_t(0);
-
-  return(ret);
+  return(Read_Cmd(SEN55_RHT_ACCEL, val));
 }
   
 uint8_t SEN55::SetRHTAccelMode(uint16_t val) {
-  data16 = val;
-
-  I2C_fill_buffer(SEN55_SET_RHT_ACCEL);
 
-  return(I2C_SetPointer());
+  return(Request(SEN55_SET_RHT_ACCEL, &val));
 }
 
 /**
@@ -405,209 +967,711 @@ uint8_t SEN55::SetRHTAccelMode(uint16_t val) {
  */
 uint8_t SEN55::GetAutoCleanInt(uint32_t *val)
 {
-  uint8_t ret;
-
-  I2C_fill_buffer(SEN55_AUTO_CLEANING_INTERVAL);
-
-  ret = I2C_SetPointer_Read(4);
-
-  // get data
-  *val = byte_to_U32(0);
-
-  return(ret);
+  return(Read_Cmd(SEN55_AUTO_CLEANING_INTERVAL, val));
 }
 
 uint8_t SEN55::GetVocAlgorithmState(uint8_t *table, uint8_t tablesize) {
-  uint8_t ret;
   
   // Check for Voc Algorithm length
   if (tablesize < VOC_ALO_SIZE) return(SEN55_ERR_PARAMETER);
   
-  I2C_fill_buffer(SEN55_VOC_ALGO);
+  return(Read_Cmd(SEN55_VOC_ALGO, table));
+}
 
-  ret = I2C_SetPointer_Read(VOC_ALO_SIZE);
+uint8_t SEN55::GetNoxAlgorithm(sen_xox *nox) {
 
-  // save VOC data
-  for (int i = 0; i < VOC_ALO_SIZE; i++) {
-    table[i] =_Receive_BUF[i];
-  }  
+  return(Read_Cmd(SEN55_NOX_TUNING, nox));
+}
 
-  return(ret);
+uint8_t SEN55::GetVocAlgorithm(sen_xox *voc) {
+
+  return(Read_Cmd(SEN55_VOC_TUNING, voc));
 }
 
-uint8_t SEN55::GetNoxAlgorithm(sen_xox *nox) {
-  uint8_t ret;
+uint8_t SEN55::SetVocAlgorithmState(uint8_t *table, uint8_t tablesize)
+{
+  // Voc Algorithm is 8 bytes ( NOT 10 or 11 as in the datasheet)
+  if (tablesize < VOC_ALO_SIZE) return(SEN55_ERR_PARAMETER);
   
-  I2C_fill_buffer(SEN55_NOX_TUNING);
+  return(Request(SEN55_SET_VOC_ALGO, table));
+}
+
+uint8_t SEN55::SetNoxAlgorithm(sen_xox *nox)
+{
+  return(Request(SEN55_SET_NOX_TUNING, nox));
+}
+
+uint8_t SEN55::SetVocAlgorithm(sen_xox *voc)
+{
+  return(Request(SEN55_SET_VOC_TUNING, voc));
+}
+
+uint8_t SEN55::GetTmpComp(sen_tmp_comp *tmp)
+{
+  return(Read_Cmd(SEN55_TEMP_COMP, tmp));
+}
+
+uint8_t SEN55::SetTmpComp(sen_tmp_comp *tmp)
+{
+  return(Request(SEN55_SET_TEMP_COMP, tmp));
+}
+
+/////////////////////// split transactions ///////////////////////
+/**
+ * @brief : apply limits and scaling of a set-command (as the SetXXX() routine)
+ * @param cmd : SEN55_SET_xxx command
+ * @param val : value to set
+ *
+ * return : value to send (a scaled copy for SEN55_SET_TEMP_COMP, so that
+ * sending the same value again, e.g. by SEN55Queue, does not scale it twice)
+ */
+void *SEN55::Prepare_Set(uint16_t cmd, void *val)
+{
+  struct sen_xox * n = (sen_xox *) val;
+  struct sen_tmp_comp * t = (sen_tmp_comp *) val;
+
+  switch(cmd) {
+
+    case SEN55_SET_AUTO_CLEANING_INTERVAL:
+      data32 = *(uint32_t *) val;
+      break;
+
+    case SEN55_SET_WARM_START_PARAM:
+    case SEN55_SET_RHT_ACCEL:
+      data16 = *(uint16_t *) val;
+      break;
+
+    case SEN55_SET_NOX_TUNING:
+      // MUST be values (according to datasheet))
+      n->LearnTimeGainHours = 12;
+      n->stdInitial = 50;
   
-  ret = I2C_SetPointer_Read(12);
+      // check limits
+      if (n->IndexOffset > 250 || n->IndexOffset < 1) n->IndexOffset = 1;
+      if (n->LearnTimeOffsetHours > 1000 || n->LearnTimeOffsetHours < 1) n->LearnTimeOffsetHours = 12;
+      if (n->GateMaxDurationMin > 3000 || n->GateMaxDurationMin < 1) n->GateMaxDurationMin = 720;
+      if (n->GainFactor > 1000 || n->GainFactor < 1) n->GainFactor = 230;
+      break;
 
-  nox->IndexOffset  = byte_to_int16_t(0) ;
-  nox->LearnTimeOffsetHours  = byte_to_int16_t(2) ;
-  nox->LearnTimeGainHours  = byte_to_int16_t(4) ;
-  nox->GateMaxDurationMin  = byte_to_int16_t(6) ;
-  nox->stdInitial  = byte_to_int16_t(8) ;
-  nox->GainFactor  = byte_to_int16_t(10) ;
+    case SEN55_SET_VOC_TUNING:
+      // check limits (else default according to datasheet)
+      if (n->IndexOffset > 250 || n->IndexOffset < 1) n->IndexOffset = 100;
+      if (n->LearnTimeOffsetHours > 1000 || n->LearnTimeOffsetHours < 1) n->LearnTimeOffsetHours = 12;
+      if (n->LearnTimeGainHours > 1000 || n->LearnTimeGainHours < 1) n->LearnTimeGainHours = 12;
+      if (n->GateMaxDurationMin > 3000 || n->GateMaxDurationMin < 1) n->GateMaxDurationMin = 180;
+      if (n->GateMaxDurationMin > 5000 || n->GateMaxDurationMin < 10) n->GateMaxDurationMin = 50;
+      if (n->GainFactor > 1000 || n->GainFactor < 1) n->GainFactor = 230;
+      break;
 
-  return(ret);
+    case SEN55_SET_TEMP_COMP:
+      // apply scaling
+      datatmp.offset = t->offset * 200;
+      datatmp.slope = t->slope * 1000;
+      datatmp.time = t->time;
+      return(&datatmp);
+  }
+
+  return(val);
 }
 
-uint8_t SEN55::GetVocAlgorithm(sen_xox *voc) {
+/**
+ * @brief : send a command to the SEN55 (first half of a transaction)
+ * @param cmd : SEN55 command
+ * @param val : value for a set-command (else NULL)
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  else error
+ */
+uint8_t SEN55::Request(uint16_t cmd, void *val)
+{
+  SEN55_GUARD();
+
   uint8_t ret;
-  
-  I2C_fill_buffer(SEN55_VOC_TUNING);
-  
-  ret = I2C_SetPointer_Read(12);
 
-  voc->IndexOffset  = byte_to_int16_t(0) ;
-  voc->LearnTimeOffsetHours  = byte_to_int16_t(2) ;
-  voc->LearnTimeGainHours  = byte_to_int16_t(4) ;
-  voc->GateMaxDurationMin  = byte_to_int16_t(6) ;
-  voc->stdInitial  = byte_to_int16_t(8) ;
-  voc->GainFactor  = byte_to_int16_t(10) ;
+  if (cmd >= SEN55_SET_VOC_TUNING && cmd <= SEN55_SET_AUTO_CLEANING_INTERVAL) {
+    if (val == NULL) return(SEN55_ERR_PARAMETER);
+    val = Prepare_Set(cmd, val);
+  }
 
-  return(ret);
+  I2C_fill_buffer(cmd, val);
+
+  ret = I2C_SetPointer();
+
+#ifdef SEN55_STATISTICS
+  Stat_Count(true, ret);
+#endif
+
+  if (ret != SEN55_ERR_OK) return(ret);
+
+  if (cmd == SEN55_START_MEASUREMENT || cmd == SEN55_START_RHTG_MEASUREMENT) {
+    _started = true;
+    _Laser = (cmd == SEN55_START_MEASUREMENT);
+  }
+  else if (cmd == SEN55_STOP_MEASUREMENT || cmd == SEN55_RESET)
+    _started = false;
+
+  return(SEN55_ERR_OK);
 }
 
-uint8_t SEN55::SetVocAlgorithmState(uint8_t *table, uint8_t tablesize)
+/**
+ * @brief : minimum time between Request() and Collect() (or the next command)
+ * @param cmd : SEN55 command
+ *
+ * return : mS to wait
+ */
+uint32_t SEN55::RequestDelay(uint16_t cmd)
 {
-  // Voc Algorithm is 8 bytes ( NOT 10 or 11 as in the datasheet)
-  if (tablesize < VOC_ALO_SIZE) return(SEN55_ERR_PARAMETER);
-  
-  I2C_fill_buffer(SEN55_SET_VOC_ALGO, table);
+  switch(cmd) {
+    case SEN55_START_MEASUREMENT:
+    case SEN55_START_RHTG_MEASUREMENT:
+    case SEN55_RESET:
+      return(1000);             // as Instruct()
+    case SEN55_STOP_MEASUREMENT:
+      return(200);              // execution time datasheet
+  }
+
+  if (Answer_Len(cmd) > 0) return(5);   // as I2C_SetPointer_Read()
 
-  return(I2C_SetPointer());
+  return(20);                   // execution time datasheet
 }
 
-uint8_t SEN55::SetNoxAlgorithm(sen_xox *nox)
+/**
+ * @brief : read the answer of a command (second half of a transaction)
+ * @param cmd    : SEN55 command that was requested
+ * @param result : to hold the answer (NULL for commands without answer)
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  else error
+ */
+uint8_t SEN55::Collect(uint16_t cmd, void *result)
 {
-  // MUST be values (according to datasheet))
-  nox->LearnTimeGainHours = 12;
-  nox->stdInitial = 50;
+  SEN55_GUARD();
+
+  uint8_t ret, len = Answer_Len(cmd);
+
+  if (len == 0) {
+    // some I2C channels need a reset
+    if (cmd == SEN55_RESET && ! _Replay) {
+      Bus_Lock();
+      _i2cPort->begin();
+      Bus_Unlock();
+    }
+    return(SEN55_ERR_OK);
+  }
+
+  if (result == NULL) return(SEN55_ERR_PARAMETER);
+
+  ret = I2C_ReadToBuffer(len, cmd == SEN55_READ_SERIAL_NUMBER || cmd == SEN55_READ_PRODUCT_NAME);
+
+#ifdef SEN55_STATISTICS
+  Stat_Count(false, ret);           // counted by Request()
+#endif
+
+  if (ret != SEN55_ERR_OK) return(ret);
+
+  return(Decode(cmd, result));
+}
+
+/**
+ * @brief : number of data bytes in the answer of a command
+ * @param cmd : SEN55 command
+ *
+ * return : data bytes, 0 if no answer
+ */
+uint8_t SEN55::Answer_Len(uint16_t cmd)
+{
+  switch(cmd) {
+    case SEN55_READ_DATA_RDY_FLAG:      return(2);
+    case SEN55_READ_MEASURED_VALUE:     return(16);
+    case SEN55_READ_MEASURED_VALUE_PM:  return(20);
+    case SEN55_TEMP_COMP:               return(6);
+    case SEN55_WARM_START_PARAM:        return(2);
+    case SEN55_VOC_TUNING:              return(12);
+    case SEN55_NOX_TUNING:              return(12);
+    case SEN55_RHT_ACCEL:               return(2);
+    case SEN55_VOC_ALGO:                return(VOC_ALO_SIZE);
+    case SEN55_AUTO_CLEANING_INTERVAL:  return(4);
+    case SEN55_READ_PRODUCT_NAME:
+    case SEN55_READ_SERIAL_NUMBER:      return(SEN55_ID_LENGTH);
+    case SEN55_READ_VERSION:            return(8);
+    case SEN55_READ_DEVICE_REGISTER:    return(4);
+  }
+
+  return(0);
+}
+
+/**
+ * @brief : complete read transaction (request, wait and collect)
+ * @param cmd    : SEN55 read command
+ * @param result : to hold the answer
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  else error
+ */
+uint8_t SEN55::Read_Cmd(uint16_t cmd, void *result)
+{
+  SEN55_GUARD();
+
+  uint8_t ret;
+
+  I2C_fill_buffer(cmd);
+
+  // true = check zero termination
+  ret = I2C_SetPointer_Read(Answer_Len(cmd), cmd == SEN55_READ_SERIAL_NUMBER || cmd == SEN55_READ_PRODUCT_NAME);
+
+  if (ret != SEN55_ERR_OK) return(ret);
+
+  return(Decode(cmd, result));
+}
+
+/**
+ * @brief : translate _Receive_BUF to the answer of a command
+ * @param cmd    : SEN55 read command
+ * @param result : to hold the answer
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  SEN55_ERR_OUTOFRANGE : status register shows issues
+ *  SEN55_ERR_PARAMETER  : not a read command
+ */
+uint8_t SEN55::Decode(uint16_t cmd, void *result)
+{
+  uint8_t i;
+  uint8_t *status = (uint8_t *) result;
+  struct sen_xox *n = (sen_xox *) result;
+  struct sen_tmp_comp *t = (sen_tmp_comp *) result;
+  struct sen_version *v = (sen_version *) result;
+  struct sen_values_pm *pm = (sen_values_pm *) result;
+  char *str = (char *) result;
+
+  switch(cmd) {
+
+    case SEN55_READ_DATA_RDY_FLAG:
+      *(bool *) result = (_Receive_BUF[1] == 1);
+      break;
+
+    case SEN55_READ_MEASURED_VALUE:
+      Decode_Values((sen_values *) result, _Laser);
+      break;
+
+    case SEN55_READ_MEASURED_VALUE_PM:
+      memset(pm,0x0,sizeof(struct sen_values_pm));
+
+      pm->MassPM1 = (float)((byte_to_Uint16_t(0)) / (float) 10);
+      pm->MassPM2 = (float)((byte_to_Uint16_t(2)) / (float) 10);
+      pm->MassPM4 = (float)((byte_to_Uint16_t(4)) / (float) 10);
+      pm->MassPM10 =(float)((byte_to_Uint16_t(6)) / (float) 10);
+      pm->NumPM0 =  (float)((byte_to_Uint16_t(8)) / (float) 10);
+      pm->NumPM1 =  (float)((byte_to_Uint16_t(10)) / (float) 10);
+      pm->NumPM2 =  (float)((byte_to_Uint16_t(12)) / (float) 10);
+      pm->NumPM4 =  (float)((byte_to_Uint16_t(14)) / (float) 10);
+      pm->NumPM10 = (float)((byte_to_Uint16_t(16)) / (float) 10);
+      pm->PartSize =(float)((byte_to_Uint16_t(18)) / (float) 1000);
+      break;
+
+    case SEN55_WARM_START_PARAM:
+    case SEN55_RHT_ACCEL:
+      *(uint16_t *) result = byte_to_Uint16_t(0);
+      break;
+
+    case SEN55_AUTO_CLEANING_INTERVAL:
+      *(uint32_t *) result = byte_to_U32(0);
+      break;
+
+    case SEN55_VOC_ALGO:
+      memcpy(result, _Receive_BUF, VOC_ALO_SIZE);
+      break;
+
+    case SEN55_NOX_TUNING:
+    case SEN55_VOC_TUNING:
+      n->IndexOffset  = byte_to_int16_t(0) ;
+      n->LearnTimeOffsetHours  = byte_to_int16_t(2) ;
+      n->LearnTimeGainHours  = byte_to_int16_t(4) ;
+      n->GateMaxDurationMin  = byte_to_int16_t(6) ;
+      n->stdInitial  = byte_to_int16_t(8) ;
+      n->GainFactor  = byte_to_int16_t(10) ;
+      break;
+
+    case SEN55_TEMP_COMP:
+      // get values and apply scaling
+      t->offset = byte_to_int16_t(0) / 200 ;
+      t->slope  = byte_to_int16_t(2) / 1000;
+      t->time   = byte_to_Uint16_t(4) ;
+      break;
+
+    case SEN55_READ_PRODUCT_NAME:
+    case SEN55_READ_SERIAL_NUMBER:
+      for (i = 0; i < SEN55_ID_LENGTH && i < _Receive_BUF_Length; i++) {
+        str[i] = _Receive_BUF[i];
+        if (str[i] == 0x0) break;
+      }
+      str[i] = 0x0;
+
+#ifndef SMALLFOOTPRINT
+      // filled the identity cache ?
+      if (str == _SerialNumber) _InvValid |= SEN55_INV_SERIAL;
+      else if (str == _ProductName) _InvValid |= SEN55_INV_PRODUCT;
+#endif
+      break;
+
+    case SEN55_READ_VERSION:
+      v->F_major = _Receive_BUF[0];
+      v->F_minor = _Receive_BUF[1];
+      v->F_debug = _Receive_BUF[2];
+      v->H_major = _Receive_BUF[3];
+      v->H_minor = _Receive_BUF[4];
+      v->P_major = _Receive_BUF[5];
+      v->P_minor = _Receive_BUF[6];
+      v->L_major = DRIVER_MAJOR;
+      v->L_minor = DRIVER_MINOR;
   
-  // check limits
-  if (nox->IndexOffset > 250 || nox->IndexOffset < 1) nox->IndexOffset = 1;
-  if (nox->LearnTimeOffsetHours > 1000 || nox->LearnTimeOffsetHours < 1) nox->LearnTimeOffsetHours = 12;
-  if (nox->GateMaxDurationMin > 3000 || nox->GateMaxDurationMin < 1) nox->GateMaxDurationMin = 720;
-  if (nox->GainFactor > 1000 || nox->GainFactor < 1) nox->GainFactor = 230;
+      // internal libary use
+      _FW_Major = v->F_major;
+      _FW_Minor = v->F_minor;
+
+      memcpy(&_Version, v, sizeof(struct sen_version));
+      _InvValid |= SEN55_INV_VERSION;
+      break;
+
+    case SEN55_READ_DEVICE_REGISTER:
+      *status = STATUS_OK_55;
+
+      if (_Receive_BUF[1] & 0b00100000) *status |= STATUS_SPEED_ERROR_55;
+      if (_Receive_BUF[3] & 0b10000000) *status |= STATUS_GAS_ERROR_55;
+      if (_Receive_BUF[3] & 0b01000000) *status |= STATUS_RHT_ERROR_55;
+      if (_Receive_BUF[3] & 0b00100000) *status |= STATUS_LASER_ERROR_55;
+      if (_Receive_BUF[3] & 0b00010000) *status |= STATUS_FAN_ERROR_55;
   
-  I2C_fill_buffer(SEN55_SET_NOX_TUNING, nox);
+      if (*status != STATUS_OK_55) {
+        _HealthStatus = *status;
+        return(SEN55_ERR_OUTOFRANGE);
+      }
   
-  return(I2C_SetPointer());
+      // NO errors, now add / check that fan clean is active
+      if (_Receive_BUF[1] & 0b00001000) *status = STATUS_FAN_CLEAN_ACTIVE_55;
+      _HealthStatus = *status;
+      break;
 
+    default:
+      return(SEN55_ERR_PARAMETER);
+  }
+
+  return(SEN55_ERR_OK);
 }
 
-uint8_t SEN55::SetVocAlgorithm(sen_xox *voc)
+/**
+ * @brief : get error description
+ * @param code : error code
+ * @param buf  : buffer to store the description
+ * @param len  : length of buffer
+ */
+void SEN55::GetErrDescription(uint8_t code, char *buf, int len)
 {
-  // check limits (else default according to datasheet)
-  if (voc->IndexOffset > 250 || voc->IndexOffset < 1) voc->IndexOffset = 100;
-  if (voc->LearnTimeOffsetHours > 1000 || voc->LearnTimeOffsetHours < 1) voc->LearnTimeOffsetHours = 12;
-  if (voc->LearnTimeGainHours > 1000 || voc->LearnTimeGainHours < 1) voc->LearnTimeGainHours = 12;
-  if (voc->GateMaxDurationMin > 3000 || voc->GateMaxDurationMin < 1) voc->GateMaxDurationMin = 180;
-  if (voc->GateMaxDurationMin > 5000 || voc->GateMaxDurationMin < 10) voc->GateMaxDurationMin = 50;
-  if (voc->GainFactor > 1000 || voc->GainFactor < 1) voc->GainFactor = 230;
-  
-  I2C_fill_buffer(SEN55_SET_VOC_TUNING, voc);
-  
-  return(I2C_SetPointer());
+
+#if defined SMALLFOOTPRINT
+  strncpy(buf, "Error-info not disabled", len);
+#else
+  int i=0;
+
+  while (SEN55_ERR_desc[i].code != 0xff) {
+      if(SEN55_ERR_desc[i].code == code)  break;
+      i++;
+  }
+
+  strncpy(buf, SEN55_ERR_desc[i].desc, len);
+#endif // SMALLFOOTPRINT
 }
 
-uint8_t SEN55::GetTmpComp(sen_tmp_comp *tmp)
+/**
+ * @brief : read all values from the sensor and store in structure
+ * @param : pointer to structure to store
+ *
+ * return
+ *  SEN55_ERR_OK = ok
+ *  else error
+ */
+uint8_t SEN55::GetValues(struct sen_values *v,  bool laser)
 {
+  SEN55_GUARD();
+
   uint8_t ret;
+
+  // measurement started already?
+  if ( ! _started ) {
+    if (laser) {
+      if ( ! start() ) return(SEN55_ERR_CMDSTATE);
+    }
+    else {
+      // NO laser
+      if (! startRHTG() ) return(SEN55_ERR_CMDSTATE);
+    }
+    Wait(100);
+  }
   
-  I2C_fill_buffer(SEN55_TEMP_COMP);
+  I2C_fill_buffer(SEN55_READ_MEASURED_VALUE);
   
-  ret = I2C_SetPointer_Read(6);
+  ret = I2C_SetPointer_Read(16);
+
+  if (ret != SEN55_ERR_OK) return (ret);
+
+  Decode_Values(v, laser);
+ 
+  return(SEN55_ERR_OK);
+}
+
+/**
+ * @brief : translate _Receive_BUF to measurement values
+ * @param v     : pointer to structure to store
+ * @param laser : true include mass values
+ */
+void SEN55::Decode_Values(struct sen_values *v, bool laser)
+{
+  memset(v,0x0,sizeof(struct sen_values));
+
+  // get data
+  if (laser) {
+    v->MassPM1 = (float)((byte_to_Uint16_t(0)) / (float) 10);
+    v->MassPM2 = (float)((byte_to_Uint16_t(2)) / (float) 10);
+    v->MassPM4 = (float)((byte_to_Uint16_t(4)) / (float) 10);
+    v->MassPM10 =(float)((byte_to_Uint16_t(6)) / (float) 10);
+  }
+  v->Hum =  (float)((byte_to_int16_t(8)) / (float) 100);       // Compensated Ambient Humidity [%RH]
+  v->Temp = (float)((byte_to_int16_t(10)) / (float) 200);      // Compensated Ambient Temperature [°C]
+  v->VOC =  (float)((byte_to_int16_t(12)) / (float) 10);       // VOC Index
+  v->NOX =  (float)((byte_to_int16_t(14)) / (float) 10);       // NOx Index
+
+#ifdef SEN55_LATEST
+  if (_Latest) _Latest->Store(v, Millis());
+#endif
+}
+
+/////////////////////// non-blocking mode ////////////////////////
+/**
+ * @brief : start non-blocking measurement (see poll())
+ * @param interval : milliseconds between reading values (min. 1000)
+ * @param laser    : true : mass and RHTG, false : RHTG only
+ */
+void SEN55::PollStart(uint32_t interval, bool laser)
+{
+  _PollInterval = interval < 1000 ? 1000 : interval;
+  _PollLaser = laser;
+  _PollNew = false;
+  _PollDue = _PollCycle = Millis();
+  _PollState = SEN55_POLL_START;
+}
+
+/**
+ * @brief : stop non-blocking measurement (the SEN55 keeps measuring)
+ */
+void SEN55::PollStop()
+{
+  _PollState = SEN55_POLL_OFF;
+}
+
+/**
+ * @brief : perform the next step of the non-blocking measurement
+ *
+ * Each call performs at most one I2C transfer and never waits.
+ *
+ * return :
+ *  true  : new values are available
+ *  false : no new values (yet)
+ */
+bool SEN55::poll()
+{
+  SEN55_GUARD();
+
+  uint32_t now = Millis();
+  uint8_t ret;
+
+  if (_PollState == SEN55_POLL_OFF) return(false);
+
+  // time for next step?
+  if ((int32_t) (now - _PollDue) < 0) return(false);
+
+  switch(_PollState) {
+
+    case SEN55_POLL_START:
+      if (! _started) {
+        ret = Request(_PollLaser ? SEN55_START_MEASUREMENT : SEN55_START_RHTG_MEASUREMENT);
+        _PollDue = now + 1000;        // needs at least 20ms, we give plenty of time
+        _PollCycle = _PollDue;
+
+        // e.g. still powering up : send start again
+        if (ret != SEN55_ERR_OK) break;
+      }
+      _PollState = SEN55_POLL_READY_SET;
+      break;
+
+    case SEN55_POLL_READY_SET:
+      I2C_fill_buffer(SEN55_READ_DATA_RDY_FLAG);
+      ret = I2C_SetPointer();
+#ifdef SEN55_STATISTICS
+      Stat_Count(true, ret);
+#endif
+
+      if (ret != SEN55_ERR_OK) {
+        _PollDue = now + 100;
+        break;
+      }
+
+      _PollDue = now + 5;
+      _PollState = SEN55_POLL_READY_GET;
+      break;
+
+    case SEN55_POLL_READY_GET:
+      ret = I2C_ReadToBuffer(2, false);
+#ifdef SEN55_STATISTICS
+      Stat_Count(false, ret);
+#endif
+
+      if (ret == SEN55_ERR_OK && _Receive_BUF[1] == 1) {
+        _PollState = SEN55_POLL_VALUES_SET;
+      }
+      else {
+        // not ready (or error) : check again
+        _PollDue = now + 100;
+        _PollState = SEN55_POLL_READY_SET;
+      }
+      break;
+
+    case SEN55_POLL_VALUES_SET:
+      I2C_fill_buffer(SEN55_READ_MEASURED_VALUE);
+      ret = I2C_SetPointer();
+#ifdef SEN55_STATISTICS
+      Stat_Count(true, ret);
+#endif
+
+      if (ret != SEN55_ERR_OK) {
+        _PollDue = now + 100;
+        _PollState = SEN55_POLL_READY_SET;
+        break;
+      }
+
+      _PollDue = now + 5;
+      _PollState = SEN55_POLL_VALUES_GET;
+      break;
+
+    case SEN55_POLL_VALUES_GET:
+      ret = I2C_ReadToBuffer(16, false);
+#ifdef SEN55_STATISTICS
+      Stat_Count(false, ret);
+#endif
+
+      if (ret != SEN55_ERR_OK) {
+        _PollDue = now + 100;
+        _PollState = SEN55_POLL_READY_SET;
+        break;
+      }
+
+      Decode_Values(&_PollVal, _PollLaser);
+      _PollNew = true;
+
+      // next cycle, start again from now if too far behind
+      _PollCycle += _PollInterval;
+      if ((int32_t) (now - _PollCycle) > (int32_t) _PollInterval) _PollCycle = now;
+      _PollDue = _PollCycle;
+      _PollState = SEN55_POLL_READY_SET;
+
+      if (_PollCb) _PollCb(&_PollVal);
+      return(true);
+  }
+
+  return(false);
+}
+
+/**
+ * @brief : get the values read in non-blocking mode
+ * @param v : pointer to structure to store
+ *
+ * return
+ *  SEN55_ERR_OK = ok, new values
+ *  SEN55_ERR_CMDSTATE : no new values since last call
+ */
+uint8_t SEN55::GetPollValues(struct sen_values *v)
+{
+  SEN55_GUARD();
+
+  if (! _PollNew) return(SEN55_ERR_CMDSTATE);
+
+  memcpy(v, &_PollVal, sizeof(struct sen_values));
+  _PollNew = false;
+
+  return(SEN55_ERR_OK);
+}
 
-  // get values and apply scaling
-  tmp->offset = byte_to_int16_t(0) / 200 ;
-  tmp->slope  = byte_to_int16_t(2) / 1000;
-  tmp->time   = byte_to_Uint16_t(4) ;
+#ifdef SEN55_LATEST
+/////////////////////// latest sample cell ///////////////////////
 
-  return(ret);
-}
+static_assert(sizeof(struct sen_values) == (SEN55_LATEST_WORDS - 1) * sizeof(uint32_t),
+  "SEN55_LATEST_WORDS does not match struct sen_values");
 
-uint8_t SEN55::SetTmpComp(sen_tmp_comp *tmp)
+SEN55Latest::SEN55Latest()
 {
-  // apply scaling
-  tmp->offset = tmp->offset * 200;
-  tmp->slope = tmp->slope * 1000;
-
-  I2C_fill_buffer(SEN55_SET_TEMP_COMP, tmp);
-  
-  return(I2C_SetPointer());
+  _Seq.store(0, std::memory_order_relaxed);
+  for (uint8_t i = 0; i < SEN55_LATEST_WORDS; i++) _Data[i].store(0, std::memory_order_relaxed);
 }
 
 /**
- * @brief : get error description
- * @param code : error code
- * @param buf  : buffer to store the description
- * @param len  : length of buffer
+ * @brief : store a new sample
+ *
+ * The sequence is odd while the words are written, a reader that sees an odd
+ * or changed sequence will try again.
  */
-void SEN55::GetErrDescription(uint8_t code, char *buf, int len)
+void SEN55Latest::Store(struct sen_values *v, uint32_t stamp)
 {
+  uint32_t w[SEN55_LATEST_WORDS];
+  uint32_t seq = _Seq.load(std::memory_order_relaxed);
+  uint8_t i;
 
-#if defined SMALLFOOTPRINT
-  strncpy(buf, "Error-info not disabled", len);
-#else
-  int i=0;
+  memcpy(w, v, sizeof(struct sen_values));
+  w[SEN55_LATEST_WORDS - 1] = stamp;
 
-  while (SEN55_ERR_desc[i].code != 0xff) {
-      if(SEN55_ERR_desc[i].code == code)  break;
-      i++;
-  }
+  _Seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
 
-  strncpy(buf, SEN55_ERR_desc[i].desc, len);
-#endif // SMALLFOOTPRINT
+  for (i = 0; i < SEN55_LATEST_WORDS; i++) _Data[i].store(w[i], std::memory_order_relaxed);
+
+  _Seq.store(seq + 2, std::memory_order_release);
 }
 
 /**
- * @brief : read all values from the sensor and store in structure
- * @param : pointer to structure to store
- *
- * return
- *  SEN55_ERR_OK = ok
- *  else error
+ * @brief : get a copy of the latest sample
  */
-uint8_t SEN55::GetValues(struct sen_values *v,  bool laser)
+uint8_t SEN55Latest::Load(struct sen_values *v, uint32_t *stamp, uint32_t *count)
 {
-  uint8_t ret;
+  uint32_t w[SEN55_LATEST_WORDS];
+  uint32_t seq1, seq2;
+  uint8_t i, tries;
 
-  // measurement started already?
-  if ( ! _started ) {
-    if (laser) {
-      if ( ! start() ) return(SEN55_ERR_CMDSTATE);
-    }
-    else {
-      // NO laser
-      if (! startRHTG() ) return(SEN55_ERR_CMDSTATE);
-    }
-    delay(100);
-  }
-  
-  I2C_fill_buffer(SEN55_READ_MEASURED_VALUE);
-  
-  ret = I2C_SetPointer_Read(16);
+  for (tries = 0; tries < SEN55_LATEST_TRIES; tries++) {
 
-  if (ret != SEN55_ERR_OK) return (ret);
+    seq1 = _Seq.load(std::memory_order_acquire);
 
-  memset(v,0x0,sizeof(struct sen_values));
+    if (seq1 == 0) return(SEN55_ERR_CMDSTATE);
 
-  // get data
-  if (laser) {
-    v->MassPM1 = (float)((byte_to_Uint16_t(0)) / (float) 10);
-    v->MassPM2 = (float)((byte_to_Uint16_t(2)) / (float) 10);
-    v->MassPM4 = (float)((byte_to_Uint16_t(4)) / (float) 10);
-    v->MassPM10 =(float)((byte_to_Uint16_t(6)) / (float) 10);
+    // being stored
+    if (seq1 & 1) continue;
+
+    for (i = 0; i < SEN55_LATEST_WORDS; i++) w[i] = _Data[i].load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    seq2 = _Seq.load(std::memory_order_relaxed);
+
+    if (seq1 == seq2) {
+      memcpy(v, w, sizeof(struct sen_values));
+      if (stamp) *stamp = w[SEN55_LATEST_WORDS - 1];
+      if (count) *count = seq1 / 2;
+      return(SEN55_ERR_OK);
+    }
   }
-  v->Hum =  (float)((byte_to_int16_t(8)) / (float) 100);       // Compensated Ambient Humidity [%RH]
-  v->Temp = (float)((byte_to_int16_t(10)) / (float) 200);      // Compensated Ambient Temperature [°C]
-  v->VOC =  (float)((byte_to_int16_t(12)) / (float) 10);       // VOC Index
-  v->NOX =  (float)((byte_to_int16_t(14)) / (float) 10);       // NOx Index
- 
-  return(SEN55_ERR_OK);
+
+  return(SEN55_ERR_TIMEOUT);
 }
+#endif // SEN55_LATEST
 
 /**
  * @brief : read all mass, num and partsize values from the sensor and store in structure
@@ -620,34 +1684,14 @@ uint8_t SEN55::GetValues(struct sen_values *v,  bool laser)
  */
 uint8_t SEN55::GetValuesPM(struct sen_values_pm *v)
 {
-  uint8_t ret;
+  SEN55_GUARD();
 
   // measurement started already?
   if ( ! _started ) {
     if ( ! start() ) return(SEN55_ERR_CMDSTATE);
   }
 
-  I2C_fill_buffer(SEN55_READ_MEASURED_VALUE_PM);
-  
-  ret = I2C_SetPointer_Read(20);
-
-  if (ret != SEN55_ERR_OK) return (ret);
-
-  memset(v,0x0,sizeof(struct sen_values_pm));
-
-  // get data
-  v->MassPM1 = (float)((byte_to_Uint16_t(0)) / (float) 10);
-  v->MassPM2 = (float)((byte_to_Uint16_t(2)) / (float) 10);
-  v->MassPM4 = (float)((byte_to_Uint16_t(4)) / (float) 10);
-  v->MassPM10 =(float)((byte_to_Uint16_t(6)) / (float) 10);
-  v->NumPM0 =  (float)((byte_to_Uint16_t(8)) / (float) 10);
-  v->NumPM1 =  (float)((byte_to_Uint16_t(10)) / (float) 10);
-  v->NumPM2 =  (float)((byte_to_Uint16_t(12)) / (float) 10);
-  v->NumPM4 =  (float)((byte_to_Uint16_t(14)) / (float) 10);
-  v->NumPM10 = (float)((byte_to_Uint16_t(16)) / (float) 10);
-  v->PartSize =(float)((byte_to_Uint16_t(18)) / (float) 1000);
- 
-  return(SEN55_ERR_OK);
+  return(Read_Cmd(SEN55_READ_MEASURED_VALUE_PM, v));
 }
 
 ////////////////// convert routines ///////////////////////////////
@@ -701,6 +1745,77 @@ int16_t SEN55::byte_to_int16_t(int x)
   return conv;
 }
 
+/************************************************************
+ * shared bus and locks
+ *************************************************************/
+
+SEN55Mutex::SEN55Mutex()
+{
+#if SEN55_THREADS == 1
+  _Mutex = xSemaphoreCreateRecursiveMutex();
+#endif
+}
+
+SEN55Mutex::~SEN55Mutex()
+{
+#if SEN55_THREADS == 1
+  vSemaphoreDelete(_Mutex);
+#endif
+}
+
+/**
+ * @brief : take the lock
+ * @return : true if the lock was free, false if we had to wait
+ */
+bool SEN55Mutex::Lock()
+{
+#if SEN55_THREADS == 1
+  if (xSemaphoreTakeRecursive(_Mutex, 0) == pdTRUE) return(true);
+  xSemaphoreTakeRecursive(_Mutex, portMAX_DELAY);
+  return(false);
+#elif SEN55_THREADS == 2
+  if (_Mutex.try_lock()) return(true);
+  _Mutex.lock();
+  return(false);
+#else
+  return(true);
+#endif
+}
+
+void SEN55Mutex::Unlock()
+{
+#if SEN55_THREADS == 1
+  xSemaphoreGiveRecursive(_Mutex);
+#elif SEN55_THREADS == 2
+  _Mutex.unlock();
+#endif
+}
+
+SEN55Bus::SEN55Bus(TwoWire *port)
+{
+  _Port = port;
+  _Locks = _Waits = 0;
+}
+
+void SEN55Bus::Lock()
+{
+  if (! _Mutex.Lock()) _Waits++;
+  _Locks++;
+}
+
+void SEN55Bus::GetUsage(uint32_t *locks, uint32_t *waits, bool reset)
+{
+  Lock();
+
+  // do not count this call
+  *locks = _Locks - 1;
+  *waits = _Waits;
+
+  if (reset) _Locks = _Waits = 0;
+
+  Unlock();
+}
+
 /************************************************************
  * I2C routines
  *************************************************************/
@@ -751,13 +1866,13 @@ void SEN55::I2C_fill_buffer(uint16_t cmd, void *val)
       _Send_BUF[i++] = SEN55_VOC_ALGO >> 8 & 0xff;   //0 MSB
       _Send_BUF[i++] = SEN55_VOC_ALGO & 0xff;        //1 LSB
       
-      for (int j = 0, k = 0 ; j < VOC_ALO_SIZE;) {
+      // CRC after each 2 data bytes
+      for (int j = 0 ; j < VOC_ALO_SIZE;) {
         _Send_BUF[i++] = vv[j++] & 0xff;
 
-        if (k++ > 2) {
-          uint8_t st = i - j;
-          _Send_BUF[i++] = I2C_calc_CRC(&_Send_BUF[st]); //CRC
-          k = 0;
+        if ((j & 1) == 0) {
+          _Send_BUF[i] = I2C_calc_CRC(&_Send_BUF[i - 2]); //CRC
+          i++;
         }
       }
       break;
@@ -869,16 +1984,41 @@ uint8_t SEN55::I2C_SetPointer()
 {
   if (_Send_BUF_Length == 0) return(SEN55_ERR_DATALENGTH);
 
+  uint8_t wr;
+
+#ifndef SEN55_NO_DEBUG_TEXT
   if (_SEN55_Debug) {
     DebugPrintf("I2C Sending: ");
     for(byte i = 0; i < _Send_BUF_Length; i++)
       DebugPrintf(" 0x%02X", _Send_BUF[i]);
     DebugPrintf("\n");
   }
+#endif
+
+  if (_Replay) {
+    uint8_t raw[MAXBUFLENGTH], len;
+
+    wr = Replay_Frame(SEN55_TRACE_WRITE, raw, &len);
+
+    if (wr == SEN55_REPLAY_END || len != _Send_BUF_Length || memcmp(raw, _Send_BUF, len) != 0) {
+      DebugPrintf("Replay: write frame does not match\n");
+      return(SEN55_ERR_PROTOCOL);
+    }
+  }
+  else {
+    Bus_Lock();
+    _i2cPort->beginTransmission(SEN55_ADDRESS);
+    _i2cPort->write(_Send_BUF, _Send_BUF_Length);
+    wr = _i2cPort->endTransmission();
+    Bus_Unlock();
+  }
+
+  Trace(SEN55_TRACE_WRITE, wr, _Send_BUF, _Send_BUF_Length);
 
-  _i2cPort->beginTransmission(SEN55_ADDRESS);
-  _i2cPort->write(_Send_BUF, _Send_BUF_Length);
-  _i2cPort->endTransmission();
+  if (wr != 0) {
+    DebugPrintf("I2C write failed: %d\n", wr);
+    return(SEN55_ERR_PROTOCOL);
+  }
 
   return(SEN55_ERR_OK);
 }
@@ -893,29 +2033,67 @@ uint8_t SEN55::I2C_SetPointer()
  */
 uint8_t SEN55::I2C_SetPointer_Read(uint8_t cnt, bool chk_zero)
 {
-  uint8_t ret;
+  uint8_t ret, retry = 0;
+#ifdef SEN55_STATISTICS
+  uint32_t st_time, b;
+  uint8_t bucket;
+#endif
 
-  // set pointer
-  ret = I2C_SetPointer();
-  
-  if (ret != SEN55_ERR_OK) {
-    DebugPrintf("Can not set pointer\n");
-    return(ret);
-  }
+  while (1) {
+
+#ifdef SEN55_STATISTICS
+    st_time = Micros();
+#endif
+
+    // set pointer
+    ret = I2C_SetPointer();
   
-  // could not get it to work on UNOR4 without this delay.
-  delay(5);
+    if (ret != SEN55_ERR_OK) {
+      DebugPrintf("Can not set pointer\n");
+    }
+    else {
+      // could not get it to work on UNOR4 without this delay.
+      Wait(5);
   
-  // read from Sensor
-  ret = I2C_ReadToBuffer(cnt, chk_zero);
+      // read from Sensor
+      ret = I2C_ReadToBuffer(cnt, chk_zero);
 
-  if (_SEN55_Debug) {
-    DebugPrintf("I2C Received: ");
-    for(byte i = 0; i < _Receive_BUF_Length; i++)
-      DebugPrintf("0x%02X ",_Receive_BUF[i]);
-    DebugPrintf("length: %d\n\n",_Receive_BUF_Length);
+#ifdef SEN55_STATISTICS
+      struct sen_cmd_stats *st = Stat_Cmd();
+
+      if (st) {
+        st_time = Micros() - st_time;
+        if (st_time > st->max_us) st->max_us = st_time;
+
+        // log2 bucket
+        for (b = st_time >> 11, bucket = 0; b && bucket < SEN55_LAT_BUCKETS - 1; b >>= 1) bucket++;
+        st->latency[bucket]++;
+      }
+#endif
+
+#ifndef SEN55_NO_DEBUG_TEXT
+      if (_SEN55_Debug) {
+        DebugPrintf("I2C Received: ");
+        for(byte i = 0; i < _Receive_BUF_Length; i++)
+          DebugPrintf("0x%02X ",_Receive_BUF[i]);
+        DebugPrintf("length: %d\n\n",_Receive_BUF_Length);
+      }
+#endif
+    }
+
+    if (ret == SEN55_ERR_OK || retry++ >= _Retry) break;
+
+    DebugPrintf("Retry I2C transaction\n");
+#ifdef SEN55_STATISTICS
+    _Stats.retries++;
+#endif
   }
 
+  // one transaction, however many attempts
+#ifdef SEN55_STATISTICS
+  Stat_Count(true, ret);
+#endif
+
   if (ret != SEN55_ERR_OK) {
     DebugPrintf("Error during reading from I2C: 0x%02X\n", ret);
   }
@@ -936,10 +2114,10 @@ uint8_t SEN55::I2C_SetPointer_Read(uint8_t cnt, bool chk_zero)
  */
 uint8_t SEN55::I2C_ReadToBuffer(uint8_t count, bool chk_zero)
 {
-  uint8_t data[3];
-  uint8_t i, j, exp_cnt, rec_cnt;
+  uint8_t raw[MAXBUFLENGTH];
+  uint8_t exp_cnt, rec_cnt, raw_cnt, ret;
 
-  j = i = _Receive_BUF_Length = 0;
+  raw_cnt = _Receive_BUF_Length = 0;
   
   // 2 data bytes  + crc
   exp_cnt = count / 2 * 3;
@@ -950,49 +2128,80 @@ uint8_t SEN55::I2C_ReadToBuffer(uint8_t count, bool chk_zero)
   if (exp_cnt > 32) exp_cnt = 32;
 #endif
 
-  rec_cnt = _i2cPort->requestFrom((uint8_t) SEN55_ADDRESS, exp_cnt);
+  if (_Replay) {
+    if (Replay_Frame(SEN55_TRACE_READ, raw, &raw_cnt) == SEN55_REPLAY_END) raw_cnt = 0;
+    rec_cnt = raw_cnt;
+  }
+  else {
+    Bus_Lock();
+    rec_cnt = _i2cPort->requestFrom((uint8_t) SEN55_ADDRESS, exp_cnt);
+
+    // read all raw bytes
+    // flush any bytes pending (if NOT clearing rxBuffer)
+    while (_i2cPort->available()) {
+      if (raw_cnt < MAXBUFLENGTH) raw[raw_cnt++] = _i2cPort->read();
+      else _i2cPort->read();
+    }
+    Bus_Unlock();
+  }
 
   if (rec_cnt != exp_cnt ){
+#ifdef SEN55_STATISTICS
+    _Stats.short_reads++;
+#endif
     DebugPrintf("Did not receive all bytes: Expected 0x%02X, got 0x%02X\n",exp_cnt & 0xff,rec_cnt & 0xff);
-    return(SEN55_ERR_PROTOCOL);
+    ret = SEN55_ERR_PROTOCOL;
   }
-  
-  while (_i2cPort->available()) {  // read all
-
-    data[i++] = _i2cPort->read();
-//DebugPrintf("data 0x%02X\n", data[i-1]);
-    // 2 bytes RH, 1 CRC
-    if( i == 3) {
+  else
+    ret = I2C_CheckRaw(raw, raw_cnt, count, chk_zero);
 
-      if (data[2] != I2C_calc_CRC(&data[0])){
-        DebugPrintf("I2C CRC error: Expected 0x%02X, calculated 0x%02X\n",data[2] & 0xff,I2C_calc_CRC(&data[0]) & 0xff);
-        return(SEN55_ERR_PROTOCOL);
-      }
+  Trace(SEN55_TRACE_READ, ret, raw, raw_cnt);
 
-      _Receive_BUF[_Receive_BUF_Length++] = data[0];
-      _Receive_BUF[_Receive_BUF_Length++] = data[1];
+  return(ret);
+}
 
-      i = 0;
+/**
+ * @brief : check CRC and store data bytes in _Receive_BUF
+ * @param raw     : received bytes (2 data bytes + crc)
+ * @param raw_cnt : number of received bytes
+ * @param count   : number of data bytes to expect
+ * @param chk_zero :  check for zero termination ( Serial and product code)
+ *
+ * return :
+ * OK   SEN55_ERR_OK
+ * else error
+ */
+uint8_t SEN55::I2C_CheckRaw(uint8_t *raw, uint8_t raw_cnt, uint8_t count, bool chk_zero)
+{
+  uint8_t i = 0;
 
-      // check for zero termination (Serial and product code)
-      if (chk_zero) {
+  // 2 bytes RH, 1 CRC
+  while (raw_cnt - i >= 3) {
 
-        if (data[0] == 0 && data[1] == 0) {
+    if (raw[i+2] != I2C_calc_CRC(&raw[i])){
+#ifdef SEN55_STATISTICS
+      _Stats.crc_errors++;
+#endif
+      DebugPrintf("I2C CRC error: Expected 0x%02X, calculated 0x%02X\n",raw[i+2] & 0xff,I2C_calc_CRC(&raw[i]) & 0xff);
+      return(SEN55_ERR_PROTOCOL);
+    }
 
-          // flush any bytes pending (if NOT clearing rxBuffer)
-          // Logged as an issue and expect this could be removed in the future
-          while (_i2cPort->available()) _i2cPort->read();
-          return(SEN55_ERR_OK);
-        }
-      }
+    _Receive_BUF[_Receive_BUF_Length++] = raw[i];
+    _Receive_BUF[_Receive_BUF_Length++] = raw[i+1];
 
-      if (_Receive_BUF_Length >= count) break;
+    // check for zero termination (Serial and product code)
+    if (chk_zero) {
+      if (raw[i] == 0 && raw[i+1] == 0) return(SEN55_ERR_OK);
     }
+
+    i += 3;
+
+    if (_Receive_BUF_Length >= count) break;
   }
 
-  if (i != 0) {
-    DebugPrintf("Error: Data counter %d\n",i);
-    while (j < i) _Receive_BUF[_Receive_BUF_Length++] = data[j++];
+  if (_Receive_BUF_Length < count && i < raw_cnt) {
+    DebugPrintf("Error: Data counter %d\n",raw_cnt - i);
+    while (i < raw_cnt) _Receive_BUF[_Receive_BUF_Length++] = raw[i++];
   }
 
   if (_Receive_BUF_Length == 0) {
@@ -1002,6 +2211,9 @@ uint8_t SEN55::I2C_ReadToBuffer(uint8_t count, bool chk_zero)
 
   if (_Receive_BUF_Length == count) return(SEN55_ERR_OK);
 
+#ifdef SEN55_STATISTICS
+  _Stats.short_reads++;
+#endif
   DebugPrintf("Error: Expected bytes : %d, Received bytes %d\n", count,_Receive_BUF_Length);
 
   return(SEN55_ERR_DATALENGTH);
@@ -1016,13 +2228,11 @@ uint8_t SEN55::I2C_ReadToBuffer(uint8_t count, bool chk_zero)
  */
 bool SEN55::Check_data_ready()
 {
-  I2C_fill_buffer(SEN55_READ_DATA_RDY_FLAG);
-  
-  if (I2C_SetPointer_Read(2) != SEN55_ERR_OK) return(false);
-  
-  if (_Receive_BUF[1] == 1) return(true);
+  bool rdy;
+
+  if (Read_Cmd(SEN55_READ_DATA_RDY_FLAG, &rdy) != SEN55_ERR_OK) return(false);
   
-  return(false);
+  return(rdy);
 }
 
 /**
@@ -1049,3 +2259,185 @@ uint8_t SEN55::I2C_calc_CRC(uint8_t data[2])
 
   return crc;
 }
+
+/************************************************************
+ * priority command queue
+ *************************************************************/
+
+SEN55Queue::SEN55Queue(SEN55 *sen)
+{
+  _Sen = sen;
+  _Cnt = 0;
+  _Busy = false;
+  _Due = 0;
+  memset(&_Stats, 0x0, sizeof(struct sen_queue_stats));
+}
+
+/**
+ * @brief : add a job (the job is copied)
+ */
+bool SEN55Queue::Submit(struct sen_job *job)
+{
+  if (_Cnt >= SEN55_QUEUE_SIZE) return(false);
+
+  memcpy(&_Jobs[_Cnt++], job, sizeof(struct sen_job));
+  return(true);
+}
+
+/**
+ * @brief : add a job that can start now
+ */
+bool SEN55Queue::Submit(uint16_t cmd, void *data, uint8_t prio, void (*done)(struct sen_job *, uint8_t), uint32_t window)
+{
+  struct sen_job job;
+
+  memset(&job, 0x0, sizeof(struct sen_job));
+  job.cmd = cmd;
+  job.data = data;
+  job.prio = prio;
+  job.start = _Sen->Millis();
+  job.window = window;
+  job.done = done;
+
+  return(Submit(&job));
+}
+
+/**
+ * @brief : remove the waiting jobs with this command (0 = all)
+ */
+void SEN55Queue::Cancel(uint16_t cmd)
+{
+  uint8_t i = 0;
+
+  while (i < _Cnt) {
+    if (cmd == 0 || _Jobs[i].cmd == cmd) _Jobs[i] = _Jobs[--_Cnt];
+    else i++;
+  }
+}
+
+void SEN55Queue::GetStats(struct sen_queue_stats *st, bool reset)
+{
+  memcpy(st, &_Stats, sizeof(struct sen_queue_stats));
+  if (reset) memset(&_Stats, 0x0, sizeof(struct sen_queue_stats));
+}
+
+/**
+ * @brief : job is completed (or dropped), call done() and submit a periodic job again
+ */
+void SEN55Queue::Finish(struct sen_job *job, uint8_t ret)
+{
+  uint32_t now;
+
+  if (job->done) job->done(job, ret);
+
+  // done() can stop a periodic job by setting period to 0
+  if (job->period == 0) return;
+
+  // next period, skip the periods that were missed
+  now = _Sen->Millis();
+  job->start += job->period;
+  while ((int32_t) (now - job->start) >= (int32_t) job->period) job->start += job->period;
+
+  Submit(job);
+}
+
+/**
+ * @brief : select the next job to start
+ *
+ * return : index in _Jobs, -1 if no job should start now
+ */
+int8_t SEN55Queue::Select(uint32_t now)
+{
+  struct sen_job job;
+  uint32_t closes, best_closes = 0;
+  int8_t best = -1;
+  uint8_t i;
+
+  // drop the jobs that can no longer start in their window
+  i = 0;
+  while (i < _Cnt) {
+    if (_Jobs[i].window && (int32_t) (now - (_Jobs[i].start + _Jobs[i].window)) > 0) {
+      job = _Jobs[i];
+      _Jobs[i] = _Jobs[--_Cnt];
+      _Stats.expired++;
+      Finish(&job, SEN55_ERR_TIMEOUT);
+    }
+    else i++;
+  }
+
+  // highest priority, then the window that closes first
+  for (i = 0; i < _Cnt; i++) {
+
+    if ((int32_t) (now - _Jobs[i].start) < 0) continue;
+
+    closes = _Jobs[i].start + (_Jobs[i].window ? _Jobs[i].window : 0x40000000UL);
+
+    if (best < 0 || _Jobs[i].prio < _Jobs[best].prio ||
+       (_Jobs[i].prio == _Jobs[best].prio && (int32_t) (closes - best_closes) < 0)) {
+      best = i;
+      best_closes = closes;
+    }
+  }
+
+  if (best < 0) return(-1);
+
+  // do not start if it would delay a higher priority job that is due soon
+  for (i = 0; i < _Cnt; i++) {
+    if (_Jobs[i].prio < _Jobs[best].prio &&
+       (int32_t) (_Jobs[i].start - now) < (int32_t) (_Sen->RequestDelay(_Jobs[best].cmd) + SEN55_QUEUE_GUARD))
+      return(-1);
+  }
+
+  return(best);
+}
+
+/**
+ * @brief : perform the next step of the queue
+ *
+ * return : true if a job was completed
+ */
+bool SEN55Queue::Run()
+{
+  uint32_t now = _Sen->Millis();
+  uint8_t ret;
+  int8_t i;
+
+  // collect the answer of the running job
+  if (_Busy) {
+    if ((int32_t) (now - _Due) < 0) return(false);
+
+    ret = _Sen->Collect(_Cur.cmd, _Cur.data);
+    _Sen->Unlock();
+
+    _Busy = false;
+    _Stats.done++;
+    Finish(&_Cur, ret);
+    return(true);
+  }
+
+  i = Select(now);
+  if (i < 0) return(false);
+
+  _Cur = _Jobs[i];
+  _Jobs[i] = _Jobs[--_Cnt];
+
+  if (_Cur.prio == SEN55_PRIO_MEASURE && now - _Cur.start > _Stats.max_late)
+    _Stats.max_late = now - _Cur.start;
+
+  // no other task may use the SEN55 until the answer is collected
+  _Sen->Lock();
+
+  ret = _Sen->Request(_Cur.cmd, _Cur.data);
+
+  if (ret != SEN55_ERR_OK) {
+    _Sen->Unlock();
+    _Stats.done++;
+    Finish(&_Cur, ret);
+    return(true);
+  }
+
+  _Due = now + _Sen->RequestDelay(_Cur.cmd);
+  _Busy = true;
+
+  return(false);
+}
@@ -19,6 +19,9 @@
  **********************************************************************
  * Version 1.0 / October 2024 
  * - Initial version by paulvha
+ *
+ * Version 1.1 / October 2026 
+ * - see the changelog in sen55.cpp
  *********************************************************************
 */
 #ifndef SEN55_H
@@ -30,13 +33,21 @@
  * library version levels
  */
 #define DRIVER_MAJOR 1
-#define DRIVER_MINOR 0
+#define DRIVER_MINOR 1
 
 /**
  * select default debug serial
  */
 #define SEN55_DEBUGSERIAL Serial
 
+/**
+ * The text debug messages (EnableDebugging()) are formatted with vsprintf and
+ * printed while the I2C communication happens. This changes the timing.
+ * Remove the comment from the line below to remove the text debug completely
+ * (this also saves 256 bytes of RAM). Use the binary trace instead (EnableTrace()).
+ */
+//#define SEN55_NO_DEBUG_TEXT 1
+
 /**
  * If the platform is an ESP32 AND it is planned to connect an SCD30 as well,
  * you have to remove the comments from the line below
@@ -73,6 +84,64 @@
   #define MAX_32_TO_EXPECT 1
 #endif
 
+/**
+ * Transaction statistics (call count, errors and latency per command) are
+ * collected by default. They need about 900 bytes of RAM and are therefore
+ * disabled on low memory boards (SMALLFOOTPRINT).
+ *
+ * Remove the comment from the line below to disable them on other boards as well
+ */
+//#define SEN55_NO_STATISTICS 1
+
+#if !defined SMALLFOOTPRINT && !defined SEN55_NO_STATISTICS
+  #define SEN55_STATISTICS 1
+#endif
+
+/**
+ * Size in bytes of the binary trace buffer (see EnableTrace()).
+ * Set to 0 to remove the trace. It is not included on low memory boards.
+ */
+#ifndef SEN55_TRACE_SIZE
+  #if defined SMALLFOOTPRINT
+    #define SEN55_TRACE_SIZE 0
+  #else
+    #define SEN55_TRACE_SIZE 512
+  #endif
+#endif
+
+/**
+ * The latest sample cell (SEN55Latest) lets other threads (e.g. on an ESP32
+ * or Linux) get the last values without waiting for the I2C bus. It needs
+ * <atomic> and is not available on AVR boards.
+ *
+ * Remove the comment from the line below to disable it on other boards as well
+ */
+//#define SEN55_NO_LATEST 1
+
+#if !defined ARDUINO_ARCH_AVR && !defined SEN55_NO_LATEST
+  #define SEN55_LATEST 1
+  #include <atomic>
+#endif
+
+/**
+ * On boards with threads (ESP32 with FreeRTOS, Linux host build) the SEN55
+ * routines can be called from more than one task and the I2C bus can be
+ * shared with other drivers through a SEN55Bus. Each SEN55 transaction is
+ * protected by a (recursive) lock. On other boards the locks are empty.
+ *
+ * Remove the comment from the line below to disable the locks on all boards
+ */
+//#define SEN55_NO_THREADS 1
+
+#if !defined SEN55_NO_THREADS
+  #if defined ARDUINO_ARCH_ESP32
+    #define SEN55_THREADS 1
+  #elif defined __linux__
+    #define SEN55_THREADS 2
+    #include <mutex>
+  #endif
+#endif
+
 /* structure to return mass values */
 struct sen_values {
   float   MassPM1;        // Mass Concentration PM1.0 [μg/m3]
@@ -114,6 +183,21 @@ struct sen_version {
   uint8_t L_minor;
 };
 
+/**
+ * Device identity of a SEN55 (inventory record)
+ *
+ * The identity is read once from the SEN55 and is cached in the driver.
+ * Next calls to GetSerialNumber(), GetProductName(), GetVersion() and
+ * GetInventory() are served from the cache without I2C communication.
+ */
+#define SEN55_ID_LENGTH 32        // max characters serial number / product name
+
+struct sen_inventory {
+  char SerialNumber[SEN55_ID_LENGTH + 1];
+  char ProductName[SEN55_ID_LENGTH + 1];
+  struct sen_version Version;   // firmware, hardware, protocol and library level
+};
+
 /**
  * Used to read / write the Nox values
  * More details on the tuning instructions are provided in 
@@ -262,6 +346,210 @@ enum SEN_status {
 // I2c fixed address
 #define SEN55_ADDRESS 0x69            
 
+/**
+ * Transaction statistics
+ *
+ * The latency of each read transaction (write command, wait, read answer)
+ * is counted in log2 buckets in micro seconds :
+ *  latency[0]  :   0 - 2047 uS
+ *  latency[1]  : 2048 - 4095 uS
+ *  latency[n]  : 2^(10+n) - 2^(11+n) -1 uS
+ *  latency[7]  : 131072 uS or longer
+ */
+#define SEN55_STAT_CMDS   20          // number of SEN55 commands tracked
+#define SEN55_LAT_BUCKETS 8           // number of latency buckets
+
+struct sen_cmd_stats {
+  uint16_t cmd;                       // SEN55 command (e.g. SEN55_READ_MEASURED_VALUE)
+  uint32_t calls;                     // number of transactions
+  uint32_t errors;                    // number of failed transactions
+  uint32_t max_us;                    // longest read transaction in uS
+  uint32_t latency[SEN55_LAT_BUCKETS];// read transaction latency histogram
+};
+
+struct sen_stats {
+  uint32_t crc_errors;                // received data with wrong CRC
+  uint32_t short_reads;               // received less bytes than expected
+  uint32_t retries;                   // extra attempts of failed read transactions
+  struct sen_cmd_stats cmd[SEN55_STAT_CMDS];
+};
+
+/**
+ * Binary trace
+ *
+ * Each I2C frame is stored in a ring buffer as an entry of a 9 byte header
+ * followed by the raw bytes on the bus (for a read including the CRC-bytes).
+ * If the buffer is full, the oldest entries are overwritten.
+ *
+ *  byte 0    : number of raw bytes (n)
+ *  byte 1    : direction SEN55_TRACE_WRITE or SEN55_TRACE_READ
+ *  byte 2-3  : SEN55 command (MSB first)
+ *  byte 4-7  : timestamp in uS (MSB first), micros() plus skipped virtual time
+ *  byte 8    : status (write : endTransmission() result, read : SEN55_ERR_xxx)
+ *  byte 9..  : n raw bytes
+ *
+ * The same entry format is used to capture the frames to a stream
+ * (EnableCapture()) and to replay them (EnableReplay()).
+ */
+#define SEN55_TRACE_HDR   9
+#define SEN55_TRACE_WRITE 0x57        // 'W'
+#define SEN55_TRACE_READ  0x52        // 'R'
+#define SEN55_REPLAY_END  0xff        // replay : end of stream or unexpected frame
+
+/**
+ * How the library waits for the SEN55 (see SetWait())
+ */
+#define SEN55_WAIT_DELAY   0          // delay() (default)
+#define SEN55_WAIT_YIELD   1          // call the wait function or yield() until the time has passed
+#define SEN55_WAIT_VIRTUAL 2          // do not wait, only move the library clock forward
+
+/**
+ * Health monitor (see GetValuesStatus())
+ * The status register is read every SEN55_HEALTH_EVERY samples, or at once
+ * when a sample looks anomalous.
+ */
+#define SEN55_HEALTH_EVERY 60         // samples between status reads
+#define SEN55_HEALTH_JUMP  100        // change of PM2.5 [μg/m3] between samples that is anomalous
+
+#ifdef SEN55_LATEST
+/**
+ * Latest sample cell
+ *
+ * One thread reads the SEN55 and stores each new sample (see SetLatest()),
+ * any number of other threads get a copy of the last sample with Load(). A
+ * sequence lock is used : the writer never waits and a reader never blocks
+ * the writer, it only tries again if the sample changed during the copy.
+ *
+ * The values are kept as 32 bit atomic words, so also on boards without
+ * 64 bit atomics (ESP32, ARM Cortex-M) there is no lock involved.
+ */
+#define SEN55_LATEST_WORDS 9          // sen_values + time stamp
+#define SEN55_LATEST_TRIES 100        // max attempts to get a stable copy
+
+class SEN55Latest
+{
+  public:
+    SEN55Latest();
+
+    /**
+     * @brief : store a new sample (only one thread may store)
+     * @param v     : values
+     * @param stamp : time of the sample (e.g. Millis())
+     */
+    void Store(struct sen_values *v, uint32_t stamp);
+
+    /**
+     * @brief : get a copy of the latest sample
+     * @param v     : pointer to structure to store
+     * @param stamp : if not NULL, the time of the sample
+     * @param count : if not NULL, number of samples stored so far. Compare
+     *                with the count of the previous Load() to detect a new sample.
+     *
+     * A reader that interrupts the writer on the same core (e.g. a higher priority
+     * task) can not get a stable copy until the writer continues : after
+     * SEN55_LATEST_TRIES attempts SEN55_ERR_TIMEOUT is returned, try again later.
+     *
+     * @return
+     *  SEN55_ERR_OK = ok
+     *  SEN55_ERR_CMDSTATE = no sample stored yet
+     *  SEN55_ERR_TIMEOUT = sample was being changed during each attempt
+     */
+    uint8_t Load(struct sen_values *v, uint32_t *stamp = NULL, uint32_t *count = NULL);
+
+    /**
+     * @brief : number of samples stored so far
+     */
+    uint32_t Count() {return(_Seq.load(std::memory_order_acquire) / 2);}
+
+  private:
+    std::atomic<uint32_t> _Seq;         // odd while the sample is being stored
+    std::atomic<uint32_t> _Data[SEN55_LATEST_WORDS];
+};
+#endif // SEN55_LATEST
+
+/**
+ * Recursive lock, used for the bus and for each SEN55
+ * (empty if SEN55_THREADS is not defined)
+ */
+class SEN55Mutex
+{
+  public:
+    SEN55Mutex();
+    ~SEN55Mutex();
+
+    /**
+     * @brief : take the lock, wait if another task has it
+     * @return : true if the lock was free, false if we had to wait
+     */
+    bool Lock();
+    void Unlock();
+
+  private:
+#if SEN55_THREADS == 1
+    SemaphoreHandle_t _Mutex;
+#elif SEN55_THREADS == 2
+    std::recursive_mutex _Mutex;
+#endif
+};
+
+/**
+ * Shared I2C bus
+ *
+ * All drivers on one TwoWire share one SEN55Bus. The SEN55 only holds the
+ * bus during each transfer (write or read), NOT while the SEN55 is processing
+ * the command (5mS or more). In that gap other drivers can use the bus.
+ *
+ * Other drivers (e.g. BME280, SCD30 or SPS30 libraries) do not know about the
+ * SEN55Bus, hold it with a SEN55BusGuard around each of their calls :
+ *
+ *   SEN55Bus bus(&Wire);
+ *   sen55.begin(&bus);
+ *
+ *   { SEN55BusGuard g(&bus); temp = bme280.readTempC(); }
+ *
+ * Do not call SEN55 routines while holding the bus, the SEN55 takes its own
+ * lock first and then the bus.
+ */
+class SEN55Bus
+{
+  public:
+    SEN55Bus(TwoWire *port);
+
+    TwoWire *Port() {return(_Port);}
+
+    /**
+     * @brief : hold the bus for one or more transfers
+     */
+    void Lock();
+    void Unlock() {_Mutex.Unlock();}
+
+    /**
+     * @brief : bus usage
+     * @param reset : reset the counters after reading
+     * @param locks : number of times the bus was taken
+     * @param waits : number of times a driver had to wait for the bus
+     */
+    void GetUsage(uint32_t *locks, uint32_t *waits, bool reset = false);
+
+  private:
+    TwoWire *_Port;
+    SEN55Mutex _Mutex;
+    uint32_t _Locks, _Waits;
+};
+
+/**
+ * holds a SEN55Bus as long as the guard exists
+ */
+class SEN55BusGuard
+{
+  public:
+    SEN55BusGuard(SEN55Bus *bus) {_Bus = bus; _Bus->Lock();}
+    ~SEN55BusGuard() {_Bus->Unlock();}
+
+  private:
+    SEN55Bus *_Bus;
+};
+
 class SEN55
 {
   public:
@@ -287,6 +575,24 @@ class SEN55
      
     bool begin(TwoWire *wirePort);
 
+    /**
+     * @brief : use an I2C bus that is shared with other drivers (see SEN55Bus)
+     *
+     * @param bus : shared bus, the bus->Port()->begin() must be done in the sketch.
+     */
+    bool begin(SEN55Bus *bus);
+
+    /**
+     * @brief : hold this SEN55 for a sequence of routines
+     *
+     * Each routine of the SEN55 is a complete transaction and takes the lock by
+     * itself. Hold the lock when another task should not come in between, e.g.
+     * between Request() and Collect(). The lock can be taken more than once
+     * by the same task, each Lock() needs an Unlock().
+     */
+    void Lock() {_Lock.Lock();}
+    void Unlock() {_Lock.Unlock();}
+
     /**
      * @brief : Perform SEN55 instructions
      */
@@ -313,12 +619,17 @@ class SEN55
      * 
      * @param ser     : buffer to hold the read result
      * @param len     : length of the buffer (max 32 char)
+     *
+     * After the first successful read the result is taken from the cache.
+     * (not on boards with SMALLFOOTPRINT, there it is read each time)
      */
     uint8_t GetSerialNumber(char *ser, uint8_t len) {return(Get_Device_info(SEN55_READ_SERIAL_NUMBER, ser, len));}
     uint8_t GetProductName(char *ser, uint8_t len)  {return(Get_Device_info(SEN55_READ_PRODUCT_NAME, ser, len));} 
 
     /**
      * @brief : retrieve version information from the SEN55 and library
+     *
+     * After the first successful read the result is taken from the cache.
      * 
      * @return
      *  SEN55_ERR_OK = ok
@@ -326,6 +637,136 @@ class SEN55
      */
     uint8_t GetVersion(struct sen_version *v);
 
+    /**
+     * @brief : retrieve the complete identity (serial, product and versions)
+     *
+     * @param inv : structure to hold the inventory record
+     *
+     * Only the information that is not cached yet is read from the SEN55.
+     *
+     * @return
+     *  SEN55_ERR_OK = ok
+     *  else error
+     */
+    uint8_t GetInventory(struct sen_inventory *inv);
+
+    /**
+     * @brief : print the inventory record as a single CSV line
+     *
+     * @param out : output to use (e.g. &Serial or a File)
+     *
+     * format : serialnumber,productname,firmware,hardware,protocol,library
+     * e.g.   : 1A2B3C4D5E6F7A8B,SEN55,2.0,4.0,1.0,1.0
+     *
+     * @return
+     *  SEN55_ERR_OK = ok
+     *  else error
+     */
+    uint8_t PrintInventory(Print *out);
+
+    /**
+     * @brief : clear the identity cache
+     *
+     * The next request will read the identity again from the SEN55.
+     * Use this in case a sensor has been replaced while running.
+     */
+    void InvalidateInventory() {_InvValid = 0;}
+
+    /**
+     * @brief : obtain a snapshot of the transaction statistics
+     *
+     * @param s     : structure to hold the snapshot
+     * @param reset : if true the statistics are reset after the snapshot
+     *
+     * @return
+     *  SEN55_ERR_OK = ok
+     *  SEN55_ERR_PARAMETER = statistics are not included (SEN55_STATISTICS)
+     */
+    uint8_t GetStatistics(struct sen_stats *s, bool reset = false);
+    void ResetStatistics();
+
+    /**
+     * @brief : set the number of retries on a failed read transaction
+     *
+     * @param retry : number of retries (default 0, no retry)
+     */
+    void SetRetry(uint8_t retry) {_Retry = retry;}
+
+    /**
+     * @brief : enable or disable the binary trace of I2C frames
+     *
+     * @param act : true enable, false disable
+     *
+     * @return false if the trace is not included (SEN55_TRACE_SIZE = 0)
+     */
+    bool EnableTrace(bool act);
+
+    /**
+     * @brief : copy the trace entries (oldest first) for offline decoding
+     *
+     * @param buf   : buffer to hold the entries
+     * @param len   : length of the buffer
+     * @param clear : true : remove the copied entries from the trace
+     *
+     * Only complete entries are copied.
+     *
+     * @return : number of bytes copied
+     */
+    uint16_t GetTrace(uint8_t *buf, uint16_t len, bool clear = true);
+
+    /**
+     * @brief : decode and print the trace entries (oldest first)
+     *
+     * @param out   : output to use (e.g. &Serial)
+     * @param clear : true : remove the printed entries from the trace
+     */
+    void PrintTrace(Print *out, bool clear = true);
+    void ClearTrace() {_TraceTail = _TraceUsed = 0;}
+
+    /**
+     * @brief : capture all I2C frames to a stream
+     *
+     * @param out : output to write the frames to (e.g. &Serial or a File)
+     *              NULL will stop the capture
+     *
+     * Each frame is written as a binary trace entry (see SEN55_TRACE_HDR)
+     */
+    void EnableCapture(Print *out);
+
+    /**
+     * @brief : replay captured I2C frames instead of using the I2C bus
+     *
+     * @param in : stream with captured frames (e.g. a File)
+     *             NULL will stop the replay and use the I2C bus again
+     *
+     * Each write frame must match the captured write frame, the read frames are
+     * taken from the stream. The waits for the SEN55 are skipped during replay.
+     * begin() is not needed for replay.
+     */
+    void EnableReplay(Stream *in);
+
+    /**
+     * @brief : select how the library waits for the SEN55
+     *
+     * @param mode :
+     *  SEN55_WAIT_DELAY   : delay() (default)
+     *  SEN55_WAIT_YIELD   : until the time has passed call fn(remaining mS) or
+     *                       yield() if fn is NULL. Other work can be done during
+     *                       the wait (e.g. cooperative scheduler).
+     *  SEN55_WAIT_VIRTUAL : do not wait. The library clock (Millis()) is moved
+     *                       forward and fn(mS) is called (if not NULL) to move
+     *                       a simulated clock forward. (host tests and simulations)
+     *
+     * @param fn : wait function (optional)
+     */
+    void SetWait(uint8_t mode, void (*fn)(uint32_t ms) = NULL);
+
+    /**
+     * @brief : library clock in milliseconds
+     * millis() plus the time that was skipped with SEN55_WAIT_VIRTUAL
+     */
+    uint32_t Millis() {return(millis() + _VirtualTime);}
+
     /** 
      * @brief : Read Device Status from the SEN55
      *
@@ -347,6 +788,47 @@ class SEN55
      */
     uint8_t GetStatusReg(uint8_t *status);
 
+    /**
+     * @brief : retrieve measurement values with the device status attached
+     *
+     * The status register is NOT read each call : only every N samples or when
+     * the values look anomalous (unknown or out of range, PM sizes not in order
+     * or a sudden PM2.5 change). Otherwise the last status is returned. The
+     * status register is only cleared when it shows an issue.
+     *
+     * @param v      : pointer to structure to store
+     * @param status : latest status (as GetStatusReg())
+     * @param laser  : true : mass and RHTG, false : RHTG only (NO laser start)
+     *
+     * @return
+     *  SEN55_ERR_OK = ok (check status for issues)
+     *  else error reading the values
+     */
+    uint8_t GetValuesStatus(struct sen_values *v, uint8_t *status, bool laser = true);
+
+    /**
+     * @brief : set when the health monitor reads the status register
+     * @param every : read every N samples (0 = only on anomalous values)
+     * @param jump  : change of PM2.5 between samples that is anomalous (0 = no check)
+     */
+    void SetHealthCheck(uint16_t every = SEN55_HEALTH_EVERY, float jump = SEN55_HEALTH_JUMP);
+
+    /**
+     * @brief : health monitor for split transactions
+     *
+     * Call with each new sample. If it returns true, read the status register
+     * (SEN55_READ_DEVICE_REGISTER) and only clear it when Collect() returns
+     * SEN55_ERR_OUTOFRANGE.
+     *
+     * @return : true if the status register should be read now
+     */
+    bool HealthDue(struct sen_values *v);
+
+    /**
+     * @brief : last status read from the status register (as GetStatusReg())
+     */
+    uint8_t GetHealth() {return(_HealthStatus);}
+
     /**
      * @brief : retrieve measurement values from SEN55
      * 
@@ -371,6 +853,82 @@ class SEN55
      *  else error
      */
     uint8_t GetValuesPM(struct sen_values_pm *v);
+
+    /**
+     * @brief : non-blocking measurement
+     *
+     * After PollStart(), call poll() often from loop(). Each call performs at most
+     * one step (start, data-ready check, read) and never waits, so the sketch can
+     * keep its other duties responsive. Timing is based on Millis().
+     *
+     * Do not call other SEN55 routines while the non-blocking measurement is active,
+     * call PollStop() first.
+     *
+     * @param interval : milliseconds between reading values (minimum 1000)
+     * @param laser    : true : mass and RHTG, false : RHTG only (NO laser start)
+     */
+    void PollStart(uint32_t interval = 1000, bool laser = true);
+    void PollStop();
+
+    /**
+     * @brief : perform the next step of the non-blocking measurement
+     *
+     * @return : true if new values are available (see GetPollValues())
+     */
+    bool poll();
+
+    /**
+     * @brief : get the new values from the non-blocking measurement
+     *
+     * @return
+     *  SEN55_ERR_OK = ok
+     *  SEN55_ERR_CMDSTATE = no new values since last call
+     */
+    uint8_t GetPollValues(struct sen_values *v);
+
+    /**
+     * @brief : set function to call when new values are available (NULL = none)
+     */
+    void SetPollCallback(void (*cb)(struct sen_values *v)) {_PollCb = cb;}
+
+#ifdef SEN55_LATEST
+    /**
+     * @brief : store every new sample in a latest sample cell (NULL = none)
+     *
+     * Each sample read with GetValues(), poll() or Collect() is stored, with
+     * Millis() as time stamp. Other threads call Load() on the cell, they do not
+     * wait for the I2C bus and do not call any routine of this SEN55.
+     */
+    void SetLatest(SEN55Latest *cell) {_Latest = cell;}
+#endif
+
+    /**
+     * @brief : split transactions (event loops, schedulers, coroutines)
+     *
+     * Each SEN55 transaction is : Request() the command, wait RequestDelay() mS and
+     * Collect() the answer. The other routines do exactly that, but here the waiting
+     * is left to the caller so many sensors can be handled by one thread.
+     * Between Request() and Collect() no other routine of this SEN55 may be called.
+     *
+     * @param cmd    : SEN55 command (e.g. SEN55_READ_MEASURED_VALUE, SEN55_START_MEASUREMENT
+     *                 or SEN55_SET_WARM_START_PARAM)
+     * @param val    : value for a SEN55_SET_xxx command, same type as for the SetXXX()
+     *                 routine. Limits and scaling are applied as in SetXXX().
+     * @param result : answer of a read command, same type as for the GetXXX() routine
+     *                 SEN55_READ_DATA_RDY_FLAG  : bool
+     *                 SEN55_READ_DEVICE_REGISTER: uint8_t (status as GetStatusReg())
+     *                 serial number / product   : char[SEN55_ID_LENGTH + 1]
+     *
+     * Collect() is needed for every command (for SEN55_RESET it will re-initialize
+     * the I2C channel), result is not used for commands without answer.
+     *
+     * @return
+     *  SEN55_ERR_OK = ok
+     *  else error
+     */
+    uint8_t Request(uint16_t cmd, void *val = NULL);
+    uint8_t Collect(uint16_t cmd, void *result = NULL);
+    uint32_t RequestDelay(uint16_t cmd);
   
     /**
      * @brief : save or restore the VOC algorithm 
@@ -478,10 +1036,56 @@ class SEN55
     uint8_t SetRHTAccelMode(uint16_t val); 
   
   private:
+    friend class SEN55Bench;            // host benchmark (extras/linux)
+
     /** debug */
+#if defined SEN55_NO_DEBUG_TEXT
+    void DebugPrintf(const char *pcFmt, ...) {}
+#else
     void DebugPrintf(const char *pcFmt, ...);
-    int _SEN55_Debug;                   // program debug level
     char prfbuf[256];
+#endif
+    int _SEN55_Debug;                   // program debug level
+
+    /** binary trace */
+    void Trace(uint8_t dir, uint8_t status, uint8_t *data, uint8_t len);
+    uint8_t Trace_Get(uint16_t offset);
+    void Trace_Drop(uint16_t n);
+
+    /** capture and replay */
+    uint8_t Replay_Frame(uint8_t dir, uint8_t *data, uint8_t *len);
+    void Wait(uint32_t ms);
+    uint32_t Micros() {return(micros() + _VirtualTime * 1000);}
+    uint8_t _WaitMode;                  // SEN55_WAIT_xxx
+    void (*_WaitFn)(uint32_t ms);       // wait function
+    uint32_t _VirtualTime;              // skipped time in mS
+
+    /** non-blocking measurement */
+    #define SEN55_POLL_OFF        0
+    #define SEN55_POLL_START      1
+    #define SEN55_POLL_READY_SET  2
+    #define SEN55_POLL_READY_GET  3
+    #define SEN55_POLL_VALUES_SET 4
+    #define SEN55_POLL_VALUES_GET 5
+    uint8_t _PollState;
+    bool _PollLaser;
+    bool _PollNew;                      // new values available
+    uint32_t _PollInterval;
+    uint32_t _PollDue;                  // Millis() next step
+    uint32_t _PollCycle;                // Millis() current cycle
+    struct sen_values _PollVal;
+    void (*_PollCb)(struct sen_values *v);
+#ifdef SEN55_LATEST
+    SEN55Latest *_Latest;               // latest sample cell
+#endif
+    Print *_Capture;                    // capture output
+    Stream *_Replay;                    // replay input
+    bool _Trace;                        // trace enabled
+    uint16_t _TraceTail;                // oldest entry
+    uint16_t _TraceUsed;                // bytes in use
+#if SEN55_TRACE_SIZE > 0
+    uint8_t _TraceBuf[SEN55_TRACE_SIZE];
+#endif
     
     /** shared variables */
     uint8_t _Receive_BUF[MAXBUFLENGTH]; // buffers
@@ -489,9 +1093,36 @@ class SEN55
     uint8_t _Receive_BUF_Length;
     uint8_t _Send_BUF_Length;
     bool _started;                      // indicate the measurement has started
+    bool _Laser;                        // measurement started with laser
+    uint16_t _HealthEvery;              // health monitor : samples between status reads
+    uint16_t _HealthCnt;                // samples since last status read
+    float _HealthJump;                  // anomalous PM2.5 change
+    float _HealthPrev;                  // PM2.5 of previous sample (< 0 = none)
+    uint8_t _HealthStatus;              // last status
+    bool Anomalous(struct sen_values *v);
     uint8_t _FW_Major, _FW_Minor;       // holds sen55 firmware level
     uint32_t data32;                    // pass data to i2c_fill_buffer
     uint16_t data16;
+    struct sen_tmp_comp datatmp;        // scaled copy (the value of the caller is kept)
+    uint8_t _Retry;                     // retries on failed read transaction
+
+    /** transaction statistics */
+#ifdef SEN55_STATISTICS
+    struct sen_stats _Stats;
+    struct sen_cmd_stats * Stat_Cmd();
+    void Stat_Count(bool call, uint8_t ret);
+#endif
+
+    /** identity cache */
+    #define SEN55_INV_SERIAL  0x01
+    #define SEN55_INV_PRODUCT 0x02
+    #define SEN55_INV_VERSION 0x04
+    uint8_t _InvValid;                  // which identity parts are cached
+    struct sen_version _Version;
+#ifndef SMALLFOOTPRINT
+    char _SerialNumber[SEN55_ID_LENGTH + 1];
+    char _ProductName[SEN55_ID_LENGTH + 1];
+#endif
     
     /* needed for auto interval timing */
     typedef union {
@@ -501,20 +1132,122 @@ class SEN55
     
     /** shared supporting routines */
     uint8_t Get_Device_info(uint16_t type, char *ser, uint8_t len);
+    uint8_t Read_Version(struct sen_version *v);
     bool Instruct(uint16_t type);
     bool FWCheck(uint8_t major, uint8_t minor); 
     uint32_t byte_to_U32(int x);
     uint16_t byte_to_Uint16_t(int x);
     int16_t byte_to_int16_t(int x);
     bool Check_data_ready();
+    void Decode_Values(struct sen_values *v, bool laser);
+    uint8_t Decode(uint16_t cmd, void *result);
+    uint8_t Answer_Len(uint16_t cmd);
+    uint8_t Read_Cmd(uint16_t cmd, void *result);
+    void *Prepare_Set(uint16_t cmd, void *val);
     
     /** I2C communication */
     TwoWire *_i2cPort;                  // holds the I2C port
+    SEN55Bus *_Bus;                     // shared bus (or NULL)
+    SEN55Mutex _Lock;                   // one transaction at a time
+    void Bus_Lock() {if (_Bus) _Bus->Lock();}
+    void Bus_Unlock() {if (_Bus) _Bus->Unlock();}
     void I2C_init();
     void I2C_fill_buffer(uint16_t cmd, void *val = NULL);
     uint8_t I2C_ReadToBuffer(uint8_t count, bool chk_zero);
+    uint8_t I2C_CheckRaw(uint8_t *raw, uint8_t raw_cnt, uint8_t count, bool chk_zero);
     uint8_t I2C_SetPointer_Read(uint8_t cnt, bool chk_zero = false);
     uint8_t I2C_SetPointer();
     uint8_t I2C_calc_CRC(uint8_t data[2]);
 };
+
+/**
+ * Priority command queue
+ *
+ * Measurement reads, status polling, configuration and identity reads all
+ * compete for the same SEN55 (one per I2C bus, the address is fixed). The
+ * queue takes jobs with a priority, a start time and a window in which the
+ * job must start. Call Run() often from loop() (or one task), each call does
+ * at most one step with Request() / Collect() and never waits.
+ *
+ *  - the job with the highest priority that may start goes first, on equal
+ *    priority the one whose window closes first.
+ *  - a lower priority job only starts if it is done before a higher priority
+ *    job becomes due. Housekeeping fills the idle gaps, it never delays a
+ *    measurement read.
+ *  - a job that could not start within its window is dropped, done() is
+ *    called with SEN55_ERR_TIMEOUT.
+ *
+ * Jobs are passed as with Request() : no stop / restart is done for
+ * SEN55_SET_AUTO_CLEANING_INTERVAL and the measurement must be started with a
+ * SEN55_START_MEASUREMENT job (or start()).
+ */
+#define SEN55_QUEUE_SIZE        8     // max jobs waiting
+#define SEN55_QUEUE_GUARD       2     // mS margin before a higher priority job
+
+#define SEN55_PRIO_MEASURE      0     // measurement reads (highest)
+#define SEN55_PRIO_NORMAL       1
+#define SEN55_PRIO_HOUSEKEEPING 2     // status, configuration, identity (lowest)
+
+struct sen_job {
+  uint16_t cmd;                       // SEN55 command
+  void *data;                         // value for a set-command or result of a read-command
+  uint8_t prio;                       // SEN55_PRIO_xxx
+  uint32_t start;                     // Millis() when the job may start
+  uint32_t window;                    // mS after start the job may still start (0 = no limit)
+  uint32_t period;                    // if not 0, submit again with start + period
+  void (*done)(struct sen_job *job, uint8_t ret);  // called when done (or NULL)
+  void *ctx;                          // for the caller
+};
+
+struct sen_queue_stats {
+  uint32_t done;                      // jobs completed (also with error)
+  uint32_t expired;                   // jobs dropped, window closed
+  uint32_t max_late;                  // max mS a measurement job started after its start time
+};
+
+class SEN55Queue
+{
+  public:
+    SEN55Queue(SEN55 *sen);
+
+    /**
+     * @brief : add a job (the job is copied)
+     * @return : true if added, false if the queue is full
+     */
+    bool Submit(struct sen_job *job);
+
+    /**
+     * @brief : add a job that can start now
+     */
+    bool Submit(uint16_t cmd, void *data, uint8_t prio, void (*done)(struct sen_job *, uint8_t), uint32_t window = 0);
+
+    /**
+     * @brief : perform the next step
+     * @return : true if a job was completed
+     */
+    bool Run();
+
+    /**
+     * @brief : remove the waiting jobs with this command (0 = all)
+     * A job that is running is not cancelled.
+     */
+    void Cancel(uint16_t cmd = 0);
+
+    uint8_t Waiting() {return(_Cnt);}
+    bool Busy() {return(_Busy);}
+
+    void GetStats(struct sen_queue_stats *st, bool reset = false);
+
+  private:
+    int8_t Select(uint32_t now);
+    void Finish(struct sen_job *job, uint8_t ret);
+
+    SEN55 *_Sen;
+    struct sen_job _Jobs[SEN55_QUEUE_SIZE];
+    uint8_t _Cnt;
+    struct sen_job _Cur;                // running job
+    bool _Busy;
+    uint32_t _Due;                      // Millis() to collect the answer
+    struct sen_queue_stats _Stats;
+};
 #endif /* SEN55_H */
@@ -0,0 +1,306 @@
+/**
+ * SEN55 air quality index
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * ================ Disclaimer ===================================
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026 /paulvha
+ * - Initial version
+ *
+ *********************************************************************
+ */
+
+#include "sen55_aqi.h"
+#include <math.h>
+
+/**
+ * A concentration is first truncated to a multiple of step, then the first
+ * row with conc <= c_hi is used. Between c_lo and c_hi the index goes
+ * linear from i_lo to i_hi (a band has i_lo == i_hi). Above the last row
+ * the highest index is returned.
+ */
+struct sen_aqi_bp {
+  float c_lo;
+  float c_hi;
+  uint16_t i_lo;
+  uint16_t i_hi;
+};
+
+/**
+ * category name, up to and including index max
+ */
+struct sen_aqi_name {
+  uint16_t max;
+  const char *name;
+};
+
+#if SEN55_AQI_TABLE == SEN55_AQI_US_EPA
+
+#define AQI_STEP_PM2  0.1
+#define AQI_STEP_PM10 1
+
+static const struct sen_aqi_bp Aqi_PM2[] = {
+  {0.0, 9.0, 0, 50}, {9.1, 35.4, 51, 100}, {35.5, 55.4, 101, 150},
+  {55.5, 125.4, 151, 200}, {125.5, 225.4, 201, 300}, {225.5, 325.4, 301, 500}
+};
+
+static const struct sen_aqi_bp Aqi_PM10[] = {
+  {0, 54, 0, 50}, {55, 154, 51, 100}, {155, 254, 101, 150},
+  {255, 354, 151, 200}, {355, 424, 201, 300}, {425, 604, 301, 500}
+};
+
+#if not defined SMALLFOOTPRINT
+static const struct sen_aqi_name Aqi_Name[] = {
+  {50, "Good"}, {100, "Moderate"}, {150, "Unhealthy for Sensitive Groups"},
+  {200, "Unhealthy"}, {300, "Very Unhealthy"}, {500, "Hazardous"}
+};
+#endif
+
+#elif SEN55_AQI_TABLE == SEN55_AQI_UK_DAQI
+
+#define AQI_STEP_PM2  1
+#define AQI_STEP_PM10 1
+
+static const struct sen_aqi_bp Aqi_PM2[] = {
+  {0, 11, 1, 1}, {12, 23, 2, 2}, {24, 35, 3, 3}, {36, 41, 4, 4}, {42, 47, 5, 5},
+  {48, 53, 6, 6}, {54, 58, 7, 7}, {59, 64, 8, 8}, {65, 70, 9, 9}, {71, 71, 10, 10}
+};
+
+static const struct sen_aqi_bp Aqi_PM10[] = {
+  {0, 16, 1, 1}, {17, 33, 2, 2}, {34, 50, 3, 3}, {51, 58, 4, 4}, {59, 66, 5, 5},
+  {67, 75, 6, 6}, {76, 83, 7, 7}, {84, 91, 8, 8}, {92, 100, 9, 9}, {101, 101, 10, 10}
+};
+
+#if not defined SMALLFOOTPRINT
+static const struct sen_aqi_name Aqi_Name[] = {
+  {3, "Low"}, {6, "Moderate"}, {9, "High"}, {10, "Very High"}
+};
+#endif
+
+#elif SEN55_AQI_TABLE == SEN55_AQI_EU_EAQI
+
+#define AQI_STEP_PM2  0
+#define AQI_STEP_PM10 0
+
+static const struct sen_aqi_bp Aqi_PM2[] = {
+  {0, 10, 1, 1}, {10, 20, 2, 2}, {20, 25, 3, 3}, {25, 50, 4, 4}, {50, 75, 5, 5}, {75, 800, 6, 6}
+};
+
+static const struct sen_aqi_bp Aqi_PM10[] = {
+  {0, 20, 1, 1}, {20, 40, 2, 2}, {40, 50, 3, 3}, {50, 100, 4, 4}, {100, 150, 5, 5}, {150, 1200, 6, 6}
+};
+
+#if not defined SMALLFOOTPRINT
+static const struct sen_aqi_name Aqi_Name[] = {
+  {1, "Good"}, {2, "Fair"}, {3, "Moderate"}, {4, "Poor"}, {5, "Very poor"}, {6, "Extremely poor"}
+};
+#endif
+
+#else
+  #error "unknown SEN55_AQI_TABLE"
+#endif
+
+#define AQI_ROWS(t) (sizeof(t) / sizeof(struct sen_aqi_bp))
+
+static uint16_t Aqi_Lookup(const struct sen_aqi_bp *t, uint8_t rows, float step, float conc)
+{
+  const struct sen_aqi_bp *r;
+  float i;
+
+  if (isnan(conc)) return(SEN55_AQI_NONE);
+  if (conc < 0) conc = 0;
+
+  // the small offset prevents that e.g. 9.0 / 0.1 = 89.9999 is truncated to 8.9
+  if (step > 0) conc = floor(conc / step + 0.001) * step;
+
+  for (uint8_t j = 0; j < rows; j++) {
+
+    r = &t[j];
+
+    if (conc > r->c_hi + step / 2) continue;
+
+    if (r->i_lo == r->i_hi || conc <= r->c_lo) return(r->i_lo);
+
+    i = (float) (r->i_hi - r->i_lo) / (r->c_hi - r->c_lo) * (conc - r->c_lo) + r->i_lo;
+    return((uint16_t) (i + 0.5));
+  }
+
+  return(t[rows - 1].i_hi);
+}
+
+uint16_t SEN55AqiIndex(uint8_t fld, float conc)
+{
+  if (fld == SEN55_FLD_PM2) return(Aqi_Lookup(Aqi_PM2, AQI_ROWS(Aqi_PM2), AQI_STEP_PM2, conc));
+  if (fld == SEN55_FLD_PM10) return(Aqi_Lookup(Aqi_PM10, AQI_ROWS(Aqi_PM10), AQI_STEP_PM10, conc));
+
+  return(SEN55_AQI_NONE);
+}
+
+#if not defined SMALLFOOTPRINT
+const char *SEN55AqiName(uint16_t index)
+{
+  uint8_t j;
+
+  if (index == SEN55_AQI_NONE) return("Unknown");
+
+  for (j = 0; j < sizeof(Aqi_Name) / sizeof(Aqi_Name[0]) - 1; j++) {
+    if (index <= Aqi_Name[j].max) break;
+  }
+
+  return(Aqi_Name[j].name);
+}
+#endif
+
+/////////////////////////// NowCast ///////////////////////////////
+
+SEN55NowCast::SEN55NowCast()
+{
+  Clear();
+}
+
+void SEN55NowCast::Clear()
+{
+  for (uint8_t i = 0; i < SEN55_NOWCAST_HOURS; i++) _Hour[0][i] = _Hour[1][i] = NAN;
+
+  _Pos = 0;
+  _Last = 0;
+  _Started = false;
+  _Now[0] = _Now[1] = NAN;
+}
+
+/**
+ * @brief : NowCast of the hourly means, h[0] is the newest hour
+ */
+float SEN55NowCast::Calc(float *h)
+{
+  float mn = 0, mx = 0, w, wi = 1, sum = 0, div = 0;
+  uint8_t i, valid = 0;
+
+  // 2 of the 3 most recent hours are needed
+  for (i = 0; i < 3; i++) {
+    if (! isnan(h[i])) valid++;
+  }
+
+  if (valid < 2) return(NAN);
+
+  valid = 0;
+
+  for (i = 0; i < SEN55_NOWCAST_HOURS; i++) {
+
+    if (isnan(h[i])) continue;
+
+    if (valid++ == 0) mn = mx = h[i];
+    else if (h[i] < mn) mn = h[i];
+    else if (h[i] > mx) mx = h[i];
+  }
+
+  // weight factor, at least 0.5 for PM
+  w = mx > 0 ? mn / mx : 1;
+  if (w < 0.5) w = 0.5;
+
+  // a missing hour keeps its place in the weights
+  for (i = 0; i < SEN55_NOWCAST_HOURS; i++) {
+
+    if (! isnan(h[i])) {
+      sum += wi * h[i];
+      div += wi;
+    }
+
+    wi *= w;
+  }
+
+  return(sum / div);
+}
+
+void SEN55NowCast::AddHour(float pm2, float pm10, uint32_t start)
+{
+  float h[SEN55_NOWCAST_HOURS];
+  uint32_t missing = 0;
+  uint8_t i, j;
+
+  start -= start % 3600;
+
+  if (_Started) {
+
+    // the same hour again : replace it
+    if (start == _Last) _Pos = (_Pos + SEN55_NOWCAST_HOURS - 1) % SEN55_NOWCAST_HOURS;
+
+    // time went back : start again
+    else if (start < _Last) Clear();
+
+    else missing = (start - _Last) / 3600 - 1;
+  }
+
+  if (missing > SEN55_NOWCAST_HOURS) missing = SEN55_NOWCAST_HOURS;
+
+  while (missing--) {
+    _Hour[0][_Pos] = _Hour[1][_Pos] = NAN;
+    _Pos = (_Pos + 1) % SEN55_NOWCAST_HOURS;
+  }
+
+  _Hour[0][_Pos] = pm2;
+  _Hour[1][_Pos] = pm10;
+
+  // once per hour : the NowCast of both, newest hour first
+  for (j = 0; j < 2; j++) {
+    for (i = 0; i < SEN55_NOWCAST_HOURS; i++)
+      h[i] = _Hour[j][(_Pos + SEN55_NOWCAST_HOURS - i) % SEN55_NOWCAST_HOURS];
+
+    _Now[j] = Calc(h);
+  }
+
+  _Pos = (_Pos + 1) % SEN55_NOWCAST_HOURS;
+  _Last = start;
+  _Started = true;
+}
+
+float SEN55NowCast::Conc(uint8_t fld)
+{
+  if (fld == SEN55_FLD_PM2) return(_Now[0]);
+  if (fld == SEN55_FLD_PM10) return(_Now[1]);
+
+  return(NAN);
+}
+
+uint16_t SEN55NowCast::Index(uint8_t fld)
+{
+  return(SEN55AqiIndex(fld, Conc(fld)));
+}
+
+uint16_t SEN55NowCast::Index()
+{
+  uint16_t i2 = Index(SEN55_FLD_PM2), i10 = Index(SEN55_FLD_PM10);
+
+  if (i2 == SEN55_AQI_NONE) return(i10);
+  if (i10 == SEN55_AQI_NONE) return(i2);
+
+  return(i2 > i10 ? i2 : i10);
+}
+
+void SEN55NowCast::RollupHour(SEN55Rollup *r, uint8_t level, void *ctx)
+{
+  SEN55NowCast *n = (SEN55NowCast *) ctx;
+  struct sen_agg a;
+  float pm2 = NAN, pm10 = NAN;
+  uint32_t start;
+
+  if (r->Period(level) != 3600) return;
+
+  if (r->Get(level, 1, SEN55_FLD_PM2, &a, &start) == SEN55_ERR_OK && a.count) pm2 = a.mean;
+  if (r->Get(level, 1, SEN55_FLD_PM10, &a, &start) == SEN55_ERR_OK && a.count) pm10 = a.mean;
+
+  if (isnan(pm2) && isnan(pm10)) return;
+
+  n->AddHour(pm2, pm10, start);
+}
@@ -0,0 +1,131 @@
+/**
+ * SEN55 air quality index header file
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * Converts MassPM2 and MassPM10 to an air quality index with the breakpoint
+ * table selected below, and keeps the NowCast (US EPA) of both : a weighted
+ * average of the last 12 hourly means, where the weight of older hours
+ * drops when the concentration changes fast.
+ *
+ * The NowCast is updated once per finished hour, e.g. from a SEN55Rollup :
+ *
+ *   SEN55Rollup hist(SEN55_FLD(SEN55_FLD_PM2) | SEN55_FLD(SEN55_FLD_PM10));
+ *   SEN55NowCast now;
+ *
+ *   hist.SetCallback(SEN55NowCast::RollupHour, &now);
+ *   ...
+ *   hist.Add(&val, t);
+ *   aqi = now.Index();
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026
+ * - Initial version by paulvha
+ *********************************************************************
+*/
+#ifndef SEN55_AQI_H
+#define SEN55_AQI_H
+
+#include "sen55_rollup.h"
+
+/**
+ * breakpoint tables
+ */
+#define SEN55_AQI_US_EPA  1           // US EPA AQI 0 ... 500 (PM2.5 breakpoints of 2024)
+#define SEN55_AQI_UK_DAQI 2           // UK Daily Air Quality Index, bands 1 ... 10
+#define SEN55_AQI_EU_EAQI 3           // European Air Quality Index, bands 1 ... 6
+
+/**
+ * Select the breakpoint table. The UK and EU indices are officially based
+ * on the 24 hour mean of PM, the US EPA on the 24 hour mean or the NowCast.
+ *
+ * Remove the comment from one of the lines below to select another table
+ */
+//#define SEN55_AQI_TABLE SEN55_AQI_UK_DAQI
+//#define SEN55_AQI_TABLE SEN55_AQI_EU_EAQI
+
+#ifndef SEN55_AQI_TABLE
+  #define SEN55_AQI_TABLE SEN55_AQI_US_EPA
+#endif
+
+#define SEN55_AQI_NONE    0xffff      // no index (no data or not PM2.5 / PM10)
+#define SEN55_NOWCAST_HOURS 12
+
+/**
+ * @brief : air quality index of a concentration
+ * @param fld  : SEN55_FLD_PM2 or SEN55_FLD_PM10
+ * @param conc : concentration [μg/m3]
+ * @return : index, SEN55_AQI_NONE if no index
+ */
+uint16_t SEN55AqiIndex(uint8_t fld, float conc);
+
+#if not defined SMALLFOOTPRINT
+/**
+ * @brief : name of the category of an index (e.g. "Moderate")
+ */
+const char *SEN55AqiName(uint16_t index);
+#endif
+
+class SEN55NowCast
+{
+  public:
+    SEN55NowCast();
+
+    void Clear();
+
+    /**
+     * @brief : add the means of a finished hour
+     * @param pm2   : mean MassPM2 of the hour (NaN if not known)
+     * @param pm10  : mean MassPM10 of the hour (NaN if not known)
+     * @param start : start time of the hour in seconds. Hours without data
+     *                in between are counted as missing.
+     */
+    void AddHour(float pm2, float pm10, uint32_t start);
+
+    /**
+     * @brief : NowCast concentration
+     * @param fld : SEN55_FLD_PM2 or SEN55_FLD_PM10
+     * @return : concentration, NaN if not known (2 of the last 3 hours are needed)
+     */
+    float Conc(uint8_t fld);
+
+    /**
+     * @brief : air quality index of the NowCast
+     * @param fld : SEN55_FLD_PM2 or SEN55_FLD_PM10
+     * @return : index, SEN55_AQI_NONE if not known
+     */
+    uint16_t Index(uint8_t fld);
+
+    /**
+     * @brief : overall index (highest of PM2.5 and PM10)
+     */
+    uint16_t Index();
+
+    /**
+     * @brief : callback for SEN55Rollup::SetCallback(), ctx is the SEN55NowCast.
+     * Adds each finished hour of the rollup (needs a level with a period of
+     * 1 hour that follows SEN55_FLD_PM2 and / or SEN55_FLD_PM10).
+     */
+    static void RollupHour(SEN55Rollup *r, uint8_t level, void *ctx);
+
+  private:
+    float Calc(float *h);
+
+    float _Hour[2][SEN55_NOWCAST_HOURS];  // hourly means PM2.5, PM10 (NaN = missing)
+    uint8_t _Pos;                         // newest hour in _Hour
+    uint32_t _Last;                       // start of the newest hour
+    bool _Started;
+    float _Now[2];                        // NowCast PM2.5, PM10
+};
+
+#endif /* SEN55_AQI_H */
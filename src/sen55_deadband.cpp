@@ -0,0 +1,117 @@
+/**
+ * SEN55 deadband publish filter
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * ================ Disclaimer ===================================
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026 /paulvha
+ * - Initial version
+ *
+ *********************************************************************
+ */
+
+#include "sen55_deadband.h"
+#include <math.h>
+
+SEN55Deadband::SEN55Deadband(uint32_t heartbeat)
+{
+  uint8_t f;
+
+  for (f = SEN55_FLD_PM1; f <= SEN55_FLD_PM10; f++) SetBand(f, SEN55_DB_MASS_ABS, SEN55_DB_MASS_REL);
+  for (f = SEN55_FLD_NUMPM0; f <= SEN55_FLD_NUMPM10; f++) SetBand(f, SEN55_DB_NUM_ABS, SEN55_DB_NUM_REL);
+
+  SetBand(SEN55_FLD_HUM, SEN55_DB_HUM_ABS);
+  SetBand(SEN55_FLD_TEMP, SEN55_DB_TEMP_ABS);
+  SetBand(SEN55_FLD_VOC, SEN55_DB_INDEX_ABS);
+  SetBand(SEN55_FLD_NOX, SEN55_DB_INDEX_ABS);
+  SetBand(SEN55_FLD_PARTSIZE, SEN55_DB_SIZE_ABS);
+
+  for (f = 0; f < SEN55_FLD_NUM; f++) _Last[f] = NAN;
+
+  _Heartbeat = heartbeat;
+  _LastSent = 0;
+  _Checked = _Sent = 0;
+  _Changed = 0;
+  _Force = true;                      // the first sample is always sent
+}
+
+void SEN55Deadband::SetBand(uint8_t fld, float abs, float rel)
+{
+  if (fld >= SEN55_FLD_NUM) return;
+
+  _Abs[fld] = abs;
+  _Rel[fld] = rel;
+}
+
+bool SEN55Deadband::Check(float *x, uint32_t now)
+{
+  float d;
+  uint8_t f;
+
+  _Checked++;
+  _Changed = 0;
+
+  for (f = 0; f < SEN55_FLD_NUM; f++) {
+
+    if (isnan(x[f]) || _Abs[f] < 0) continue;
+
+    if (isnan(_Last[f])) {
+      _Changed |= SEN55_FLD(f);
+      continue;
+    }
+
+    d = fabs(x[f] - _Last[f]);
+
+    if (d > _Abs[f] && d > _Rel[f] * fabs(_Last[f])) _Changed |= SEN55_FLD(f);
+  }
+
+  if (! _Changed && ! _Force && (_Heartbeat == 0 || now - _LastSent < _Heartbeat))
+    return(false);
+
+  // this sample is sent : compare the next with it
+  for (f = 0; f < SEN55_FLD_NUM; f++) {
+    if (! isnan(x[f])) _Last[f] = x[f];
+  }
+
+  _LastSent = now;
+  _Force = false;
+  _Sent++;
+  return(true);
+}
+
+bool SEN55Deadband::Check(struct sen_values *v, uint32_t now)
+{
+  float x[SEN55_FLD_NUM];
+
+  for (uint8_t f = 0; f < SEN55_FLD_NUM; f++) x[f] = SEN55Field(v, f);
+
+  return(Check(x, now));
+}
+
+bool SEN55Deadband::Check(struct sen_values_pm *v, uint32_t now)
+{
+  float x[SEN55_FLD_NUM];
+
+  for (uint8_t f = 0; f < SEN55_FLD_NUM; f++) x[f] = SEN55Field(v, f);
+
+  return(Check(x, now));
+}
+
+void SEN55Deadband::GetStats(uint32_t *checked, uint32_t *sent, bool reset)
+{
+  *checked = _Checked;
+  *sent = _Sent;
+
+  if (reset) _Checked = _Sent = 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * SEN55 deadband publish filter header file
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * Decides if a new sample must be sent (published) or not. Each field is
+ * compared with the value that was sent last. A field has moved if the
+ * change is larger than its absolute band AND larger than its relative
+ * band (part of the last value sent) : the absolute band ignores the noise
+ * at low values, the relative band at high values. If no field has moved,
+ * the sample is still sent after the heartbeat time, so the receiver knows
+ * the node is alive.
+ *
+ *   SEN55Deadband filter;
+ *
+ *   sen55.GetValues(&val);
+ *   if (filter.Check(&val, millis())) send(&val);
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026
+ * - Initial version by paulvha
+ *********************************************************************
+*/
+#ifndef SEN55_DEADBAND_H
+#define SEN55_DEADBAND_H
+
+#include "sen55_stats.h"
+
+/**
+ * default bands (absolute, relative) and heartbeat
+ */
+#define SEN55_DB_MASS_ABS   1.0       // MassPMx [μg/m3]
+#define SEN55_DB_MASS_REL   0.1       // 10%
+#define SEN55_DB_HUM_ABS    2.0       // [%RH]
+#define SEN55_DB_TEMP_ABS   0.2       // [°C]
+#define SEN55_DB_INDEX_ABS  5.0       // VOC / NOx index
+#define SEN55_DB_NUM_ABS    5.0       // NumPMx [#/cm3]
+#define SEN55_DB_NUM_REL    0.1
+#define SEN55_DB_SIZE_ABS   0.05      // PartSize [μm]
+#define SEN55_DB_HEARTBEAT  900000    // mS (15 minutes)
+
+class SEN55Deadband
+{
+  public:
+    SEN55Deadband(uint32_t heartbeat = SEN55_DB_HEARTBEAT);
+
+    /**
+     * @brief : set the band of a field
+     * @param fld : SEN55_FLD_xxx
+     * @param abs : change that is ignored [unit of the field] (0 = none)
+     * @param rel : change that is ignored, part of the last value (0.1 = 10%, 0 = none)
+     * A field with a negative abs is never compared.
+     */
+    void SetBand(uint8_t fld, float abs, float rel = 0);
+
+    /**
+     * @brief : set max mS without sending (0 = no heartbeat)
+     */
+    void SetHeartbeat(uint32_t ms) {_Heartbeat = ms;}
+
+    /**
+     * @brief : check a new sample
+     * @param v   : values
+     * @param now : time in mS (e.g. millis())
+     * @return : true if the sample must be sent, it is then the last value sent.
+     * The fields that are not in the structure are not compared.
+     */
+    bool Check(struct sen_values *v, uint32_t now);
+    bool Check(struct sen_values_pm *v, uint32_t now);
+
+    /**
+     * @brief : mask (SEN55_FLD(x)) of the fields that moved at the last Check()
+     * (0 after a heartbeat)
+     */
+    uint16_t Changed() {return(_Changed);}
+
+    /**
+     * @brief : send the next sample, whatever changed (e.g. after a reconnect)
+     */
+    void Force() {_Force = true;}
+
+    /**
+     * @brief : number of samples checked and sent
+     */
+    void GetStats(uint32_t *checked, uint32_t *sent, bool reset = false);
+
+  private:
+    bool Check(float *x, uint32_t now);
+
+    float _Abs[SEN55_FLD_NUM];
+    float _Rel[SEN55_FLD_NUM];
+    float _Last[SEN55_FLD_NUM];         // last value sent (NaN = none)
+    uint32_t _Heartbeat;
+    uint32_t _LastSent;                 // time of the last sample sent
+    uint32_t _Checked, _Sent;
+    uint16_t _Changed;
+    bool _Force;
+};
+
+#endif /* SEN55_DEADBAND_H */
@@ -0,0 +1,399 @@
+/**
+ * SEN55 JSON and CBOR encoding
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * ================ Disclaimer ===================================
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026 /paulvha
+ * - Initial version
+ *
+ *********************************************************************
+ */
+
+#include "sen55_encode.h"
+#include <math.h>
+
+/**
+ * key and decimals (the precision of the SEN55) per SEN55_FLD_xxx
+ */
+struct sen_enc_fld {
+  const char *key;
+  uint8_t dec;
+};
+
+static const struct sen_enc_fld Enc_Fld[SEN55_FLD_NUM] = {
+  {"MassPM1", 1}, {"MassPM2", 1}, {"MassPM4", 1}, {"MassPM10", 1},
+  {"Hum", 2}, {"Temp", 3}, {"VOC", 1}, {"NOX", 1},
+  {"NumPM0", 1}, {"NumPM1", 1}, {"NumPM2", 1}, {"NumPM4", 1}, {"NumPM10", 1},
+  {"PartSize", 3}
+};
+
+static const uint32_t Enc_Pow10[] = {1, 10, 100, 1000, 10000, 100000};
+
+#define ENC_MAX_DEC 5
+
+/**
+ * @brief : "major.minor" of a version (buf at least 8)
+ */
+static void Enc_Version(char *buf, uint8_t major, uint8_t minor)
+{
+  uint8_t n = 0;
+
+  if (major >= 100) buf[n++] = '0' + major / 100;
+  if (major >= 10) buf[n++] = '0' + major / 10 % 10;
+  buf[n++] = '0' + major % 10;
+  buf[n++] = '.';
+  if (minor >= 100) buf[n++] = '0' + minor / 100;
+  if (minor >= 10) buf[n++] = '0' + minor / 10 % 10;
+  buf[n++] = '0' + minor % 10;
+  buf[n] = 0x0;
+}
+
+/////////////////////////// JSON ///////////////////////////////
+
+SEN55Json::SEN55Json(char *buf, uint16_t size)
+{
+  _Buf = buf;
+  _Size = size;
+  Begin();
+}
+
+void SEN55Json::Begin()
+{
+  _Pos = 0;
+  _First = true;
+  _Over = false;
+  Put('{');
+}
+
+/**
+ * @brief : add a character, 1 byte is kept for the 0x0
+ */
+void SEN55Json::Put(char c)
+{
+  if (_Pos + 1 < _Size) _Buf[_Pos++] = c;
+  else _Over = true;
+}
+
+void SEN55Json::Put(const char *s)
+{
+  while (*s) Put(*s++);
+}
+
+/**
+ * @brief : add a string with quotes and escapes
+ */
+void SEN55Json::Text(const char *s)
+{
+  static const char hex[] = "0123456789abcdef";
+
+  Put('"');
+
+  for (; *s; s++) {
+
+    if (*s == '"' || *s == '\\') {
+      Put('\\');
+      Put(*s);
+    }
+    else if ((uint8_t) *s < 0x20) {
+      Put("\\u00");
+      Put(hex[(uint8_t) *s >> 4]);
+      Put(hex[*s & 0xf]);
+    }
+    else Put(*s);
+  }
+
+  Put('"');
+}
+
+void SEN55Json::Key(const char *key)
+{
+  if (! _First) Put(',');
+  _First = false;
+
+  Text(key);
+  Put(':');
+}
+
+/**
+ * @brief : add a number with dec decimals, as an integer (no printf / dtostrf)
+ */
+void SEN55Json::Float(float x, uint8_t dec)
+{
+  char tmp[16];
+  uint32_t u;
+  uint8_t n = 0, i;
+  bool neg;
+
+  if (dec > ENC_MAX_DEC) dec = ENC_MAX_DEC;
+
+  // NaN, infinite or does not fit
+  if (! (fabs(x) < 4.0e9f / Enc_Pow10[dec])) {
+    Put("null");
+    return;
+  }
+
+  u = (uint32_t) (fabs(x) * Enc_Pow10[dec] + 0.5f);
+  neg = x < 0 && u > 0;               // no -0.0
+
+  // digits from the right
+  for (i = 0; i < dec; i++) {
+    tmp[n++] = '0' + u % 10;
+    u /= 10;
+  }
+
+  if (dec) tmp[n++] = '.';
+
+  do {
+    tmp[n++] = '0' + u % 10;
+    u /= 10;
+  } while (u);
+
+  if (neg) tmp[n++] = '-';
+
+  while (n) Put(tmp[--n]);
+}
+
+void SEN55Json::AddFloat(const char *key, float x, uint8_t dec)
+{
+  Key(key);
+  Float(x, dec);
+}
+
+void SEN55Json::AddInt(const char *key, int32_t n)
+{
+  char tmp[12];
+  uint32_t u = n < 0 ? 0 - (uint32_t) n : (uint32_t) n;
+  uint8_t i = 0;
+
+  Key(key);
+
+  do {
+    tmp[i++] = '0' + u % 10;
+    u /= 10;
+  } while (u);
+
+  if (n < 0) tmp[i++] = '-';
+
+  while (i) Put(tmp[--i]);
+}
+
+void SEN55Json::AddText(const char *key, const char *s)
+{
+  Key(key);
+  Text(s);
+}
+
+void SEN55Json::AddBool(const char *key, bool b)
+{
+  Key(key);
+  Put(b ? "true" : "false");
+}
+
+void SEN55Json::Add(struct sen_values *v)
+{
+  for (uint8_t f = SEN55_FLD_PM1; f <= SEN55_FLD_NOX; f++)
+    AddFloat(Enc_Fld[f].key, SEN55Field(v, f), Enc_Fld[f].dec);
+}
+
+void SEN55Json::Add(struct sen_values_pm *v)
+{
+  for (uint8_t f = SEN55_FLD_PM1; f < SEN55_FLD_NUM; f++) {
+    if (f == SEN55_FLD_HUM) f = SEN55_FLD_NUMPM0;
+    AddFloat(Enc_Fld[f].key, SEN55Field(v, f), Enc_Fld[f].dec);
+  }
+}
+
+void SEN55Json::Add(struct sen_version *v)
+{
+  char tmp[8];
+
+  Enc_Version(tmp, v->F_major, v->F_minor);
+  AddText("Firmware", tmp);
+  AddBool("Debug", v->F_debug);
+  Enc_Version(tmp, v->H_major, v->H_minor);
+  AddText("Hardware", tmp);
+  Enc_Version(tmp, v->P_major, v->P_minor);
+  AddText("Protocol", tmp);
+  Enc_Version(tmp, v->L_major, v->L_minor);
+  AddText("Library", tmp);
+}
+
+void SEN55Json::AddStatus(uint8_t status)
+{
+  AddInt("Status", status);
+}
+
+uint16_t SEN55Json::End()
+{
+  Put('}');
+
+  if (_Size) _Buf[_Pos] = 0x0;
+
+  return(_Over ? 0 : _Pos);
+}
+
+/////////////////////////// CBOR ///////////////////////////////
+
+#define CBOR_UINT   0                   // major types
+#define CBOR_NINT   1
+#define CBOR_TEXT   3
+#define CBOR_MAP_INDEF  0xbf            // map of unknown length
+#define CBOR_BREAK  0xff                // end of it
+#define CBOR_FALSE  0xf4
+#define CBOR_TRUE   0xf5
+#define CBOR_NULL   0xf6
+#define CBOR_FLOAT  0xfa                // single precision
+
+SEN55Cbor::SEN55Cbor(uint8_t *buf, uint16_t size)
+{
+  _Buf = buf;
+  _Size = size;
+  Begin();
+}
+
+void SEN55Cbor::Begin()
+{
+  _Pos = 0;
+  _Over = false;
+  Put(CBOR_MAP_INDEF);
+}
+
+void SEN55Cbor::Put(uint8_t c)
+{
+  if (_Pos < _Size) _Buf[_Pos++] = c;
+  else _Over = true;
+}
+
+/**
+ * @brief : major type and argument (big endian)
+ */
+void SEN55Cbor::Head(uint8_t major, uint32_t n)
+{
+  major <<= 5;
+
+  if (n < 24) Put(major | n);
+  else if (n < 0x100) {
+    Put(major | 24);
+    Put(n);
+  }
+  else if (n < 0x10000) {
+    Put(major | 25);
+    Put(n >> 8);
+    Put(n & 0xff);
+  }
+  else {
+    Put(major | 26);
+    Put(n >> 24);
+    Put((n >> 16) & 0xff);
+    Put((n >> 8) & 0xff);
+    Put(n & 0xff);
+  }
+}
+
+void SEN55Cbor::Text(const char *s)
+{
+  uint16_t len = strlen(s);
+
+  Head(CBOR_TEXT, len);
+  while (len--) Put(*s++);
+}
+
+void SEN55Cbor::Float(float x)
+{
+  uint32_t u;
+
+  if (isnan(x)) {
+    Put(CBOR_NULL);
+    return;
+  }
+
+  memcpy(&u, &x, sizeof(u));
+
+  Put(CBOR_FLOAT);
+  Put(u >> 24);
+  Put((u >> 16) & 0xff);
+  Put((u >> 8) & 0xff);
+  Put(u & 0xff);
+}
+
+void SEN55Cbor::AddFloat(const char *key, float x, uint8_t dec)
+{
+  (void) dec;
+
+  Text(key);
+  Float(x);
+}
+
+void SEN55Cbor::AddInt(const char *key, int32_t n)
+{
+  Text(key);
+
+  // a negative n is stored as -1 - n
+  if (n < 0) Head(CBOR_NINT, (uint32_t) (-1 - n));
+  else Head(CBOR_UINT, n);
+}
+
+void SEN55Cbor::AddText(const char *key, const char *s)
+{
+  Text(key);
+  Text(s);
+}
+
+void SEN55Cbor::AddBool(const char *key, bool b)
+{
+  Text(key);
+  Put(b ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void SEN55Cbor::Add(struct sen_values *v)
+{
+  for (uint8_t f = SEN55_FLD_PM1; f <= SEN55_FLD_NOX; f++)
+    AddFloat(Enc_Fld[f].key, SEN55Field(v, f));
+}
+
+void SEN55Cbor::Add(struct sen_values_pm *v)
+{
+  for (uint8_t f = SEN55_FLD_PM1; f < SEN55_FLD_NUM; f++) {
+    if (f == SEN55_FLD_HUM) f = SEN55_FLD_NUMPM0;
+    AddFloat(Enc_Fld[f].key, SEN55Field(v, f));
+  }
+}
+
+void SEN55Cbor::Add(struct sen_version *v)
+{
+  char tmp[8];
+
+  Enc_Version(tmp, v->F_major, v->F_minor);
+  AddText("Firmware", tmp);
+  AddBool("Debug", v->F_debug);
+  Enc_Version(tmp, v->H_major, v->H_minor);
+  AddText("Hardware", tmp);
+  Enc_Version(tmp, v->P_major, v->P_minor);
+  AddText("Protocol", tmp);
+  Enc_Version(tmp, v->L_major, v->L_minor);
+  AddText("Library", tmp);
+}
+
+void SEN55Cbor::AddStatus(uint8_t status)
+{
+  AddInt("Status", status);
+}
+
+uint16_t SEN55Cbor::End()
+{
+  Put(CBOR_BREAK);
+
+  return(_Over ? 0 : _Pos);
+}
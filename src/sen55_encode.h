@@ -0,0 +1,142 @@
+/**
+ * SEN55 JSON and CBOR encoding header file
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * Writes the values, PM values, version and status as a JSON object or a
+ * CBOR map (RFC 8949) in a buffer of the caller, e.g. for MQTT or HTTP. There
+ * is no heap (no String) and no printf : the SEN55 values have a known
+ * precision (e.g. 0.1 μg/m3, 0.01 %RH, 0.005 °C), each is written as an
+ * integer with a fixed number of decimals. CBOR stores a float as its 4 bytes.
+ *
+ *   char buf[200];
+ *   SEN55Json js(buf, sizeof(buf));
+ *
+ *   js.Add(&val);
+ *   js.AddStatus(status);
+ *   if (js.End()) mqtt.publish("sen55", buf);
+ *
+ * {"MassPM1":4.6,"MassPM2":6.6,...,"Temp":21.455,"VOC":99.0,"NOX":1.0,"Status":0}
+ *
+ * A field that is NaN is written as null. The keys are the names of the
+ * members of the structures.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026
+ * - Initial version by paulvha
+ *********************************************************************
+*/
+#ifndef SEN55_ENCODE_H
+#define SEN55_ENCODE_H
+
+#include "sen55_stats.h"
+
+class SEN55Json
+{
+  public:
+    /**
+     * @param buf  : buffer for the JSON text (terminated with 0x0)
+     * @param size : size of buf
+     */
+    SEN55Json(char *buf, uint16_t size);
+
+    /**
+     * @brief : start a new object in the buffer
+     */
+    void Begin();
+
+    /**
+     * @brief : add the fields of a structure
+     */
+    void Add(struct sen_values *v);
+    void Add(struct sen_values_pm *v);
+    void Add(struct sen_version *v);
+
+    /**
+     * @brief : add the status (as GetStatusReg())
+     */
+    void AddStatus(uint8_t status);
+
+    /**
+     * @brief : add a member
+     * @param key : name (a key is not checked for duplicates)
+     * @param dec : number of decimals
+     */
+    void AddFloat(const char *key, float x, uint8_t dec = 2);
+    void AddInt(const char *key, int32_t n);
+    void AddText(const char *key, const char *s);
+    void AddBool(const char *key, bool b);
+
+    /**
+     * @brief : close the object
+     * @return : length of the text, 0 if the buffer was too small
+     */
+    uint16_t End();
+
+  private:
+    void Key(const char *key);
+    void Put(char c);
+    void Put(const char *s);
+    void Text(const char *s);
+    void Float(float x, uint8_t dec);
+
+    char *_Buf;
+    uint16_t _Size;
+    uint16_t _Pos;
+    bool _First;                        // no member yet
+    bool _Over;                         // buffer too small
+};
+
+class SEN55Cbor
+{
+  public:
+    /**
+     * @param buf  : buffer for the CBOR map
+     * @param size : size of buf
+     */
+    SEN55Cbor(uint8_t *buf, uint16_t size);
+
+    void Begin();
+
+    void Add(struct sen_values *v);
+    void Add(struct sen_values_pm *v);
+    void Add(struct sen_version *v);
+    void AddStatus(uint8_t status);
+
+    /**
+     * @brief : add a member (a float is stored as 4 bytes, dec is ignored)
+     */
+    void AddFloat(const char *key, float x, uint8_t dec = 2);
+    void AddInt(const char *key, int32_t n);
+    void AddText(const char *key, const char *s);
+    void AddBool(const char *key, bool b);
+
+    /**
+     * @brief : close the map
+     * @return : length of the map, 0 if the buffer was too small
+     */
+    uint16_t End();
+
+  private:
+    void Put(uint8_t c);
+    void Head(uint8_t major, uint32_t n);
+    void Text(const char *s);
+    void Float(float x);
+
+    uint8_t *_Buf;
+    uint16_t _Size;
+    uint16_t _Pos;
+    bool _Over;
+};
+
+#endif /* SEN55_ENCODE_H */
@@ -0,0 +1,215 @@
+/**
+ * SEN55 multi-resolution rollup
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * ================ Disclaimer ===================================
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026 /paulvha
+ * - Initial version
+ *
+ *********************************************************************
+ */
+
+#include "sen55_rollup.h"
+#include <math.h>
+
+static const uint32_t Rollup_Period[3] = {SEN55_ROLLUP_PERIOD0, SEN55_ROLLUP_PERIOD1, SEN55_ROLLUP_PERIOD2};
+static const uint16_t Rollup_Size[3] = {SEN55_ROLLUP_SIZE0, SEN55_ROLLUP_SIZE1, SEN55_ROLLUP_SIZE2};
+static const uint16_t Rollup_Offset[3] = {0, SEN55_ROLLUP_SIZE0, SEN55_ROLLUP_SIZE0 + SEN55_ROLLUP_SIZE1};
+
+SEN55Rollup::SEN55Rollup(uint16_t fields)
+{
+  _Fields = 0;
+
+  for (uint8_t f = 0; f < SEN55_FLD_NUM && _Fields < SEN55_ROLLUP_FIELDS; f++) {
+    if (fields & SEN55_FLD(f)) _Fld[_Fields++] = f;
+  }
+
+  _Callback = NULL;
+  _Ctx = NULL;
+
+  Clear();
+}
+
+void SEN55Rollup::Clear()
+{
+  memset(_Open, 0x0, sizeof(_Open));
+  memset(_Head, 0x0, sizeof(_Head));
+  memset(_Used, 0x0, sizeof(_Used));
+}
+
+void SEN55Rollup::SetCallback(void (*cb)(SEN55Rollup *r, uint8_t level, void *ctx), void *ctx)
+{
+  _Callback = cb;
+  _Ctx = ctx;
+}
+
+uint32_t SEN55Rollup::Period(uint8_t level)
+{
+  if (level >= SEN55_ROLLUP_LEVELS) return(0);
+  return(Rollup_Period[level]);
+}
+
+uint16_t SEN55Rollup::Buckets(uint8_t level)
+{
+  if (level >= SEN55_ROLLUP_LEVELS) return(0);
+  return(_Used[level] + 1);
+}
+
+bool SEN55Rollup::Empty(struct sen_rollup_bucket *b)
+{
+  for (uint8_t i = 0; i < _Fields; i++) {
+    if (b->f[i].count) return(false);
+  }
+
+  return(true);
+}
+
+/**
+ * @brief : add the aggregates of a bucket to another
+ */
+void SEN55Rollup::Merge(struct sen_rollup_bucket *to, struct sen_rollup_bucket *from)
+{
+  struct sen_agg *t, *f;
+
+  for (uint8_t i = 0; i < _Fields; i++) {
+
+    t = &to->f[i];
+    f = &from->f[i];
+
+    if (f->count == 0) continue;
+
+    if (t->count == 0) {
+      *t = *f;
+      continue;
+    }
+
+    if (f->min < t->min) t->min = f->min;
+    if (f->max > t->max) t->max = f->max;
+
+    // weighted mean, no sum that grows
+    t->count += f->count;
+    t->mean += (f->mean - t->mean) * ((float) f->count / t->count);
+  }
+}
+
+/**
+ * @brief : finish the current bucket of a level, store it in the ring and
+ * add it to the current bucket of the level above
+ */
+void SEN55Rollup::Close(uint8_t level)
+{
+  struct sen_rollup_bucket *open = &_Open[level], *up;
+
+  _Ring[Rollup_Offset[level] + _Head[level]] = *open;
+  if (++_Head[level] == Rollup_Size[level]) _Head[level] = 0;
+  if (_Used[level] < Rollup_Size[level]) _Used[level]++;
+
+  if (level + 1 < SEN55_ROLLUP_LEVELS) {
+    up = &_Open[level + 1];
+    if (Empty(up)) up->start = open->start - open->start % Rollup_Period[level + 1];
+    Merge(up, open);
+  }
+
+  memset(open, 0x0, sizeof(struct sen_rollup_bucket));
+
+  if (_Callback) _Callback(this, level, _Ctx);
+}
+
+void SEN55Rollup::Add(float *x, uint32_t t)
+{
+  struct sen_rollup_bucket s;
+
+  // a sample just before the current minute is counted in it. If the time
+  // went back more (clock set or wrapped), new buckets are started.
+  if (! Empty(&_Open[0]) && t < _Open[0].start && _Open[0].start - t < Rollup_Period[0])
+    t = _Open[0].start;
+
+  // finish the buckets of the periods that have passed, lowest level first
+  // so a finished minute is in the hour before the hour is finished
+  for (uint8_t l = 0; l < SEN55_ROLLUP_LEVELS; l++) {
+    if (! Empty(&_Open[l]) && _Open[l].start != t - t % Rollup_Period[l]) Close(l);
+  }
+
+  // the sample as a bucket of its own
+  for (uint8_t i = 0; i < _Fields; i++) {
+
+    if (isnan(x[i])) {
+      s.f[i].count = 0;
+      continue;
+    }
+
+    s.f[i].min = s.f[i].max = s.f[i].mean = x[i];
+    s.f[i].count = 1;
+  }
+
+  if (Empty(&_Open[0])) _Open[0].start = t - t % Rollup_Period[0];
+  Merge(&_Open[0], &s);
+}
+
+void SEN55Rollup::Add(struct sen_values *v, uint32_t t)
+{
+  float x[SEN55_ROLLUP_FIELDS];
+
+  for (uint8_t i = 0; i < _Fields; i++) x[i] = SEN55Field(v, _Fld[i]);
+
+  Add(x, t);
+}
+
+void SEN55Rollup::Add(struct sen_values_pm *v, uint32_t t)
+{
+  float x[SEN55_ROLLUP_FIELDS];
+
+  for (uint8_t i = 0; i < _Fields; i++) x[i] = SEN55Field(v, _Fld[i]);
+
+  Add(x, t);
+}
+
+uint8_t SEN55Rollup::Get(uint8_t level, uint16_t age, uint8_t fld, struct sen_agg *a, uint32_t *start)
+{
+  struct sen_rollup_bucket b;
+  uint8_t i, l;
+
+  if (level >= SEN55_ROLLUP_LEVELS) return(SEN55_ERR_PARAMETER);
+
+  for (i = 0; i < _Fields; i++) {
+    if (_Fld[i] == fld) break;
+  }
+
+  if (i == _Fields) return(SEN55_ERR_PARAMETER);
+
+  if (age == 0) {
+
+    // the current buckets of the lower levels are not promoted yet
+    b = _Open[level];
+
+    for (l = level; l-- > 0; ) {
+      if (Empty(&_Open[l])) continue;
+      if (Empty(&b)) b.start = _Open[l].start - _Open[l].start % Rollup_Period[level];
+      Merge(&b, &_Open[l]);
+    }
+
+    if (Empty(&b)) return(SEN55_ERR_PARAMETER);
+  }
+  else {
+    if (age > _Used[level]) return(SEN55_ERR_PARAMETER);
+
+    b = _Ring[Rollup_Offset[level] + (_Head[level] + Rollup_Size[level] - age) % Rollup_Size[level]];
+  }
+
+  *a = b.f[i];
+  if (start) *start = b.start;
+
+  return(SEN55_ERR_OK);
+}
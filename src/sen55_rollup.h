@@ -0,0 +1,172 @@
+/**
+ * SEN55 multi-resolution rollup header file
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * Keeps the history of selected fields as min / mean / max / count per
+ * bucket at more resolutions (default 1 minute, 1 hour and 1 day), each in
+ * a ring of fixed size. When a sample starts a new minute, the finished
+ * minute is stored and added to the current hour, a finished hour to the
+ * current day. No samples are kept, there is no heap and the history is
+ * read back from RAM at once :
+ *
+ *   SEN55Rollup hist(SEN55_FLD(SEN55_FLD_PM2));
+ *
+ *   sen55.GetValues(&val);
+ *   hist.Add(&val, sen55.Millis() / 1000);
+ *
+ *   for (age = 0; age < 24; age++)      // last 24 hours, hourly
+ *     if (hist.Get(1, age, SEN55_FLD_PM2, &a, &start) == SEN55_ERR_OK) ...
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026
+ * - Initial version by paulvha
+ *********************************************************************
+*/
+#ifndef SEN55_ROLLUP_H
+#define SEN55_ROLLUP_H
+
+#include "sen55_stats.h"
+
+/**
+ * Resolutions : seconds per bucket and number of buckets kept per level.
+ * The period of a level must be a multiple of the level below. Set
+ * SEN55_ROLLUP_SIZE2 to 0 to use only 2 levels.
+ *
+ * Each bucket needs 4 + 16 * SEN55_ROLLUP_FIELDS bytes of RAM (default
+ * about 8K, on low memory boards about 700 bytes).
+ */
+#ifndef SEN55_ROLLUP_PERIOD0
+  #define SEN55_ROLLUP_PERIOD0 60       // 1 minute
+  #define SEN55_ROLLUP_PERIOD1 3600     // 1 hour
+  #define SEN55_ROLLUP_PERIOD2 86400    // 1 day
+#endif
+
+#ifndef SEN55_ROLLUP_SIZE0
+  #if defined SMALLFOOTPRINT
+    #define SEN55_ROLLUP_SIZE0 15
+    #define SEN55_ROLLUP_SIZE1 12
+    #define SEN55_ROLLUP_SIZE2 0
+  #else
+    #define SEN55_ROLLUP_SIZE0 60
+    #define SEN55_ROLLUP_SIZE1 48
+    #define SEN55_ROLLUP_SIZE2 7
+  #endif
+#endif
+
+#ifndef SEN55_ROLLUP_FIELDS             // max fields followed
+  #if defined SMALLFOOTPRINT
+    #define SEN55_ROLLUP_FIELDS 1
+  #else
+    #define SEN55_ROLLUP_FIELDS 4
+  #endif
+#endif
+
+#if SEN55_ROLLUP_SIZE2 > 0
+  #define SEN55_ROLLUP_LEVELS 3
+#else
+  #define SEN55_ROLLUP_LEVELS 2
+#endif
+
+#if SEN55_ROLLUP_PERIOD1 % SEN55_ROLLUP_PERIOD0 != 0 || SEN55_ROLLUP_PERIOD2 % SEN55_ROLLUP_PERIOD1 != 0
+  #error "SEN55_ROLLUP_PERIOD1 and 2 must be a multiple of the level below"
+#endif
+
+#define SEN55_ROLLUP_TOTAL (SEN55_ROLLUP_SIZE0 + SEN55_ROLLUP_SIZE1 + SEN55_ROLLUP_SIZE2)
+
+/**
+ * aggregate of one field in a bucket
+ */
+struct sen_agg {
+  float min;
+  float max;
+  float mean;
+  uint32_t count;                     // samples (0 : no samples, the others are not valid)
+};
+
+struct sen_rollup_bucket {
+  uint32_t start;                     // time (seconds) of the start of the bucket
+  struct sen_agg f[SEN55_ROLLUP_FIELDS];
+};
+
+class SEN55Rollup
+{
+  public:
+    /**
+     * @param fields : mask of the fields to follow (SEN55_FLD_xxx). Only the
+     * first SEN55_ROLLUP_FIELDS fields in the mask are followed.
+     */
+    SEN55Rollup(uint16_t fields = SEN55_FLD(SEN55_FLD_PM2));
+
+    /**
+     * @brief : add a sample
+     * @param v : values
+     * @param t : time of the sample in seconds (e.g. Millis() / 1000 or a
+     *            real time clock). A sample up to a minute older than the
+     *            current minute is counted in the current minute. Millis()
+     *            wraps after 49 days : the buckets after that have a lower
+     *            start time, but are still in the right order.
+     */
+    void Add(struct sen_values *v, uint32_t t);
+    void Add(struct sen_values_pm *v, uint32_t t);
+
+    /**
+     * @brief : get a bucket
+     * @param level : 0 (minutes), 1 (hours), 2 (days)
+     * @param age   : 0 = current bucket (includes the samples of the current
+     *                buckets at the lower levels), 1 = the one before, etc.
+     *                A period without samples has no bucket.
+     * @param fld   : SEN55_FLD_xxx
+     * @param a     : to store the aggregate
+     * @param start : if not NULL, to store the start time of the bucket
+     * @return
+     *  SEN55_ERR_OK = ok
+     *  SEN55_ERR_PARAMETER = field not followed or no such level / bucket
+     */
+    uint8_t Get(uint8_t level, uint16_t age, uint8_t fld, struct sen_agg *a, uint32_t *start = NULL);
+
+    /**
+     * @brief : number of buckets that can be read at a level (including the current)
+     */
+    uint16_t Buckets(uint8_t level);
+
+    /**
+     * @brief : seconds per bucket at a level
+     */
+    uint32_t Period(uint8_t level);
+
+    /**
+     * @brief : call a routine each time a bucket is finished
+     * The finished bucket is then Get(level, 1, ...)
+     */
+    void SetCallback(void (*cb)(SEN55Rollup *r, uint8_t level, void *ctx), void *ctx = NULL);
+
+    void Clear();
+
+  private:
+    void Add(float *x, uint32_t t);
+    void Close(uint8_t level);
+    void Merge(struct sen_rollup_bucket *to, struct sen_rollup_bucket *from);
+    bool Empty(struct sen_rollup_bucket *b);
+
+    uint8_t _Fld[SEN55_ROLLUP_FIELDS];  // field per slot
+    uint8_t _Fields;                    // slots in use
+    struct sen_rollup_bucket _Open[SEN55_ROLLUP_LEVELS];
+    struct sen_rollup_bucket _Ring[SEN55_ROLLUP_TOTAL];
+    uint16_t _Head[SEN55_ROLLUP_LEVELS];  // next bucket to write in the ring
+    uint16_t _Used[SEN55_ROLLUP_LEVELS];  // buckets in the ring
+    void (*_Callback)(SEN55Rollup *r, uint8_t level, void *ctx);
+    void *_Ctx;
+};
+
+#endif /* SEN55_ROLLUP_H */
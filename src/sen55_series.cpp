@@ -0,0 +1,340 @@
+/**
+ * SEN55 compressed time series
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * ================ Disclaimer ===================================
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026 /paulvha
+ * - Initial version
+ *
+ *********************************************************************
+ */
+
+#include "sen55_series.h"
+#include <math.h>
+
+/**
+ * block :
+ *  0  number of samples (2 bytes, little endian)
+ *  2  samples, bits from the MSB of each byte
+ *
+ * sample :
+ *  first in block : time (32 bits), else code of the delta of delta of the time
+ *  per stored field : code of the delta of the fixed point value
+ *
+ * code of u (zigzag, small values of both signs are small) :
+ *  0              u = 0
+ *  10   + 3 bits  u < 8
+ *  110  + 7 bits  u < 128
+ *  1110 + 12 bits u < 4096
+ *  1111 + 32 bits
+ */
+#define SERIES_HDR_BITS 16
+#define SERIES_NAN 0xffffffff         // code of a NaN value
+
+// scale of the fixed point values as sent by the SEN55
+static const uint16_t Series_Scale[SEN55_FLD_NUM] = {10, 10, 10, 10, 100, 200, 10, 10, 10, 10, 10, 10, 10, 1000};
+
+static uint32_t Zig(int32_t v)
+{
+  return(((uint32_t) v << 1) ^ (uint32_t) (v >> 31));
+}
+
+static int32_t Unzig(uint32_t u)
+{
+  return((int32_t) (u >> 1) ^ -(int32_t) (u & 1));
+}
+
+static uint8_t CodeLen(uint32_t u)
+{
+  if (u == 0) return(1);
+  if (u < 8) return(5);
+  if (u < 128) return(10);
+  if (u < 4096) return(16);
+  return(36);
+}
+
+SEN55Series::SEN55Series(uint8_t *buf, uint32_t size, uint16_t fields)
+{
+  _Buf = buf;
+  _Blocks = size / SEN55_SERIES_BLOCK > 0xffff ? 0xffff : size / SEN55_SERIES_BLOCK;
+  _Fields = fields & SEN55_FLD_ALL;
+  Clear();
+}
+
+void SEN55Series::Clear()
+{
+  _First = _Used = 0;
+  _Bit = 0;
+  _Count = _Dropped = 0;
+}
+
+uint8_t *SEN55Series::Block(uint16_t b)
+{
+  return(_Buf + (uint32_t) ((_First + b) % _Blocks) * SEN55_SERIES_BLOCK);
+}
+
+uint16_t SEN55Series::BlockCount(uint8_t *blk)
+{
+  return(blk[0] | blk[1] << 8);
+}
+
+void SEN55Series::SetBlockCount(uint8_t *blk, uint16_t cnt)
+{
+  blk[0] = cnt & 0xff;
+  blk[1] = cnt >> 8;
+}
+
+uint32_t SEN55Series::Bytes()
+{
+  if (_Used == 0) return(0);
+  return((uint32_t) (_Used - 1) * SEN55_SERIES_BLOCK + (_Bit + 7) / 8);
+}
+
+/**
+ * @brief : add bits to the newest block (the room was checked)
+ */
+void SEN55Series::Put(uint32_t val, uint8_t bits)
+{
+  uint8_t *blk = Block(_Used - 1);
+
+  while (bits--) {
+    if ((val >> bits) & 1) blk[_Bit / 8] |= 0x80 >> (_Bit % 8);
+    _Bit++;
+  }
+}
+
+void SEN55Series::PutCode(uint32_t u)
+{
+  if (u == 0) Put(0, 1);
+  else if (u < 8) Put(0x10 | u, 5);
+  else if (u < 128) Put(0x300 | u, 10);
+  else if (u < 4096) Put(0xe000 | u, 16);
+  else {
+    Put(0xf, 4);
+    Put(u, 32);
+  }
+}
+
+uint32_t SEN55Series::Get(uint8_t *blk, uint16_t *bit, uint8_t bits)
+{
+  uint32_t val = 0;
+
+  while (bits--) {
+    val = val << 1 | ((blk[*bit / 8] >> (7 - *bit % 8)) & 1);
+    (*bit)++;
+  }
+
+  return(val);
+}
+
+uint32_t SEN55Series::GetCode(uint8_t *blk, uint16_t *bit)
+{
+  if (Get(blk, bit, 1) == 0) return(0);
+  if (Get(blk, bit, 1) == 0) return(Get(blk, bit, 3));
+  if (Get(blk, bit, 1) == 0) return(Get(blk, bit, 7));
+  if (Get(blk, bit, 1) == 0) return(Get(blk, bit, 12));
+  return(Get(blk, bit, 32));
+}
+
+bool SEN55Series::Append(float *x, uint32_t t)
+{
+  int32_t raw[SEN55_FLD_NUM], dod = 0;
+  uint16_t bits;
+  uint8_t *blk, f;
+  bool first;
+
+  if (_Blocks < 2) return(false);
+
+  // fixed point, as the SEN55 sent it
+  for (f = 0; f < SEN55_FLD_NUM; f++) {
+    if (_Fields & SEN55_FLD(f)) raw[f] = isnan(x[f]) ? 0 : (int32_t) lround(x[f] * Series_Scale[f]);
+  }
+
+  first = (_Used == 0);
+
+  // size as delta of the previous sample
+  if (! first) {
+
+    dod = (int32_t) (t - _Time) - _Delta;
+    bits = CodeLen(Zig(dod));
+
+    for (f = 0; f < SEN55_FLD_NUM; f++) {
+      if (_Fields & SEN55_FLD(f)) bits += isnan(x[f]) ? 36 : CodeLen(Zig(raw[f] - _Val[f]));
+    }
+
+    if (_Bit + bits > SEN55_SERIES_BLOCK * 8) first = true;
+  }
+
+  if (first) {
+
+    // buffer full : drop the oldest block
+    if (_Used == _Blocks) {
+      blk = Block(0);
+      _Count -= BlockCount(blk);
+      _Dropped += BlockCount(blk);
+      _First = (_First + 1) % _Blocks;
+      _Used--;
+    }
+
+    _Used++;
+    blk = Block(_Used - 1);
+    memset(blk, 0x0, SEN55_SERIES_BLOCK);
+    _Bit = SERIES_HDR_BITS;
+
+    // the first sample in a block is complete
+    Put(t, 32);
+    _Delta = 0;
+    memset(_Val, 0x0, sizeof(_Val));
+  }
+  else {
+    PutCode(Zig(dod));
+    _Delta += dod;
+  }
+
+  for (f = 0; f < SEN55_FLD_NUM; f++) {
+
+    if (! (_Fields & SEN55_FLD(f))) continue;
+
+    if (isnan(x[f])) {
+      PutCode(SERIES_NAN);
+      continue;
+    }
+
+    PutCode(Zig(raw[f] - _Val[f]));
+    _Val[f] = raw[f];
+  }
+
+  blk = Block(_Used - 1);
+  SetBlockCount(blk, BlockCount(blk) + 1);
+  _Time = t;
+  _Count++;
+
+  return(true);
+}
+
+bool SEN55Series::Append(struct sen_values *v, uint32_t t)
+{
+  float x[SEN55_FLD_NUM];
+
+  for (uint8_t f = 0; f < SEN55_FLD_NUM; f++) x[f] = SEN55Field(v, f);
+
+  return(Append(x, t));
+}
+
+bool SEN55Series::Append(struct sen_values_pm *v, uint32_t t)
+{
+  float x[SEN55_FLD_NUM];
+
+  for (uint8_t f = 0; f < SEN55_FLD_NUM; f++) x[f] = SEN55Field(v, f);
+
+  return(Append(x, t));
+}
+
+void SEN55Series::Begin(struct sen_series_iter *it)
+{
+  it->block = 0;
+  it->sample = 0;
+  it->bit = SERIES_HDR_BITS;
+  it->dropped = _Dropped;
+}
+
+bool SEN55Series::Next(struct sen_series_iter *it, float *x, uint32_t *t)
+{
+  uint8_t *blk;
+  uint32_t u;
+  uint8_t f;
+
+  // a dropped block moves all blocks
+  if (it->dropped != _Dropped) return(false);
+
+  while (1) {
+
+    if (it->block >= _Used) return(false);
+
+    blk = Block(it->block);
+
+    if (it->sample < BlockCount(blk)) break;
+
+    it->block++;
+    it->sample = 0;
+    it->bit = SERIES_HDR_BITS;
+  }
+
+  if (it->sample == 0) {
+    it->time = Get(blk, &it->bit, 32);
+    it->delta = 0;
+    memset(it->val, 0x0, sizeof(it->val));
+  }
+  else {
+    it->delta += Unzig(GetCode(blk, &it->bit));
+    it->time += it->delta;
+  }
+
+  for (f = 0; f < SEN55_FLD_NUM; f++) {
+
+    x[f] = NAN;
+
+    if (! (_Fields & SEN55_FLD(f))) continue;
+
+    u = GetCode(blk, &it->bit);
+    if (u == SERIES_NAN) continue;
+
+    it->val[f] += Unzig(u);
+    x[f] = (float) it->val[f] / (float) Series_Scale[f];
+  }
+
+  it->sample++;
+  *t = it->time;
+
+  return(true);
+}
+
+bool SEN55Series::Next(struct sen_series_iter *it, struct sen_values *v, uint32_t *t)
+{
+  float x[SEN55_FLD_NUM];
+
+  if (! Next(it, x, t)) return(false);
+
+  v->MassPM1 = x[SEN55_FLD_PM1];
+  v->MassPM2 = x[SEN55_FLD_PM2];
+  v->MassPM4 = x[SEN55_FLD_PM4];
+  v->MassPM10 = x[SEN55_FLD_PM10];
+  v->Hum = x[SEN55_FLD_HUM];
+  v->Temp = x[SEN55_FLD_TEMP];
+  v->VOC = x[SEN55_FLD_VOC];
+  v->NOX = x[SEN55_FLD_NOX];
+
+  return(true);
+}
+
+bool SEN55Series::Next(struct sen_series_iter *it, struct sen_values_pm *v, uint32_t *t)
+{
+  float x[SEN55_FLD_NUM];
+
+  if (! Next(it, x, t)) return(false);
+
+  v->MassPM1 = x[SEN55_FLD_PM1];
+  v->MassPM2 = x[SEN55_FLD_PM2];
+  v->MassPM4 = x[SEN55_FLD_PM4];
+  v->MassPM10 = x[SEN55_FLD_PM10];
+  v->NumPM0 = x[SEN55_FLD_NUMPM0];
+  v->NumPM1 = x[SEN55_FLD_NUMPM1];
+  v->NumPM2 = x[SEN55_FLD_NUMPM2];
+  v->NumPM4 = x[SEN55_FLD_NUMPM4];
+  v->NumPM10 = x[SEN55_FLD_NUMPM10];
+  v->PartSize = x[SEN55_FLD_PARTSIZE];
+
+  return(true);
+}
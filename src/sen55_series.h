@@ -0,0 +1,144 @@
+/**
+ * SEN55 compressed time series header file
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * Stores samples compressed in a buffer of the caller, e.g. to keep the
+ * readings of a node while it is offline. The SEN55 sends each value as a
+ * fixed point number (e.g. PM in 0.1 μg/m3), the store keeps that number
+ * (no loss) and only the change from the previous sample :
+ *
+ *   time   : delta of delta (at a fixed interval mostly 0 : 1 bit)
+ *   values : delta, zigzag, in a code of 1, 5, 10, 16 or 36 bits
+ *
+ * A sample of the 8 fields of sen_values needs about 4 - 8 bytes instead of 32.
+ *
+ * The buffer is divided in blocks of SEN55_SERIES_BLOCK bytes. Each block
+ * starts with a complete sample, so the oldest block can be dropped when
+ * the buffer is full : the newest samples are always kept.
+ *
+ *   uint8_t buf[16384];
+ *   SEN55Series series(buf, sizeof(buf));
+ *   struct sen_series_iter it;
+ *
+ *   series.Append(&val, millis());
+ *   ...
+ *   series.Begin(&it);
+ *   while (series.Next(&it, &val, &t)) send(&val, t);
+ *   series.Clear();
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026
+ * - Initial version by paulvha
+ *********************************************************************
+*/
+#ifndef SEN55_SERIES_H
+#define SEN55_SERIES_H
+
+#include "sen55_stats.h"
+
+/**
+ * Bytes per block. A smaller block drops less samples at once when the
+ * buffer is full, but each block starts with a complete sample (about 20
+ * bytes for sen_values).
+ */
+#ifndef SEN55_SERIES_BLOCK
+  #if defined SMALLFOOTPRINT
+    #define SEN55_SERIES_BLOCK 96
+  #else
+    #define SEN55_SERIES_BLOCK 256
+  #endif
+#endif
+
+// the first sample of a block with all fields must fit
+#if SEN55_SERIES_BLOCK < 72
+  #error "SEN55_SERIES_BLOCK must be at least 72"
+#endif
+
+/**
+ * position of a reader, see Begin() and Next()
+ */
+struct sen_series_iter {
+  uint16_t block;                     // block, 0 = oldest
+  uint16_t sample;                    // sample in the block
+  uint16_t bit;                       // next bit in the block
+  uint32_t dropped;                   // Dropped() at Begin()
+  uint32_t time;
+  int32_t delta;                      // time between the last 2 samples
+  int32_t val[SEN55_FLD_NUM];         // last fixed point values
+};
+
+class SEN55Series
+{
+  public:
+    /**
+     * @param buf    : buffer to store the samples (at least 2 blocks)
+     * @param size   : size of buf in bytes
+     * @param fields : mask of the fields to store (SEN55_FLD_xxx)
+     */
+    SEN55Series(uint8_t *buf, uint32_t size, uint16_t fields = SEN55_FLD_VALUES);
+
+    /**
+     * @brief : add a sample
+     * @param v : values, fields that are not in the structure are stored as NaN
+     * @param t : time of the sample (e.g. millis() or seconds)
+     * @return : false if the buffer is too small
+     */
+    bool Append(struct sen_values *v, uint32_t t);
+    bool Append(struct sen_values_pm *v, uint32_t t);
+
+    /**
+     * @brief : start reading at the oldest sample
+     */
+    void Begin(struct sen_series_iter *it);
+
+    /**
+     * @brief : get the next sample
+     * @param v : to store the values, fields that are not stored are NaN
+     * @param t : to store the time
+     * @return : false if there are no more samples, or the block that was
+     * being read was dropped by Append() (start again with Begin())
+     */
+    bool Next(struct sen_series_iter *it, struct sen_values *v, uint32_t *t);
+    bool Next(struct sen_series_iter *it, struct sen_values_pm *v, uint32_t *t);
+
+    uint32_t Count() {return(_Count);}      // samples stored
+    uint32_t Dropped() {return(_Dropped);}  // samples dropped because the buffer was full
+    uint32_t Bytes();                       // bytes in use
+
+    void Clear();
+
+  private:
+    bool Append(float *x, uint32_t t);
+    bool Next(struct sen_series_iter *it, float *x, uint32_t *t);
+    uint8_t *Block(uint16_t b);
+    uint16_t BlockCount(uint8_t *blk);
+    void SetBlockCount(uint8_t *blk, uint16_t cnt);
+    void Put(uint32_t val, uint8_t bits);
+    void PutCode(uint32_t u);
+    uint32_t Get(uint8_t *blk, uint16_t *bit, uint8_t bits);
+    uint32_t GetCode(uint8_t *blk, uint16_t *bit);
+
+    uint8_t *_Buf;
+    uint16_t _Blocks;                   // blocks in _Buf
+    uint16_t _First;                    // oldest block
+    uint16_t _Used;                     // blocks in use
+    uint16_t _Bit;                      // next bit in the newest block
+    uint16_t _Fields;                   // mask of the stored fields
+    uint32_t _Count, _Dropped;
+    uint32_t _Time;                     // last sample
+    int32_t _Delta;
+    int32_t _Val[SEN55_FLD_NUM];
+};
+
+#endif /* SEN55_SERIES_H */
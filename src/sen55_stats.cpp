@@ -0,0 +1,436 @@
+/**
+ * SEN55 streaming statistics
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * ================ Disclaimer ===================================
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026 /paulvha
+ * - Initial version
+ *
+ *********************************************************************
+ */
+
+#include "sen55_stats.h"
+#include <math.h>
+
+/////////////////////////// one value ///////////////////////////////
+
+SEN55Stat::SEN55Stat()
+{
+  _Alpha = SEN55_STATS_ALPHA;
+  Clear();
+}
+
+void SEN55Stat::Clear()
+{
+  _Count = 0;
+  _Mean = _M2 = 0;
+  _Min = _Max = 0;
+  _Ewma = 0;
+  _WinSum = 0;
+  _WinPos = 0;
+}
+
+void SEN55Stat::Add(float x)
+{
+  float delta;
+
+  if (isnan(x)) return;
+
+  _Count++;
+
+  if (_Count == 1) {
+    _Mean = _Min = _Max = _Ewma = x;
+    _M2 = 0;
+  }
+  else {
+    // Welford : no loss of precision on a large sum of squares
+    delta = x - _Mean;
+    _Mean += delta / _Count;
+    _M2 += delta * (x - _Mean);
+
+    if (x < _Min) _Min = x;
+    if (x > _Max) _Max = x;
+
+    _Ewma += _Alpha * (x - _Ewma);
+  }
+
+  // sliding window : replace the oldest sample
+  if (_Count > SEN55_STATS_WINDOW) _WinSum -= _Win[_WinPos];
+  _Win[_WinPos] = x;
+  _WinSum += x;
+
+  if (++_WinPos == SEN55_STATS_WINDOW) {
+    _WinPos = 0;
+
+    // once per window : sum again, else the rounding errors of the
+    // subtractions add up over time
+    _WinSum = 0;
+    for (uint8_t i = 0; i < SEN55_STATS_WINDOW; i++) _WinSum += _Win[i];
+  }
+}
+
+float SEN55Stat::Variance()
+{
+  if (_Count < 2) return(0);
+  return(_M2 / (_Count - 1));
+}
+
+float SEN55Stat::StdDev()
+{
+  return(sqrt(Variance()));
+}
+
+float SEN55Stat::WindowAvg()
+{
+  uint8_t n = WindowCount();
+
+  if (n == 0) return(0);
+  return(_WinSum / n);
+}
+
+/////////////////////////// fields ///////////////////////////////
+
+SEN55Stats::SEN55Stats(uint16_t fields)
+{
+  uint8_t s = 0;
+
+  for (uint8_t f = 0; f < SEN55_FLD_NUM; f++) {
+    if ((fields & SEN55_FLD(f)) && s < SEN55_STATS_SLOTS) _Slot[f] = s++;
+    else _Slot[f] = 0xff;
+  }
+
+  _Skip = 0;
+  _Skipped = 0;
+}
+
+/**
+ * @brief : count a skipped sample
+ * @return : true if the sample must be skipped
+ */
+bool SEN55Stats::Skip()
+{
+  if (_Skip == 0) return(false);
+
+  _Skip--;
+  _Skipped++;
+  return(true);
+}
+
+bool SEN55Stats::Add(struct sen_values *v)
+{
+  float f[8] = {v->MassPM1, v->MassPM2, v->MassPM4, v->MassPM10, v->Hum, v->Temp, v->VOC, v->NOX};
+
+  if (Skip()) return(false);
+
+  for (uint8_t i = SEN55_FLD_PM1; i <= SEN55_FLD_NOX; i++) {
+    if (_Slot[i] != 0xff) _Stat[_Slot[i]].Add(f[i]);
+  }
+
+  return(true);
+}
+
+bool SEN55Stats::Add(struct sen_values_pm *v)
+{
+  // NaN : not in sen_values_pm, ignored by SEN55Stat::Add()
+  float f[SEN55_FLD_NUM] = {v->MassPM1, v->MassPM2, v->MassPM4, v->MassPM10, NAN, NAN, NAN, NAN,
+    v->NumPM0, v->NumPM1, v->NumPM2, v->NumPM4, v->NumPM10, v->PartSize};
+
+  if (Skip()) return(false);
+
+  for (uint8_t i = 0; i < SEN55_FLD_NUM; i++) {
+    if (_Slot[i] != 0xff) _Stat[_Slot[i]].Add(f[i]);
+  }
+
+  return(true);
+}
+
+SEN55Stat *SEN55Stats::Field(uint8_t fld)
+{
+  if (fld >= SEN55_FLD_NUM || _Slot[fld] == 0xff) return(NULL);
+  return(&_Stat[_Slot[fld]]);
+}
+
+void SEN55Stats::SetAlpha(float alpha)
+{
+  for (uint8_t i = 0; i < SEN55_STATS_SLOTS; i++) _Stat[i].SetAlpha(alpha);
+}
+
+void SEN55Stats::Clear()
+{
+  for (uint8_t i = 0; i < SEN55_STATS_SLOTS; i++) _Stat[i].Clear();
+  _Skipped = 0;
+}
+
+/**
+ * @brief : get a field of sen_values / sen_values_pm
+ */
+float SEN55Field(struct sen_values *v, uint8_t fld)
+{
+  switch(fld) {
+    case SEN55_FLD_PM1:   return(v->MassPM1);
+    case SEN55_FLD_PM2:   return(v->MassPM2);
+    case SEN55_FLD_PM4:   return(v->MassPM4);
+    case SEN55_FLD_PM10:  return(v->MassPM10);
+    case SEN55_FLD_HUM:   return(v->Hum);
+    case SEN55_FLD_TEMP:  return(v->Temp);
+    case SEN55_FLD_VOC:   return(v->VOC);
+    case SEN55_FLD_NOX:   return(v->NOX);
+  }
+
+  return(NAN);
+}
+
+float SEN55Field(struct sen_values_pm *v, uint8_t fld)
+{
+  switch(fld) {
+    case SEN55_FLD_PM1:       return(v->MassPM1);
+    case SEN55_FLD_PM2:       return(v->MassPM2);
+    case SEN55_FLD_PM4:       return(v->MassPM4);
+    case SEN55_FLD_PM10:      return(v->MassPM10);
+    case SEN55_FLD_NUMPM0:    return(v->NumPM0);
+    case SEN55_FLD_NUMPM1:    return(v->NumPM1);
+    case SEN55_FLD_NUMPM2:    return(v->NumPM2);
+    case SEN55_FLD_NUMPM4:    return(v->NumPM4);
+    case SEN55_FLD_NUMPM10:   return(v->NumPM10);
+    case SEN55_FLD_PARTSIZE:  return(v->PartSize);
+  }
+
+  return(NAN);
+}
+
+/////////////////////////// quantile sketch ///////////////////////////////
+
+SEN55Quantile::SEN55Quantile(float low, float high)
+{
+  Init(low, high);
+}
+
+/**
+ * @brief : set the range and start again
+ */
+void SEN55Quantile::Init(float low, float high)
+{
+  _Low = low;
+  _High = high;
+
+  // bucket b (1 ... BUCKETS - 1) : low * gamma^(b-1) < x <= low * gamma^b
+  _LogGamma = log(high / low) / (SEN55_QUANT_BUCKETS - 1);
+  _Gamma = exp(_LogGamma);
+
+  Clear();
+}
+
+void SEN55Quantile::Clear()
+{
+  memset(_Bucket, 0x0, sizeof(_Bucket));
+  _Count = 0;
+  _Min = _Max = 0;
+}
+
+uint8_t SEN55Quantile::Bucket(float x)
+{
+  float b;
+
+  if (x <= _Low) return(0);
+  if (x >= _High) return(SEN55_QUANT_BUCKETS - 1);
+
+  b = ceil(log(x / _Low) / _LogGamma);
+
+  // rounding near a bucket edge
+  if (b < 1) return(1);
+  if (b > SEN55_QUANT_BUCKETS - 1) return(SEN55_QUANT_BUCKETS - 1);
+  return((uint8_t) b);
+}
+
+/**
+ * @brief : value that represents a bucket, in the middle (relative) of
+ * its lower and upper edge. The first bucket has no lower edge, the
+ * smallest sample is used.
+ */
+float SEN55Quantile::Value(uint8_t b)
+{
+  if (b == 0) return(_Min < _Low ? _Min : _Low);
+  return(2 * _Low * exp(b * _LogGamma) / (1 + _Gamma));
+}
+
+void SEN55Quantile::Add(float x)
+{
+  if (isnan(x)) return;
+
+  if (_Count == 0) _Min = _Max = x;
+  else if (x < _Min) _Min = x;
+  else if (x > _Max) _Max = x;
+
+  _Bucket[Bucket(x)]++;
+  _Count++;
+}
+
+float SEN55Quantile::Quantile(float q)
+{
+  float rank, v;
+  uint32_t cum = 0;
+  uint8_t b;
+
+  if (_Count == 0) return(0);
+
+  if (q <= 0) return(_Min);
+  if (q >= 1) return(_Max);
+
+  rank = q * (_Count - 1);
+
+  for (b = 0; b < SEN55_QUANT_BUCKETS - 1; b++) {
+    cum += _Bucket[b];
+    if (cum > rank) break;
+  }
+
+  // the real samples are never outside min and max
+  v = Value(b);
+  if (v < _Min) return(_Min);
+  if (v > _Max) return(_Max);
+  return(v);
+}
+
+uint8_t SEN55Quantile::Merge(SEN55Quantile *q)
+{
+  if (q->_Low != _Low || q->_High != _High) return(SEN55_ERR_PARAMETER);
+
+  if (q->_Count == 0) return(SEN55_ERR_OK);
+
+  if (_Count == 0) {
+    _Min = q->_Min;
+    _Max = q->_Max;
+  }
+  else {
+    if (q->_Min < _Min) _Min = q->_Min;
+    if (q->_Max > _Max) _Max = q->_Max;
+  }
+
+  for (uint8_t b = 0; b < SEN55_QUANT_BUCKETS; b++) _Bucket[b] += q->_Bucket[b];
+  _Count += q->_Count;
+
+  return(SEN55_ERR_OK);
+}
+
+/**
+ * little endian, independent of the board
+ */
+static uint8_t *Put32(uint8_t *p, uint32_t val)
+{
+  for (uint8_t i = 0; i < 4; i++) *p++ = val >> (8 * i);
+  return(p);
+}
+
+static uint32_t Get32(const uint8_t *p)
+{
+  return((uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24);
+}
+
+static uint8_t *PutFloat(uint8_t *p, float val)
+{
+  uint32_t w;
+
+  memcpy(&w, &val, 4);
+  return(Put32(p, w));
+}
+
+static float GetFloat(const uint8_t *p)
+{
+  uint32_t w = Get32(p);
+  float val;
+
+  memcpy(&val, &w, 4);
+  return(val);
+}
+
+/**
+ * saved sketch :
+ *  0  'Q'
+ *  1  number of buckets
+ *  2  low, high, count, min, max (each 4 bytes)
+ *  22 per bucket in use : index (1 byte), count (4 bytes)
+ */
+uint16_t SEN55Quantile::Save(uint8_t *buf, uint16_t len)
+{
+  uint8_t *p = buf;
+
+  if (len < SEN55_QUANT_HDR) return(0);
+
+  *p++ = 'Q';
+  *p++ = SEN55_QUANT_BUCKETS;
+  p = PutFloat(p, _Low);
+  p = PutFloat(p, _High);
+  p = Put32(p, _Count);
+  p = PutFloat(p, _Min);
+  p = PutFloat(p, _Max);
+
+  for (uint8_t b = 0; b < SEN55_QUANT_BUCKETS; b++) {
+
+    if (_Bucket[b] == 0) continue;
+
+    if (p + 5 > buf + len) return(0);
+
+    *p++ = b;
+    p = Put32(p, _Bucket[b]);
+  }
+
+  return(p - buf);
+}
+
+uint8_t SEN55Quantile::Load(const uint8_t *buf, uint16_t len, bool merge)
+{
+  const uint8_t *p;
+  uint32_t count, sum = 0;
+  float low, high, mn, mx;
+
+  if (len < SEN55_QUANT_HDR || buf[0] != 'Q' || (len - SEN55_QUANT_HDR) % 5 != 0)
+    return(SEN55_ERR_DATALENGTH);
+
+  if (buf[1] != SEN55_QUANT_BUCKETS) return(SEN55_ERR_PARAMETER);
+
+  low = GetFloat(buf + 2);
+  high = GetFloat(buf + 6);
+  count = Get32(buf + 10);
+  mn = GetFloat(buf + 14);
+  mx = GetFloat(buf + 18);
+
+  if (merge && (low != _Low || high != _High)) return(SEN55_ERR_PARAMETER);
+  if (! (low > 0 && high > low)) return(SEN55_ERR_DATALENGTH);
+
+  // check all before changing the sketch
+  for (p = buf + SEN55_QUANT_HDR; p < buf + len; p += 5) {
+    if (p[0] >= SEN55_QUANT_BUCKETS) return(SEN55_ERR_DATALENGTH);
+    sum += Get32(p + 1);
+  }
+
+  if (sum != count) return(SEN55_ERR_DATALENGTH);
+
+  if (! merge) Init(low, high);
+
+  if (count == 0) return(SEN55_ERR_OK);
+
+  if (_Count == 0) {
+    _Min = mn;
+    _Max = mx;
+  }
+  else {
+    if (mn < _Min) _Min = mn;
+    if (mx > _Max) _Max = mx;
+  }
+
+  for (p = buf + SEN55_QUANT_HDR; p < buf + len; p += 5) _Bucket[p[0]] += Get32(p + 1);
+  _Count += count;
+
+  return(SEN55_ERR_OK);
+}
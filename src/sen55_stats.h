@@ -0,0 +1,307 @@
+/**
+ * SEN55 streaming statistics header file
+ *
+ * Copyright (c) October 2026, Paul van Haastrecht
+ *
+ * All rights reserved.
+ *
+ * Running statistics on the values of the SEN55 : mean and variance
+ * (Welford), min / max, exponential moving average (EWMA) and the average
+ * over the last SEN55_STATS_WINDOW samples. Each sample is added in a fixed
+ * time, there is no heap and no copy of the samples apart from the window.
+ *
+ *   SEN55Stats stats(SEN55_FLD_MASS | SEN55_FLD_VOC);
+ *
+ *   sen55.GetValues(&val);
+ *   stats.Add(&val);
+ *   Serial.println(stats.Field(SEN55_FLD_PM2)->Mean());
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ **********************************************************************
+ * Version 1.0 / October 2026
+ * - Initial version by paulvha
+ *********************************************************************
+*/
+#ifndef SEN55_STATS_H
+#define SEN55_STATS_H
+
+#include "sen55.h"
+
+/**
+ * fields of sen_values and sen_values_pm
+ * (the mass values are in both structures)
+ */
+#define SEN55_FLD_PM1       0         // MassPM1
+#define SEN55_FLD_PM2       1         // MassPM2
+#define SEN55_FLD_PM4       2         // MassPM4
+#define SEN55_FLD_PM10      3         // MassPM10
+#define SEN55_FLD_HUM       4         // Hum
+#define SEN55_FLD_TEMP      5         // Temp
+#define SEN55_FLD_VOC       6         // VOC
+#define SEN55_FLD_NOX       7         // NOX
+#define SEN55_FLD_NUMPM0    8         // NumPM0
+#define SEN55_FLD_NUMPM1    9         // NumPM1
+#define SEN55_FLD_NUMPM2    10        // NumPM2
+#define SEN55_FLD_NUMPM4    11        // NumPM4
+#define SEN55_FLD_NUMPM10   12        // NumPM10
+#define SEN55_FLD_PARTSIZE  13        // PartSize
+#define SEN55_FLD_NUM       14
+
+/**
+ * masks to select the fields
+ */
+#define SEN55_FLD(f)        ((uint16_t) 1 << (f))
+#define SEN55_FLD_MASS      0x000f    // all MassPMx
+#define SEN55_FLD_VALUES    0x00ff    // all of sen_values
+#define SEN55_FLD_NUMBER    0x1f00    // all NumPMx
+#define SEN55_FLD_ALL       0x3fff
+
+/**
+ * Number of samples in the sliding window average and the number of fields
+ * that can be followed at the same time. Each followed field needs about
+ * 30 + 4 * SEN55_STATS_WINDOW bytes of RAM.
+ */
+#ifndef SEN55_STATS_WINDOW
+  #if defined SMALLFOOTPRINT
+    #define SEN55_STATS_WINDOW 8
+  #else
+    #define SEN55_STATS_WINDOW 60
+  #endif
+#endif
+
+#if SEN55_STATS_WINDOW < 1 || SEN55_STATS_WINDOW > 255
+  #error "SEN55_STATS_WINDOW must be 1 ... 255"
+#endif
+
+#ifndef SEN55_STATS_SLOTS
+  #if defined SMALLFOOTPRINT
+    #define SEN55_STATS_SLOTS 4
+  #else
+    #define SEN55_STATS_SLOTS SEN55_FLD_NUM
+  #endif
+#endif
+
+#define SEN55_STATS_ALPHA   0.1       // default EWMA weight of a new sample
+
+/**
+ * Number of buckets in a quantile sketch (SEN55Quantile). Each bucket needs
+ * 4 bytes of RAM. The relative error of a quantile depends on the number of
+ * buckets and the range of the sketch, see RelError().
+ */
+#ifndef SEN55_QUANT_BUCKETS
+  #if defined SMALLFOOTPRINT
+    #define SEN55_QUANT_BUCKETS 40
+  #else
+    #define SEN55_QUANT_BUCKETS 160
+  #endif
+#endif
+
+#if SEN55_QUANT_BUCKETS < 3 || SEN55_QUANT_BUCKETS > 255
+  #error "SEN55_QUANT_BUCKETS must be 3 ... 255"
+#endif
+
+#define SEN55_QUANT_LOW     0.1       // default range of a sketch
+#define SEN55_QUANT_HIGH    1000
+#define SEN55_QUANT_HDR     22        // bytes in a saved sketch before the buckets
+
+/**
+ * @brief : get a field of sen_values / sen_values_pm
+ * @param fld : SEN55_FLD_xxx
+ * @return : value, NaN if the field is not in the structure
+ */
+float SEN55Field(struct sen_values *v, uint8_t fld);
+float SEN55Field(struct sen_values_pm *v, uint8_t fld);
+
+/**
+ * statistics of one value
+ */
+class SEN55Stat
+{
+  public:
+    SEN55Stat();
+
+    /**
+     * @brief : start again (the EWMA weight is kept)
+     */
+    void Clear();
+
+    /**
+     * @brief : add a sample (NaN is ignored)
+     */
+    void Add(float x);
+
+    /**
+     * @brief : set the EWMA weight of a new sample (0 < alpha <= 1)
+     */
+    void SetAlpha(float alpha) {_Alpha = alpha;}
+
+    uint32_t Count() {return(_Count);}
+    float Mean() {return(_Mean);}
+    float Min() {return(_Min);}
+    float Max() {return(_Max);}
+    float Ewma() {return(_Ewma);}
+
+    /**
+     * @brief : sample variance (0 with less than 2 samples)
+     */
+    float Variance();
+    float StdDev();
+
+    /**
+     * @brief : average of the last SEN55_STATS_WINDOW samples
+     * (or less if not that many were added yet)
+     */
+    float WindowAvg();
+    uint8_t WindowCount() {return(_Count < SEN55_STATS_WINDOW ? _Count : SEN55_STATS_WINDOW);}
+
+  private:
+    uint32_t _Count;
+    float _Mean, _M2;                   // Welford
+    float _Min, _Max;
+    float _Ewma, _Alpha;
+    float _Win[SEN55_STATS_WINDOW];     // last samples
+    float _WinSum;
+    uint8_t _WinPos;                    // next entry in _Win
+};
+
+/**
+ * statistics of selected fields of sen_values / sen_values_pm
+ */
+class SEN55Stats
+{
+  public:
+    /**
+     * @param fields : mask of the fields to follow (SEN55_FLD_xxx). Only the
+     * first SEN55_STATS_SLOTS fields in the mask are followed.
+     */
+    SEN55Stats(uint16_t fields = SEN55_FLD_VALUES);
+
+    /**
+     * @brief : add a sample
+     * The fields that are not in the structure are not changed.
+     * @return : false if the sample was skipped (see SetSkip())
+     */
+    bool Add(struct sen_values *v);
+    bool Add(struct sen_values_pm *v);
+
+    /**
+     * @brief : get the statistics of a field
+     * @param fld : SEN55_FLD_PM1 ... SEN55_FLD_PARTSIZE
+     * @return : NULL if the field is not followed
+     */
+    SEN55Stat *Field(uint8_t fld);
+
+    /**
+     * @brief : skip the next cnt samples (e.g. the first readings after start()
+     * can be wrong). Skipped samples are counted in Skipped().
+     */
+    void SetSkip(uint8_t cnt) {_Skip = cnt;}
+    uint32_t Skipped() {return(_Skipped);}
+
+    /**
+     * @brief : set the EWMA weight of a new sample for all fields
+     */
+    void SetAlpha(float alpha);
+
+    /**
+     * @brief : start again with all fields
+     */
+    void Clear();
+
+  private:
+    bool Skip();
+
+    uint8_t _Slot[SEN55_FLD_NUM];       // index in _Stat, 0xff if not followed
+    SEN55Stat _Stat[SEN55_STATS_SLOTS];
+    uint8_t _Skip;
+    uint32_t _Skipped;
+};
+
+/**
+ * Quantile sketch of one value (e.g. P95 / P99 of PM2.5 over weeks)
+ *
+ * The samples are counted in SEN55_QUANT_BUCKETS buckets on a logarithmic
+ * scale between low and high : each bucket is a fixed factor wider than the
+ * one before, so a quantile has the same relative error at 2 and at 200
+ * ug/m3. Samples below low are counted in the first bucket (e.g. 0, the
+ * absolute error is at most low), above high in the last one.
+ *
+ * The memory does not grow with the number of samples. Two sketches with
+ * the same range and number of buckets can be merged : the result is the
+ * same as one sketch that got all samples. A node saves its sketch with
+ * Save() and the gateway merges them with Load(buf, len, true).
+ */
+class SEN55Quantile
+{
+  public:
+    SEN55Quantile(float low = SEN55_QUANT_LOW, float high = SEN55_QUANT_HIGH);
+
+    void Clear();
+
+    /**
+     * @brief : add a sample (NaN is ignored)
+     */
+    void Add(float x);
+
+    /**
+     * @brief : estimate a quantile
+     * @param q : 0 ... 1 (e.g. 0.95)
+     * @return : estimate, 0 if no samples
+     */
+    float Quantile(float q);
+
+    uint32_t Count() {return(_Count);}
+    float Min() {return(_Min);}
+    float Max() {return(_Max);}
+
+    /**
+     * @brief : max relative error of a quantile between low and high
+     */
+    float RelError() {return((_Gamma - 1) / (_Gamma + 1));}
+
+    /**
+     * @brief : add the samples of another sketch
+     * @return
+     *  SEN55_ERR_OK = ok
+     *  SEN55_ERR_PARAMETER = other range or number of buckets
+     */
+    uint8_t Merge(SEN55Quantile *q);
+
+    /**
+     * @brief : save the sketch (little endian, only the buckets in use)
+     * @param buf : to store
+     * @param len : size of buf, at most SEN55_QUANT_HDR + 5 * SEN55_QUANT_BUCKETS is needed
+     * @return : bytes stored, 0 if buf is too small
+     */
+    uint16_t Save(uint8_t *buf, uint16_t len);
+
+    /**
+     * @brief : load a saved sketch
+     * @param merge : true : add to the samples, false : replace them
+     * @return
+     *  SEN55_ERR_OK = ok
+     *  SEN55_ERR_DATALENGTH = buf is too short or damaged
+     *  SEN55_ERR_PARAMETER = other range or number of buckets
+     */
+    uint8_t Load(const uint8_t *buf, uint16_t len, bool merge = false);
+
+  private:
+    void Init(float low, float high);
+    uint8_t Bucket(float x);
+    float Value(uint8_t b);
+
+    float _Low, _High;
+    float _Gamma, _LogGamma;            // bucket i+1 is _Gamma times wider than i
+    float _Min, _Max;
+    uint32_t _Count;
+    uint32_t _Bucket[SEN55_QUANT_BUCKETS];
+};
+
+#endif /* SEN55_STATS_H */